@@ -0,0 +1,342 @@
+#include "BatchDecoder.h"
+#include <iostream>
+
+BatchDecoder::BatchDecoder(const std::string &fileName, int decoderCount) :
+    fileName(fileName),
+    decoderCount(decoderCount > 0 ? decoderCount : 1),
+    videoStreamIndex(-1),
+    maxBufferedFrames(64),
+    nextSegmentToDecode(0),
+    consumerSegment(0),
+    bufferedFrames(0),
+    stopped(false),
+    elapsedMilliSeconds(0),
+    deliveredFrames(0) {
+    pthread_mutex_init(&lock, NULL);
+    pthread_cond_init(&stateChanged, NULL);
+}
+
+BatchDecoder::~BatchDecoder() {
+    for (size_t i = 0; i < outputs.size(); i++) {
+        while (!outputs[i].frames.empty()) {
+            AVFrame *frame = outputs[i].frames.front();
+            outputs[i].frames.pop_front();
+            av_frame_free(&frame);
+        }
+    }
+    pthread_cond_destroy(&stateChanged);
+    pthread_mutex_destroy(&lock);
+}
+
+bool BatchDecoder::scanKeyframes(AVFormatContext *formatContext, int videoStreamIndex, int minPacketsPerSegment) {
+    this->videoStreamIndex = videoStreamIndex;
+    packets.clear();
+    segments.clear();
+
+    bool hasTimestamps = true;
+    AVPacket packet;
+    av_init_packet(&packet);
+    while (av_read_frame(formatContext, &packet) >= 0) {
+        if (packet.stream_index == videoStreamIndex) {
+            PacketInfo info;
+            info.pts = packet.pts;
+            info.dts = packet.dts;
+            info.pos = packet.pos;
+            info.keyFrame = (packet.flags & AV_PKT_FLAG_KEY) != 0;
+            if (info.pts == AV_NOPTS_VALUE) {
+                hasTimestamps = false;
+            }
+            packets.push_back(info);
+        }
+        av_free_packet(&packet);
+    }
+    av_seek_frame(formatContext, -1, 0, AVSEEK_FLAG_BACKWARD);
+
+    if (packets.empty()) {
+        return false;
+    }
+
+    // ҳÿGOP, һǹؼ֡ʱҲƬε
+    std::vector<int> boundaries;
+    boundaries.push_back(0);
+    if (hasTimestamps) {
+        for (int i = 1; i < (int)packets.size(); i++) {
+            if (packets[i].keyFrame && i - boundaries.back() >= minPacketsPerSegment) {
+                boundaries.push_back(i);
+            }
+        }
+    } else {
+        // ûʾʱ޷жǰ֡ĸƬ, ֻ˳
+        std::cout << "BatchDecoder: packets have no pts, falling back to a single segment" << std::endl;
+    }
+    boundaries.push_back((int)packets.size());
+
+    for (size_t s = 0; s + 1 < boundaries.size(); s++) {
+        GopSegment segment;
+        segment.firstPacket = boundaries[s];
+        segment.lastPacket = boundaries[s + 1];
+        segment.startPts = (s == 0) ? INT64_MIN : packets[boundaries[s]].pts;
+        segment.endPts = (s + 2 == boundaries.size()) ? INT64_MAX : packets[boundaries[s + 1]].pts;
+
+        // open GOP: һؼܻ֮֡ʾʱǰ֡, ǲοƬε֡, Ҫһ
+        if (segment.endPts != INT64_MAX) {
+            for (int i = segment.lastPacket + 1; i < (int)packets.size() && !packets[i].keyFrame; i++) {
+                if (packets[i].pts < segment.endPts) {
+                    segment.lastPacket = i + 1;
+                }
+            }
+        }
+        segments.push_back(segment);
+    }
+
+    outputs.resize(segments.size());
+    for (size_t i = 0; i < outputs.size(); i++) {
+        outputs[i].finished = false;
+    }
+
+    std::cout << "BatchDecoder: " << packets.size() << " packets, " << segments.size() << " segments, "
+        << decoderCount << " decoders" << std::endl;
+    return true;
+}
+
+bool BatchDecoder::openWorker(Worker &worker) {
+    worker.formatContext = NULL;
+    worker.codecContext = NULL;
+    worker.frame = NULL;
+    worker.decodedFrames = 0;
+
+    if (avformat_open_input(&worker.formatContext, fileName.c_str(), NULL, NULL) != 0) {
+        return false;
+    }
+    if (avformat_find_stream_info(worker.formatContext, NULL) < 0) {
+        return false;
+    }
+
+    AVCodecContext *streamCodecContext = worker.formatContext->streams[videoStreamIndex]->codec;
+    AVCodec *codec = avcodec_find_decoder(streamCodecContext->codec_id);
+    if (codec == NULL) {
+        return false;
+    }
+    worker.codecContext = avcodec_alloc_context3(codec);
+    if (avcodec_copy_context(worker.codecContext, streamCodecContext) != 0) {
+        return false;
+    }
+    // жԶʵ, ÿʵֻһ߳
+    worker.codecContext->thread_count = 1;
+    worker.codecContext->refcounted_frames = 1;
+    if (avcodec_open2(worker.codecContext, codec, NULL) < 0) {
+        return false;
+    }
+
+    worker.frame = av_frame_alloc();
+    return worker.frame != NULL;
+}
+
+void BatchDecoder::closeWorker(Worker &worker) {
+    if (worker.frame != NULL) {
+        av_frame_free(&worker.frame);
+    }
+    if (worker.codecContext != NULL) {
+        avcodec_close(worker.codecContext);
+        avcodec_free_context(&worker.codecContext);
+    }
+    if (worker.formatContext != NULL) {
+        avformat_close_input(&worker.formatContext);
+    }
+}
+
+bool BatchDecoder::isSamePacket(const AVPacket &packet, const PacketInfo &info) {
+    if (info.pos >= 0 && packet.pos >= 0) {
+        return packet.pos == info.pos;
+    }
+    return packet.dts == info.dts && packet.pts == info.pts;
+}
+
+/**
+* һ֡Ƭε, ҸƬβǵڶȡƬʱȴ
+*/
+bool BatchDecoder::emitFrame(int segmentIndex, AVFrame *frame) {
+    AVFrame *output = av_frame_alloc();
+    av_frame_move_ref(output, frame);
+
+    pthread_mutex_lock(&lock);
+    while (!stopped && bufferedFrames >= maxBufferedFrames && segmentIndex != consumerSegment) {
+        pthread_cond_wait(&stateChanged, &lock);
+    }
+    if (stopped) {
+        pthread_mutex_unlock(&lock);
+        av_frame_free(&output);
+        return false;
+    }
+    outputs[segmentIndex].frames.push_back(output);
+    bufferedFrames++;
+    pthread_cond_broadcast(&stateChanged);
+    pthread_mutex_unlock(&lock);
+    return true;
+}
+
+bool BatchDecoder::decodeSegment(Worker &worker, int segmentIndex) {
+    const GopSegment &segment = segments[segmentIndex];
+    const PacketInfo &first = packets[segment.firstPacket];
+
+    int64_t seekTarget = first.dts != AV_NOPTS_VALUE ? first.dts : first.pts;
+    if (segment.firstPacket == 0) {
+        av_seek_frame(worker.formatContext, -1, 0, AVSEEK_FLAG_BACKWARD);
+    } else {
+        av_seek_frame(worker.formatContext, videoStreamIndex, seekTarget, AVSEEK_FLAG_BACKWARD);
+    }
+    avcodec_flush_buffers(worker.codecContext);
+
+    AVPacket packet;
+    av_init_packet(&packet);
+    int fed = 0;
+    int packetCount = segment.lastPacket - segment.firstPacket;
+    bool started = false;
+    bool keepGoing = true;
+    int frameFinished = 0;
+
+    while (keepGoing && fed < packetCount && av_read_frame(worker.formatContext, &packet) >= 0) {
+        if (packet.stream_index == videoStreamIndex) {
+            // seekֻܱ֤Ŀؼ֮֡ǰ, ֮ǰİ
+            if (!started) {
+                started = isSamePacket(packet, first);
+            }
+            if (started) {
+                avcodec_decode_video2(worker.codecContext, worker.frame, &frameFinished, &packet);
+                fed++;
+                if (frameFinished) {
+                    int64_t pts = av_frame_get_best_effort_timestamp(worker.frame);
+                    if (pts >= segment.startPts && pts < segment.endPts) {
+                        keepGoing = emitFrame(segmentIndex, worker.frame);
+                        worker.decodedFrames++;
+                    } else {
+                        av_frame_unref(worker.frame);
+                    }
+                }
+            }
+        }
+        av_free_packet(&packet);
+    }
+
+    if (!started) {
+        std::cout << "BatchDecoder: failed to locate the keyframe of segment " << segmentIndex << std::endl;
+    }
+
+    // ȡڲ֡
+    AVPacket flushPacket;
+    av_init_packet(&flushPacket);
+    flushPacket.data = NULL;
+    flushPacket.size = 0;
+    while (keepGoing) {
+        avcodec_decode_video2(worker.codecContext, worker.frame, &frameFinished, &flushPacket);
+        if (!frameFinished) {
+            break;
+        }
+        int64_t pts = av_frame_get_best_effort_timestamp(worker.frame);
+        if (pts >= segment.startPts && pts < segment.endPts) {
+            keepGoing = emitFrame(segmentIndex, worker.frame);
+            worker.decodedFrames++;
+        } else {
+            av_frame_unref(worker.frame);
+        }
+    }
+
+    pthread_mutex_lock(&lock);
+    outputs[segmentIndex].finished = true;
+    pthread_cond_broadcast(&stateChanged);
+    pthread_mutex_unlock(&lock);
+    return keepGoing;
+}
+
+void * BatchDecoder::workerFunc(void *args) {
+    Worker *worker = (Worker *)args;
+    BatchDecoder *decoder = worker->owner;
+
+    while (true) {
+        pthread_mutex_lock(&decoder->lock);
+        int segmentIndex = decoder->stopped ? (int)decoder->segments.size() : decoder->nextSegmentToDecode++;
+        pthread_mutex_unlock(&decoder->lock);
+
+        if (segmentIndex >= (int)decoder->segments.size()) {
+            break;
+        }
+        if (!decoder->decodeSegment(*worker, segmentIndex)) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+int BatchDecoder::run(BatchFrameCallback callback, void *userData) {
+    if (segments.empty()) {
+        return 0;
+    }
+
+    timeMeasurer.Start();
+    int workerCount = decoderCount < (int)segments.size() ? decoderCount : (int)segments.size();
+    workers.resize(workerCount);
+    for (int i = 0; i < workerCount; i++) {
+        workers[i].owner = this;
+        if (!openWorker(workers[i])) {
+            std::cout << "BatchDecoder: failed to open decoder " << i << std::endl;
+            for (int j = 0; j <= i; j++) {
+                closeWorker(workers[j]);
+            }
+            workers.clear();
+            return 0;
+        }
+    }
+    for (int i = 0; i < workerCount; i++) {
+        pthread_create(&workers[i].thread, NULL, workerFunc, &workers[i]);
+    }
+
+    // Ƭ˳ȡ֡, Ƭڵ֡Ѿʾ˳
+    deliveredFrames = 0;
+    bool keepGoing = true;
+    for (int s = 0; s < (int)segments.size() && keepGoing; s++) {
+        pthread_mutex_lock(&lock);
+        consumerSegment = s;
+        pthread_cond_broadcast(&stateChanged);
+        pthread_mutex_unlock(&lock);
+
+        while (keepGoing) {
+            pthread_mutex_lock(&lock);
+            while (outputs[s].frames.empty() && !outputs[s].finished) {
+                pthread_cond_wait(&stateChanged, &lock);
+            }
+            if (outputs[s].frames.empty()) {
+                pthread_mutex_unlock(&lock);
+                break;
+            }
+            AVFrame *frame = outputs[s].frames.front();
+            outputs[s].frames.pop_front();
+            bufferedFrames--;
+            pthread_cond_broadcast(&stateChanged);
+            pthread_mutex_unlock(&lock);
+
+            keepGoing = callback(frame, deliveredFrames++, userData);
+            av_frame_free(&frame);
+        }
+    }
+
+    pthread_mutex_lock(&lock);
+    stopped = true;
+    pthread_cond_broadcast(&stateChanged);
+    pthread_mutex_unlock(&lock);
+
+    for (int i = 0; i < workerCount; i++) {
+        pthread_join(workers[i].thread, NULL);
+        closeWorker(workers[i]);
+    }
+    elapsedMilliSeconds = timeMeasurer.elapsedMillionSecondsSinceStart();
+    return deliveredFrames;
+}
+
+void BatchDecoder::printStatistics() {
+    double fps = elapsedMilliSeconds > 0 ? 1000.0 * deliveredFrames / elapsedMilliSeconds : 0.0;
+    std::cout << "Batch decode: " << deliveredFrames << " frames in " << elapsedMilliSeconds << " ms ("
+        << fps << " fps) with " << workers.size() << " decoders over " << segments.size() << " segments" << std::endl;
+    for (size_t i = 0; i < workers.size(); i++) {
+        std::cout << "Decoder " << i << ": " << workers[i].decodedFrames << " frames" << std::endl;
+    }
+}
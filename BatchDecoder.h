@@ -0,0 +1,104 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <pthread.h>
+#include "TimeMeasurer.h"
+extern "C"
+{
+#include <libavcodec\avcodec.h>
+#include <libavformat\avformat.h>
+};
+
+// ʾ˳򽻸ߵ֡, falseʱֹͣ, frameڻصغ󼴱ͷ
+typedef bool(*BatchFrameCallback)(AVFrame *frame, int frameIndex, void *userData);
+
+/**
+* õGOPн
+* ɨƵаʱؼ֡, ڹؼ֡ļгƬ,
+* decoderCount໥ĽʵнƬ, ʾ˳򽻸
+*/
+class BatchDecoder {
+public:
+    BatchDecoder(const std::string &fileName, int decoderCount);
+    ~BatchDecoder();
+
+    // ɨformatContextƵȫзƬ, ÿƬٰminPacketsPerSegment
+    // ɨformatContextseekļͷ
+    bool scanKeyframes(AVFormatContext *formatContext, int videoStreamIndex, int minPacketsPerSegment);
+
+    // ߳ȵʱ໺֡, ڱȡƬβܴ, 
+    void setMaxBufferedFrames(int frames) {
+        maxBufferedFrames = frames;
+    }
+
+    // ߳, ڵ߳ϰ˳صÿһ֡, ؽص֡
+    int run(BatchFrameCallback callback, void *userData);
+
+    void printStatistics();
+
+private:
+    // ɨõһƵ
+    struct PacketInfo {
+        int64_t pts;
+        int64_t dts;
+        int64_t pos;
+        bool keyFrame;
+    };
+
+    // һɸGOPɵƬ
+    // 뷶Χ[firstPacket, lastPacket)ܰһGOPͷļ,
+    // ʾʱһؼ֡ǰ֡(open GOP)
+    // ֻʾʱ[startPts, endPts)ڵ֡
+    struct GopSegment {
+        int firstPacket;
+        int lastPacket;
+        int64_t startPts;
+        int64_t endPts;
+    };
+
+    // һƬεĽ, ɽ߳д, ̰߳˳ȡ
+    struct SegmentOutput {
+        std::deque<AVFrame *> frames;
+        bool finished;
+    };
+
+    // ÿ̶߳Ľװ
+    struct Worker {
+        BatchDecoder *owner;
+        pthread_t thread;
+        AVFormatContext *formatContext;
+        AVCodecContext *codecContext;
+        AVFrame *frame;
+        int decodedFrames;
+    };
+
+    static void * workerFunc(void *args);
+    bool openWorker(Worker &worker);
+    void closeWorker(Worker &worker);
+    bool decodeSegment(Worker &worker, int segmentIndex);
+    bool emitFrame(int segmentIndex, AVFrame *frame);
+    bool isSamePacket(const AVPacket &packet, const PacketInfo &info);
+
+    std::string fileName;
+    int decoderCount;
+    int videoStreamIndex;
+    int maxBufferedFrames;
+
+    std::vector<PacketInfo> packets;
+    std::vector<GopSegment> segments;
+    std::vector<SegmentOutput> outputs;
+    std::vector<Worker> workers;
+
+    pthread_mutex_t lock;
+    pthread_cond_t stateChanged;
+    int nextSegmentToDecode;
+    int consumerSegment;
+    int bufferedFrames;
+    bool stopped;
+
+    TimeMeasurer timeMeasurer;
+    __int64 elapsedMilliSeconds;
+    int deliveredFrames;
+};
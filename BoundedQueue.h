@@ -0,0 +1,91 @@
+#pragma once
+#include <atomic>
+#include <vector>
+#include <semaphore.h>
+
+/**
+* нĵߵ߶, ˮڵ׶
+* дλֻͨԭӱ, Ҫ; źֻڶпջʱ߳
+*/
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(int capacity) :
+        items(capacity),
+        readCount(0),
+        writeCount(0),
+        closed(false) {
+        sem_init(&filledSemaphore, 0, 0);
+        sem_init(&emptySemaphore, 0, capacity);
+    }
+
+    ~BoundedQueue() {
+        sem_destroy(&filledSemaphore);
+        sem_destroy(&emptySemaphore);
+    }
+
+    // ߵ, ʱ, йرպ󷵻false
+    bool push(const T &item) {
+        sem_wait(&emptySemaphore);
+        if (closed.load(std::memory_order_acquire)) {
+            sem_post(&emptySemaphore);
+            return false;
+        }
+        long long index = writeCount.load(std::memory_order_relaxed);
+        items[index % items.size()] = item;
+        writeCount.store(index + 1, std::memory_order_release);
+        sem_post(&filledSemaphore);
+        return true;
+    }
+
+    // ߵ, пʱ, йرȡʱfalse
+    bool pop(T &item) {
+        sem_wait(&filledSemaphore);
+        return takeItem(item);
+    }
+
+    // pop, ڸ׶߳˳ʣԪ
+    bool tryPop(T &item) {
+        if (sem_trywait(&filledSemaphore) != 0) {
+            return false;
+        }
+        return takeItem(item);
+    }
+
+    // ߻߶Ե, һĲ
+    void close() {
+        if (closed.exchange(true)) {
+            return;
+        }
+        sem_post(&filledSemaphore);
+        sem_post(&emptySemaphore);
+    }
+
+    int size() const {
+        return (int)(writeCount.load(std::memory_order_acquire) - readCount.load(std::memory_order_acquire));
+    }
+
+private:
+    bool takeItem(T &item) {
+        long long index = readCount.load(std::memory_order_relaxed);
+        if (index == writeCount.load(std::memory_order_acquire)) {
+            // Ϊ, ֻclose()ѵ, źȥúҲܷ
+            sem_post(&filledSemaphore);
+            return false;
+        }
+        item = items[index % items.size()];
+        readCount.store(index + 1, std::memory_order_release);
+        sem_post(&emptySemaphore);
+        return true;
+    }
+
+    BoundedQueue(const BoundedQueue &);
+    BoundedQueue &operator=(const BoundedQueue &);
+
+    std::vector<T> items;
+    std::atomic<long long> readCount;
+    std::atomic<long long> writeCount;
+    std::atomic<bool> closed;
+    sem_t filledSemaphore;
+    sem_t emptySemaphore;
+};
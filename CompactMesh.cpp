@@ -0,0 +1,319 @@
+#include "CompactMesh.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+// ģŻʱĺ任С()
+static const int POST_TRANSFORM_CACHE_SIZE = 16;
+// ôεŻ, İ˳ѾԽ, ŻʱڴȴС
+static const int MAX_OPTIMIZED_TRIANGLES = 1 << 21;
+// ʱλð1/65536, òͬʽͬһֻulp
+static const float WELD_POSITION_SCALE = 65536.0f;
+
+/**
+* FIFOģⶥ任, ƽÿεδ(ACMR)
+*/
+static double averageCacheMissRatio(const std::vector<uint32_t> &indices, int vertexCount) {
+    if (indices.size() < 3) {
+        return 0;
+    }
+    std::vector<long long> insertedAt(vertexCount, -POST_TRANSFORM_CACHE_SIZE - 1);
+    long long insertions = 0;
+    for (size_t i = 0; i < indices.size(); i++) {
+        uint32_t vertex = indices[i];
+        if (insertions - insertedAt[vertex] > POST_TRANSFORM_CACHE_SIZE) {
+            insertedAt[vertex] = insertions++;
+        }
+    }
+    return 3.0 * insertions / indices.size();
+}
+
+/**
+* , ϴĸʽͬ
+*/
+static int quantizeCoord(float coord, int coordComponents) {
+    if (coordComponents == 2) {
+        return (int)lroundf(std::max(0.0f, std::min(1.0f, coord)) * 65535.0f);
+    }
+    return (int)lroundf(std::max(-1.0f, std::min(1.0f, coord)) * 32767.0f);
+}
+
+CompactMesh::CompactMesh() :
+    coordComponents(2),
+    vertexStride(0),
+    indexType(GL_UNSIGNED_INT),
+    vertexBuffer(0),
+    indexBuffer(0),
+    sourceVertexCount(0),
+    sourceBytes(0),
+    compactVertexCount(0),
+    compactIndexCount(0),
+    compactBytes(0),
+    sourceCacheMissRatio(0),
+    optimizedCacheMissRatio(0) {
+}
+
+CompactMesh::~CompactMesh() {
+    release();
+}
+
+bool CompactMesh::build(const float *positions, const float *coords, int coordComponents, int vertexCount, const int *indices, int indexCount) {
+    if (positions == NULL || coords == NULL || (coordComponents != 2 && coordComponents != 3) || vertexCount <= 0) {
+        return false;
+    }
+    this->coordComponents = coordComponents;
+    sourceVertexCount = vertexCount;
+    sourceBytes = (size_t)vertexCount * (3 + coordComponents) * sizeof(float) + (indices != NULL ? (size_t)indexCount * sizeof(int) : 0);
+
+    if (indices != NULL) {
+        this->indices.assign(indices, indices + indexCount);
+        sourceVertices.resize(vertexCount);
+        for (int i = 0; i < vertexCount; i++) {
+            sourceVertices[i] = i;
+        }
+    } else {
+        weld(positions, coords, vertexCount);
+    }
+    this->indices.resize(this->indices.size() / 3 * 3);
+    compactVertexCount = (int)sourceVertices.size();
+    compactIndexCount = (int)this->indices.size();
+    sourceCacheMissRatio = averageCacheMissRatio(this->indices, compactVertexCount);
+
+    if (compactIndexCount / 3 <= MAX_OPTIMIZED_TRIANGLES) {
+        optimizeVertexCache();
+    }
+    reorderVertices(positions, coords);
+    optimizedCacheMissRatio = averageCacheMissRatio(this->indices, compactVertexCount);
+
+    // 16λʱ
+    indexType = compactVertexCount <= 65536 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    if (indexType == GL_UNSIGNED_SHORT) {
+        indexData.resize(this->indices.size() * sizeof(uint16_t));
+        uint16_t *shortIndices = (uint16_t *)&indexData[0];
+        for (size_t i = 0; i < this->indices.size(); i++) {
+            shortIndices[i] = (uint16_t)this->indices[i];
+        }
+    } else {
+        indexData.resize(this->indices.size() * sizeof(uint32_t));
+        memcpy(&indexData[0], &this->indices[0], indexData.size());
+    }
+    compactBytes = vertexData.size() + indexData.size();
+    std::vector<uint32_t>().swap(this->indices);
+    std::vector<int>().swap(sourceVertices);
+    return true;
+}
+
+/**
+* ûбλ궼ͬĶϲ, 
+*/
+void CompactMesh::weld(const float *positions, const float *coords, int vertexCount) {
+    struct WeldKey {
+        int values[6];
+        int vertex;
+    };
+    std::vector<WeldKey> keys(vertexCount);
+    for (int i = 0; i < vertexCount; i++) {
+        for (int c = 0; c < 3; c++) {
+            keys[i].values[c] = (int)lroundf(positions[i * 3 + c] * WELD_POSITION_SCALE);
+        }
+        for (int c = 0; c < 3; c++) {
+            keys[i].values[3 + c] = c < coordComponents ? quantizeCoord(coords[i * coordComponents + c], coordComponents) : 0;
+        }
+        keys[i].vertex = i;
+    }
+    std::sort(keys.begin(), keys.end(), [](const WeldKey &a, const WeldKey &b) {
+        int order = memcmp(a.values, b.values, sizeof(a.values));
+        return order != 0 ? order < 0 : a.vertex < b.vertex;
+    });
+
+    indices.resize(vertexCount);
+    sourceVertices.clear();
+    for (int i = 0; i < vertexCount; i++) {
+        if (i == 0 || memcmp(keys[i].values, keys[i - 1].values, sizeof(keys[i].values)) != 0) {
+            sourceVertices.push_back(keys[i].vertex);
+        }
+        indices[keys[i].vertex] = (uint32_t)sourceVertices.size() - 1;
+    }
+}
+
+/**
+* Tipsify(Sander, 2007): ÿȡһ, ڵȫδ, ٴӸĶѡһڻ,
+* κ󲻻ԼĶ; ҲʱĶ, ٲаһ
+*/
+void CompactMesh::optimizeVertexCache() {
+    int vertexCount = compactVertexCount;
+    int triangleCount = (int)indices.size() / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+    std::vector<int> liveTriangles(vertexCount, 0);
+    for (size_t i = 0; i < indices.size(); i++) {
+        liveTriangles[indices[i]]++;
+    }
+    std::vector<int> adjacencyOffsets(vertexCount + 1, 0);
+    for (int v = 0; v < vertexCount; v++) {
+        adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangles[v];
+    }
+    std::vector<int> adjacency(indices.size());
+    std::vector<int> cursors(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (int t = 0; t < triangleCount; t++) {
+        for (int c = 0; c < 3; c++) {
+            adjacency[cursors[indices[t * 3 + c]]++] = t;
+        }
+    }
+
+    std::vector<int> cacheTime(vertexCount, 0);
+    std::vector<char> emitted(triangleCount, 0);
+    std::vector<int> deadEnd;
+    std::vector<int> candidates;
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+    int time = POST_TRANSFORM_CACHE_SIZE + 1;
+    int nextVertex = 0;
+    int fanning = indices[0];
+    while (fanning >= 0) {
+        candidates.clear();
+        for (int k = adjacencyOffsets[fanning]; k < adjacencyOffsets[fanning + 1]; k++) {
+            int t = adjacency[k];
+            if (emitted[t]) {
+                continue;
+            }
+            for (int c = 0; c < 3; c++) {
+                int v = indices[t * 3 + c];
+                output.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                liveTriangles[v]--;
+                if (time - cacheTime[v] > POST_TRANSFORM_CACHE_SIZE) {
+                    cacheTime[v] = time++;
+                }
+            }
+            emitted[t] = 1;
+        }
+
+        fanning = -1;
+        int bestPriority = 0;
+        for (size_t i = 0; i < candidates.size(); i++) {
+            int v = candidates[i];
+            if (liveTriangles[v] <= 0) {
+                continue;
+            }
+            int priority = 0;
+            if (time - cacheTime[v] + 2 * liveTriangles[v] <= POST_TRANSFORM_CACHE_SIZE) {
+                priority = time - cacheTime[v];
+            }
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                fanning = v;
+            }
+        }
+        while (fanning < 0 && !deadEnd.empty()) {
+            int v = deadEnd.back();
+            deadEnd.pop_back();
+            if (liveTriangles[v] > 0) {
+                fanning = v;
+            }
+        }
+        while (fanning < 0 && nextVertex < vertexCount) {
+            if (liveTriangles[nextVertex] > 0) {
+                fanning = nextVertex;
+            }
+            nextVertex++;
+        }
+    }
+    indices.swap(output);
+}
+
+/**
+* еһʹõ˳±, ͬʱոʽдĶ; ûбʹõĶ㶪
+*/
+void CompactMesh::reorderVertices(const float *positions, const float *coords) {
+    std::vector<int> newIndex(compactVertexCount, -1);
+    std::vector<int> order;
+    order.reserve(compactVertexCount);
+    for (size_t i = 0; i < indices.size(); i++) {
+        uint32_t vertex = indices[i];
+        if (newIndex[vertex] < 0) {
+            newIndex[vertex] = (int)order.size();
+            order.push_back(vertex);
+        }
+        indices[i] = newIndex[vertex];
+    }
+    compactVertexCount = (int)order.size();
+
+    // 3ά겹һ, ÿ㱣4ֽڶ
+    vertexStride = 3 * sizeof(float) + (coordComponents == 2 ? 2 : 4) * sizeof(int16_t);
+    vertexData.assign((size_t)compactVertexCount * vertexStride, 0);
+    for (int i = 0; i < compactVertexCount; i++) {
+        int source = sourceVertices[order[i]];
+        uint8_t *vertex = &vertexData[(size_t)i * vertexStride];
+        memcpy(vertex, positions + source * 3, 3 * sizeof(float));
+        if (coordComponents == 2) {
+            uint16_t *packed = (uint16_t *)(vertex + 3 * sizeof(float));
+            for (int c = 0; c < 2; c++) {
+                packed[c] = (uint16_t)quantizeCoord(coords[source * 2 + c], 2);
+            }
+        } else {
+            int16_t *packed = (int16_t *)(vertex + 3 * sizeof(float));
+            for (int c = 0; c < 3; c++) {
+                packed[c] = (int16_t)quantizeCoord(coords[source * 3 + c], 3);
+            }
+        }
+    }
+}
+
+bool CompactMesh::upload() {
+    if (vertexData.empty() || indexData.empty()) {
+        return false;
+    }
+    if (vertexBuffer != 0 || indexBuffer != 0) {
+        release();
+    }
+    glGenBuffers(1, &vertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, vertexData.size(), &vertexData[0], GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, vertexStride, (const void *)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, coordComponents, coordComponents == 2 ? GL_UNSIGNED_SHORT : GL_SHORT, GL_TRUE, vertexStride,
+        (const void *)(3 * sizeof(float)));
+
+    glGenBuffers(1, &indexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexData.size(), &indexData[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    std::vector<uint8_t>().swap(vertexData);
+    std::vector<uint8_t>().swap(indexData);
+    if (glGetError() != GL_NO_ERROR) {
+        std::cout << "Failed to upload a mesh of " << compactVertexCount << " vertices" << std::endl;
+        release();
+        return false;
+    }
+    return true;
+}
+
+void CompactMesh::release() {
+    if (vertexBuffer != 0) {
+        glDeleteBuffers(1, &vertexBuffer);
+        vertexBuffer = 0;
+    }
+    if (indexBuffer != 0) {
+        glDeleteBuffers(1, &indexBuffer);
+        indexBuffer = 0;
+    }
+}
+
+void CompactMesh::draw() const {
+    if (indexBuffer == 0) {
+        return;
+    }
+    glDrawElements(GL_TRIANGLES, compactIndexCount, indexType, (const void *)0);
+}
+
+void CompactMesh::printStatistics(const char *name) const {
+    std::cout << name << " mesh: " << sourceVertexCount << " -> " << compactVertexCount << " vertices, "
+        << sourceBytes / 1024.0 << " KB -> " << compactBytes / 1024.0 << " KB, "
+        << (indexType == GL_UNSIGNED_SHORT ? 16 : 32) << "-bit indices, ACMR " << sourceCacheMissRatio << " -> " << optimizedCacheMissRatio << std::endl;
+}
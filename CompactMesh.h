@@ -0,0 +1,64 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "glew.h"
+
+/**
+* ͶӰĽմ洢, ͶӰͬһֽĶʽglDrawElements
+* : λΪ3float, Ϊһ16λ, 2ά([0, 1])GL_UNSIGNED_SHORT, 3ά([-1, 1])GL_SHORT
+* ûбȺظĶ; ΰ任(Tipsify), ٰһʹõ˳
+* 65536ʱ16λ; buildֻCPUϼ, uploaddrawڳGLĵ߳е
+*/
+class CompactMesh {
+public:
+    CompactMesh();
+    ~CompactMesh();
+
+    // positionsÿ3float, coordsÿcoordComponents(23)float; indicesΪNULLʱÿ3һ
+    bool build(const float *positions, const float *coords, int coordComponents, int vertexCount, const int *indices, int indexCount);
+    // ڵǰ󶨵VAOд, 0(λ)1(), ֮ͷCPUϵ
+    bool upload();
+    void release();
+    // ǰuploadʱVAO
+    void draw() const;
+
+    int vertexCount() const {
+        return compactVertexCount;
+    }
+
+    int indexCount() const {
+        return compactIndexCount;
+    }
+
+    // ÿƽҪ任Ķ, FIFO任ģ, Խӽ0.5Խ
+    double cacheMissRatio() const {
+        return optimizedCacheMissRatio;
+    }
+
+    void printStatistics(const char *name) const;
+
+private:
+    void weld(const float *positions, const float *coords, int vertexCount);
+    void optimizeVertexCache();
+    void reorderVertices(const float *positions, const float *coords);
+
+    int coordComponents;
+    int vertexStride;
+    GLenum indexType;
+    std::vector<uint8_t> vertexData;
+    std::vector<uint8_t> indexData;
+    std::vector<uint32_t> indices; // е, ָsourceVerticesеĶ
+    std::vector<int> sourceVertices; // ն -> ԭʼ
+    GLuint vertexBuffer;
+    GLuint indexBuffer;
+
+    // ͳϢ
+    int sourceVertexCount;
+    size_t sourceBytes; // ԭĸʽ: λúһfloat, ʱΪ32λ
+    int compactVertexCount;
+    int compactIndexCount;
+    size_t compactBytes;
+    double sourceCacheMissRatio;
+    double optimizedCacheMissRatio;
+};
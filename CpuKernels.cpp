@@ -0,0 +1,1032 @@
+#include "CpuKernels.h"
+#include <iostream>
+#include <vector>
+#include <math.h>
+#include <string.h>
+#include <cuda_runtime.h>
+#include "NV12TORGBA.h"
+#include "TimeMeasurer.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define CPU_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+// yuvConverter.cppͬ, GCC/ClangҪAVX2
+#if defined(CPU_KERNELS_X86) && defined(__GNUC__)
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
+namespace CpuKernels {
+
+	// ÿ߳ƽֵ
+	static const int BANDS_PER_THREAD = 4;
+
+	static bool use_avx2(YuvConverterKernel kernel) {
+#ifdef CPU_KERNELS_X86
+		return (kernel == YCK_AVX2 || kernel == YCK_AUTO) && yuv_converter_kernel_supported(YCK_AVX2);
+#else
+		return false;
+#endif
+	}
+
+	/**
+	* rowCountг̳߳ϲ, function(first, last)[first, last)
+	*/
+	template <class Function>
+	static void parallel_rows(ThreadPool *pool, int rowCount, const Function &function) {
+		struct Context {
+			const Function *function;
+			int rowCount;
+			int bandCount;
+		};
+		struct Band {
+			static void run(void *context, int bandIndex) {
+				const Context *c = (const Context *)context;
+				(*c->function)(c->rowCount * bandIndex / c->bandCount, c->rowCount * (bandIndex + 1) / c->bandCount);
+			}
+		};
+
+		Context context = { &function, rowCount, 1 };
+		if (pool != NULL) {
+			context.bandCount = pool->size() * BANDS_PER_THREAD;
+			if (context.bandCount > rowCount) {
+				context.bandCount = rowCount;
+			}
+		}
+		if (context.bandCount > 1) {
+			pool->parallelFor(context.bandCount, Band::run, &context);
+		} else if (rowCount > 0) {
+			function(0, rowCount);
+		}
+	}
+
+	// CUDAиת޷ʱȡǯλĿ͵ķΧ, CPUҪʽǯλ
+	template <class T>
+	static inline T saturate_cast(double value) {
+		const double maxValue = (double)(T)~(T)0;
+		return value <= 0 ? (T)0 : (value >= maxValue ? (T)~(T)0 : (T)value);
+	}
+
+	bool cudaDeviceAvailable() {
+		int deviceCount = 0;
+		if (cudaGetDeviceCount(&deviceCount) != cudaSuccess) {
+			return false;
+		}
+		return deviceCount > 0;
+	}
+
+	KernelDevice resolveKernelDevice(KernelDevice requested) {
+		if (requested == KD_CPU) {
+			return KD_CPU;
+		}
+		return cudaDeviceAvailable() ? KD_CUDA : KD_CPU;
+	}
+
+	/************************************************************************/
+	/* NV12TORGBA.cu                                                        */
+	/************************************************************************/
+
+	static void nv12_to_rgba_scalar(const unsigned char *pYdata, const unsigned char *pUVdata, int stepY, int stepUV,
+		unsigned char *pImgData, int width, int y, int startX) {
+		const unsigned char *rowY = pYdata + y * stepY;
+		const unsigned char *rowUV = pUVdata + y / 2 * stepUV;
+		unsigned char *dest = pImgData + y * width * 4;
+		for (int x = startX; x < width; x++) {
+			// ߵżйһUV
+			int pair = x & ~1;
+			unsigned char Y = rowY[x];
+			unsigned char U = rowUV[pair];
+			unsigned char V = rowUV[pair + 1];
+			dest[x * 4 + 0] = saturate_cast<unsigned char>(Y + 1.402 * (V - 128));
+			dest[x * 4 + 1] = saturate_cast<unsigned char>(Y - 0.34413 * (U - 128) - 0.71414 * (V - 128));
+			dest[x * 4 + 2] = saturate_cast<unsigned char>(Y + 1.772 * (U - 128));
+			dest[x * 4 + 3] = 255;
+		}
+	}
+
+#ifdef CPU_KERNELS_X86
+	// 8int32ǯλ8ֽ, ڽĵ64λ
+	TARGET_AVX2 static inline __m128i pack_u8_avx2(__m256i values) {
+		__m256i packed16 = _mm256_permute4x64_epi64(_mm256_packus_epi32(values, values), 0x08);
+		__m128i low = _mm256_castsi256_si128(packed16);
+		return _mm_packus_epi16(low, low);
+	}
+
+	// Y + coefficient * chroma, ʵһdouble, ÿ4
+	TARGET_AVX2 static inline __m128i nv12_channel_avx2(__m256d y, __m256d chroma, double coefficient) {
+		return _mm256_cvttpd_epi32(_mm256_add_pd(y, _mm256_mul_pd(_mm256_set1_pd(coefficient), chroma)));
+	}
+
+	// 4صR, G, B, ȡԸĵ4ֽ
+	TARGET_AVX2 static inline void nv12_quad_avx2(__m128i y4, __m128i u4, __m128i v4, __m128i &r, __m128i &g, __m128i &b) {
+		const __m128i chromaOffset = _mm_set1_epi32(128);
+		__m256d fy = _mm256_cvtepi32_pd(_mm_cvtepu8_epi32(y4));
+		__m256d fu = _mm256_cvtepi32_pd(_mm_sub_epi32(_mm_cvtepu8_epi32(u4), chromaOffset));
+		__m256d fv = _mm256_cvtepi32_pd(_mm_sub_epi32(_mm_cvtepu8_epi32(v4), chromaOffset));
+		r = nv12_channel_avx2(fy, fv, 1.402);
+		// Y - 0.34413 * (U - 128) - 0.71414 * (V - 128), ʵֵ˳һ
+		__m256d green = _mm256_sub_pd(fy, _mm256_mul_pd(_mm256_set1_pd(0.34413), fu));
+		g = _mm256_cvttpd_epi32(_mm256_sub_pd(green, _mm256_mul_pd(_mm256_set1_pd(0.71414), fv)));
+		b = nv12_channel_avx2(fy, fu, 1.772);
+	}
+
+	TARGET_AVX2 static void nv12_to_rgba_avx2(const unsigned char *pYdata, const unsigned char *pUVdata, int stepY, int stepUV,
+		unsigned char *pImgData, int width, int y) {
+		const unsigned char *rowY = pYdata + y * stepY;
+		const unsigned char *rowUV = pUVdata + y / 2 * stepUV;
+		unsigned char *dest = pImgData + y * width * 4;
+		const __m128i duplicateU = _mm_setr_epi8(0, 0, 2, 2, 4, 4, 6, 6, -1, -1, -1, -1, -1, -1, -1, -1);
+		const __m128i duplicateV = _mm_setr_epi8(1, 1, 3, 3, 5, 5, 7, 7, -1, -1, -1, -1, -1, -1, -1, -1);
+		int x = 0;
+		for (; x + 8 <= width; x += 8) {
+			__m128i y8 = _mm_loadl_epi64((const __m128i *)(rowY + x));
+			__m128i uv8 = _mm_loadl_epi64((const __m128i *)(rowUV + x));
+			__m128i u8 = _mm_shuffle_epi8(uv8, duplicateU);
+			__m128i v8 = _mm_shuffle_epi8(uv8, duplicateV);
+			__m128i r[2], g[2], b[2];
+			nv12_quad_avx2(y8, u8, v8, r[0], g[0], b[0]);
+			nv12_quad_avx2(_mm_srli_si128(y8, 4), _mm_srli_si128(u8, 4), _mm_srli_si128(v8, 4), r[1], g[1], b[1]);
+			__m128i red = _mm_packus_epi16(_mm_packus_epi32(r[0], r[1]), _mm_setzero_si128());
+			__m128i greenBytes = _mm_packus_epi16(_mm_packus_epi32(g[0], g[1]), _mm_setzero_si128());
+			__m128i blue = _mm_packus_epi16(_mm_packus_epi32(b[0], b[1]), _mm_setzero_si128());
+			__m128i rg = _mm_unpacklo_epi8(red, greenBytes);
+			__m128i ba = _mm_unpacklo_epi8(blue, _mm_set1_epi8(-1));
+			_mm_storeu_si128((__m128i *)(dest + x * 4), _mm_unpacklo_epi16(rg, ba));
+			_mm_storeu_si128((__m128i *)(dest + x * 4 + 16), _mm_unpackhi_epi16(rg, ba));
+		}
+		nv12_to_rgba_scalar(pYdata, pUVdata, stepY, stepUV, pImgData, width, y, x);
+	}
+#endif
+
+	void NV12TORGBA(const unsigned char *pYdata, const unsigned char *pUVdata, int stepY, int stepUV,
+		unsigned char *pImgData, int width, int height, int channels, ThreadPool *pool, YuvConverterKernel kernel) {
+		bool avx2 = use_avx2(kernel);
+		parallel_rows(pool, height, [&](int first, int last) {
+			for (int y = first; y < last; y++) {
+#ifdef CPU_KERNELS_X86
+				if (avx2) {
+					nv12_to_rgba_avx2(pYdata, pUVdata, stepY, stepUV, pImgData, width, y);
+					continue;
+				}
+#endif
+				nv12_to_rgba_scalar(pYdata, pUVdata, stepY, stepUV, pImgData, width, y, 0);
+			}
+		});
+	}
+
+	/************************************************************************/
+	/* ColorSpace.cu                                                        */
+	/************************************************************************/
+
+	struct ColorMatrix {
+		float m[3][3];
+	};
+
+	static void GetConstants(int iMatrix, float &wr, float &wb, int &black, int &white, int &max) {
+		// Default is BT709
+		wr = 0.2126f; wb = 0.0722f;
+		black = 16; white = 235;
+		max = 255;
+		if (iMatrix == ColorSpaceStandard_BT601) {
+			wr = 0.2990f; wb = 0.1140f;
+		} else if (iMatrix == ColorSpaceStandard_BT2020) {
+			wr = 0.2627f; wb = 0.0593f;
+			// 10-bit only
+			black = 64 << 6; white = 940 << 6;
+			max = (1 << 16) - 1;
+		}
+	}
+
+	// SetMatYuv2Rgbļȫͬ, ֤λһ; ȫΧʱYUVѾռȡֵΧ, ٷŴ
+	static ColorMatrix yuv_to_rgb_matrix(int iMatrix, bool fullRange) {
+		float wr, wb;
+		int black, white, max;
+		GetConstants(iMatrix, wr, wb, black, white, max);
+		double scale = fullRange ? 1.0 : 1.0 * max / (white - black);
+		ColorMatrix matrix = { {
+			{ 1.0f, 0.0f, (1.0f - wr) / 0.5f },
+			{ 1.0f, -wb * (1.0f - wb) / 0.5f / (1 - wb - wr), -wr * (1 - wr) / 0.5f / (1 - wb - wr) },
+			{ 1.0f, (1.0f - wb) / 0.5f, 0.0f },
+		} };
+		for (int i = 0; i < 3; i++) {
+			for (int j = 0; j < 3; j++) {
+				matrix.m[i][j] = (float)(scale * matrix.m[i][j]);
+			}
+		}
+		return matrix;
+	}
+
+	static ColorMatrix rgb_to_yuv_matrix(int iMatrix) {
+		float wr, wb;
+		int black, white, max;
+		GetConstants(iMatrix, wr, wb, black, white, max);
+		ColorMatrix matrix = { {
+			{ wr, 1.0f - wb - wr, wb },
+			{ -0.5f * wr / (1.0f - wb), -0.5f * (1 - wb - wr) / (1.0f - wb), 0.5f },
+			{ 0.5f, -0.5f * (1.0f - wb - wr) / (1.0f - wr), -0.5f * wb / (1.0f - wr) },
+		} };
+		for (int i = 0; i < 3; i++) {
+			for (int j = 0; j < 3; j++) {
+				matrix.m[i][j] = (float)(1.0 * (white - black) / max * matrix.m[i][j]);
+			}
+		}
+		return matrix;
+	}
+
+	template <class T>
+	static inline T Clamp(T x, T lower, T upper) {
+		return x < lower ? lower : (x > upper ? upper : x);
+	}
+
+	// B, G, R˳дbgr, lowΪYĺڵƽ
+	template <class RgbUnit, class YuvUnit>
+	static inline void YuvToRgbForPixel(const ColorMatrix &matrix, int low, YuvUnit y, YuvUnit u, YuvUnit v, RgbUnit bgr[3]) {
+		const int mid = 1 << (sizeof(YuvUnit) * 8 - 1);
+		float fy = (float)((int)y - low), fu = (float)((int)u - mid), fv = (float)((int)v - mid);
+		const float maxf = (1 << sizeof(YuvUnit) * 8) - 1.0f;
+		const float (*m)[3] = matrix.m;
+		YuvUnit
+			r = (YuvUnit)Clamp(m[0][0] * fy + m[0][1] * fu + m[0][2] * fv, 0.0f, maxf),
+			g = (YuvUnit)Clamp(m[1][0] * fy + m[1][1] * fu + m[1][2] * fv, 0.0f, maxf),
+			b = (YuvUnit)Clamp(m[2][0] * fy + m[2][1] * fu + m[2][2] * fv, 0.0f, maxf);
+
+		if (sizeof(YuvUnit) >= sizeof(RgbUnit)) {
+			const int shift = (int)(sizeof(YuvUnit) - sizeof(RgbUnit)) * 8;
+			bgr[0] = (RgbUnit)(b >> shift);
+			bgr[1] = (RgbUnit)(g >> shift);
+			bgr[2] = (RgbUnit)(r >> shift);
+		} else {
+			const int shift = (int)(sizeof(RgbUnit) - sizeof(YuvUnit)) * 8;
+			bgr[0] = (RgbUnit)(b << shift);
+			bgr[1] = (RgbUnit)(g << shift);
+			bgr[2] = (RgbUnit)(r << shift);
+		}
+	}
+
+	// һYUVRGBתĲ
+	struct YuvToRgbTask {
+		ColorMatrix matrix;
+		int low; // Yĺڵƽ, ȫΧʱΪ0
+		const uint8_t *pYuv;
+		int nYuvPitch;
+		const uint8_t *pU; // UVƽʱpV = pU + һ
+		const uint8_t *pV;
+		int nChromaPitch;
+		int chromaStep; // ͬһƽɫĵԪ, ʱΪ2, U, VƽʱΪ1
+		uint8_t *pRgb;
+		int nRgbPitch;
+		int nWidth;
+		int nHeight;
+		bool rgba; // packedR, G, B, A, B, G, R, A
+	};
+
+	// ѼõдpackedBGRA/RGBAB, G, Rƽ, alphaΪֵ
+	template <class RgbUnit, bool PLANAR>
+	static inline void store_rgb_pixel(const YuvToRgbTask &task, int x, int y, const RgbUnit bgr[3]) {
+		if (PLANAR) {
+			size_t planeBytes = (size_t)task.nRgbPitch * task.nHeight;
+			for (int c = 0; c < 3; c++) {
+				((RgbUnit *)(task.pRgb + c * planeBytes + (size_t)y * task.nRgbPitch))[x] = bgr[c];
+			}
+		} else {
+			RgbUnit *dest = (RgbUnit *)(task.pRgb + (size_t)y * task.nRgbPitch) + x * 4;
+			dest[0] = task.rgba ? bgr[2] : bgr[0];
+			dest[1] = bgr[1];
+			dest[2] = task.rgba ? bgr[0] : bgr[2];
+			dest[3] = (RgbUnit)~(RgbUnit)0;
+		}
+	}
+
+	// ת(x, y)һ, ڿΪʱһ/
+	template <class YuvUnit, class RgbUnit, bool PLANAR>
+	static inline void yuv_to_rgb_pixel_scalar(const YuvToRgbTask &task, int x, int y) {
+		const YuvUnit *line = (const YuvUnit *)(task.pYuv + (size_t)y * task.nYuvPitch);
+		size_t chromaOffset = (size_t)(y / 2) * task.nChromaPitch;
+		int c = (x / 2) * task.chromaStep;
+		RgbUnit bgr[3];
+		YuvToRgbForPixel<RgbUnit>(task.matrix, task.low, line[x],
+			((const YuvUnit *)(task.pU + chromaOffset))[c], ((const YuvUnit *)(task.pV + chromaOffset))[c], bgr);
+		store_rgb_pixel<RgbUnit, PLANAR>(task, x, y, bgr);
+	}
+
+	// תy, y + 1дstartXʼ2x2, Ϊʱתһ
+	template <class YuvUnit, class RgbUnit, bool PLANAR>
+	static void yuv_to_rgb_row_pair_scalar(const YuvToRgbTask &task, int y, int startX) {
+		const YuvUnit *line0 = (const YuvUnit *)(task.pYuv + (size_t)y * task.nYuvPitch);
+		const YuvUnit *line1 = (const YuvUnit *)(task.pYuv + (size_t)(y + 1) * task.nYuvPitch);
+		const YuvUnit *chromaU = (const YuvUnit *)(task.pU + (size_t)(y / 2) * task.nChromaPitch);
+		const YuvUnit *chromaV = (const YuvUnit *)(task.pV + (size_t)(y / 2) * task.nChromaPitch);
+		for (int x = startX; x + 1 < task.nWidth; x += 2) {
+			int c = (x / 2) * task.chromaStep;
+			YuvUnit u = chromaU[c], v = chromaV[c];
+			RgbUnit bgr[3];
+			YuvToRgbForPixel<RgbUnit>(task.matrix, task.low, line0[x], u, v, bgr);
+			store_rgb_pixel<RgbUnit, PLANAR>(task, x, y, bgr);
+			YuvToRgbForPixel<RgbUnit>(task.matrix, task.low, line0[x + 1], u, v, bgr);
+			store_rgb_pixel<RgbUnit, PLANAR>(task, x + 1, y, bgr);
+			YuvToRgbForPixel<RgbUnit>(task.matrix, task.low, line1[x], u, v, bgr);
+			store_rgb_pixel<RgbUnit, PLANAR>(task, x, y + 1, bgr);
+			YuvToRgbForPixel<RgbUnit>(task.matrix, task.low, line1[x + 1], u, v, bgr);
+			store_rgb_pixel<RgbUnit, PLANAR>(task, x + 1, y + 1, bgr);
+		}
+		if (task.nWidth % 2 != 0) {
+			yuv_to_rgb_pixel_scalar<YuvUnit, RgbUnit, PLANAR>(task, task.nWidth - 1, y);
+			yuv_to_rgb_pixel_scalar<YuvUnit, RgbUnit, PLANAR>(task, task.nWidth - 1, y + 1);
+		}
+	}
+
+#ifdef CPU_KERNELS_X86
+	// YuvToRgbForPixelͬ˳, ʹFMA, λһ
+	TARGET_AVX2 static inline __m128i yuv_to_rgb_channel_avx2(const float row[3], __m256 fy, __m256 fu, __m256 fv) {
+		__m256 value = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(row[0]), fy), _mm256_mul_ps(_mm256_set1_ps(row[1]), fu)),
+			_mm256_mul_ps(_mm256_set1_ps(row[2]), fv));
+		value = _mm256_min_ps(_mm256_max_ps(value, _mm256_setzero_ps()), _mm256_set1_ps(255.0f));
+		return pack_u8_avx2(_mm256_cvttps_epi32(value));
+	}
+
+	// 8λNV12/YUV420P8λBGRA/RGBABGRƽ, ÿ8
+	template <bool PLANAR>
+	TARGET_AVX2 static void yuv_to_rgb_row_pair_avx2(const YuvToRgbTask &task, int y) {
+		const __m128i duplicateU = _mm_setr_epi8(0, 0, 2, 2, 4, 4, 6, 6, -1, -1, -1, -1, -1, -1, -1, -1);
+		const __m128i duplicateV = _mm_setr_epi8(1, 1, 3, 3, 5, 5, 7, 7, -1, -1, -1, -1, -1, -1, -1, -1);
+		const __m128i duplicate = _mm_setr_epi8(0, 0, 1, 1, 2, 2, 3, 3, -1, -1, -1, -1, -1, -1, -1, -1);
+		const __m128i alpha = _mm_set1_epi8(-1);
+		const uint8_t *chromaU = task.pU + (size_t)(y / 2) * task.nChromaPitch;
+		const uint8_t *chromaV = task.pV + (size_t)(y / 2) * task.nChromaPitch;
+		size_t planeBytes = (size_t)task.nRgbPitch * task.nHeight;
+		int width = task.nWidth & ~1;
+		int x = 0;
+		for (; x + 8 <= width; x += 8) {
+			__m128i u8, v8;
+			if (task.chromaStep == 2) {
+				__m128i uv8 = _mm_loadl_epi64((const __m128i *)(chromaU + x));
+				u8 = _mm_shuffle_epi8(uv8, duplicateU);
+				v8 = _mm_shuffle_epi8(uv8, duplicateV);
+			} else {
+				int u4, v4;
+				memcpy(&u4, chromaU + x / 2, sizeof(u4));
+				memcpy(&v4, chromaV + x / 2, sizeof(v4));
+				u8 = _mm_shuffle_epi8(_mm_cvtsi32_si128(u4), duplicate);
+				v8 = _mm_shuffle_epi8(_mm_cvtsi32_si128(v4), duplicate);
+			}
+			__m256 fu = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_cvtepu8_epi32(u8), _mm256_set1_epi32(128)));
+			__m256 fv = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_cvtepu8_epi32(v8), _mm256_set1_epi32(128)));
+			for (int row = y; row < y + 2; row++) {
+				__m128i y8 = _mm_loadl_epi64((const __m128i *)(task.pYuv + (size_t)row * task.nYuvPitch + x));
+				__m256 fy = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_cvtepu8_epi32(y8), _mm256_set1_epi32(task.low)));
+				__m128i r = yuv_to_rgb_channel_avx2(task.matrix.m[0], fy, fu, fv);
+				__m128i g = yuv_to_rgb_channel_avx2(task.matrix.m[1], fy, fu, fv);
+				__m128i b = yuv_to_rgb_channel_avx2(task.matrix.m[2], fy, fu, fv);
+				uint8_t *dest = task.pRgb + (size_t)row * task.nRgbPitch;
+				if (PLANAR) {
+					_mm_storel_epi64((__m128i *)(dest + x), b);
+					_mm_storel_epi64((__m128i *)(dest + planeBytes + x), g);
+					_mm_storel_epi64((__m128i *)(dest + 2 * planeBytes + x), r);
+				} else {
+					__m128i first = _mm_unpacklo_epi8(task.rgba ? r : b, g);
+					__m128i second = _mm_unpacklo_epi8(task.rgba ? b : r, alpha);
+					_mm_storeu_si128((__m128i *)(dest + x * 4), _mm_unpacklo_epi16(first, second));
+					_mm_storeu_si128((__m128i *)(dest + x * 4 + 16), _mm_unpackhi_epi16(first, second));
+				}
+			}
+		}
+		yuv_to_rgb_row_pair_scalar<uint8_t, uint8_t, PLANAR>(task, y, x);
+	}
+#endif
+
+	/**
+	* pU, pVΪɫƽ, chromaStepΪ2ʱU, VpUʼƽ
+	* жԲת, ߶Ϊʱһеת
+	*/
+	template <class YuvUnit, class RgbUnit, bool PLANAR>
+	static void yuv_to_rgb(const uint8_t *pYuv, int nYuvPitch, const uint8_t *pU, const uint8_t *pV, int nChromaPitch, int chromaStep,
+		uint8_t *pRgb, int nRgbPitch, int nWidth, int nHeight, int iMatrix, bool fullRange, bool rgba,
+		ThreadPool *pool, YuvConverterKernel kernel) {
+		YuvToRgbTask task;
+		task.matrix = yuv_to_rgb_matrix(iMatrix, fullRange);
+		task.low = fullRange ? 0 : 1 << (sizeof(YuvUnit) * 8 - 4);
+		task.pYuv = pYuv;
+		task.nYuvPitch = nYuvPitch;
+		task.pU = pU;
+		task.pV = pV;
+		task.nChromaPitch = nChromaPitch;
+		task.chromaStep = chromaStep;
+		task.pRgb = pRgb;
+		task.nRgbPitch = nRgbPitch;
+		task.nWidth = nWidth;
+		task.nHeight = nHeight;
+		task.rgba = rgba;
+		// ֻ8λ8λAVX2ʵ
+		bool avx2 = use_avx2(kernel) && sizeof(YuvUnit) == 1 && sizeof(RgbUnit) == 1;
+		parallel_rows(pool, nHeight / 2, [&](int first, int last) {
+			for (int pair = first; pair < last; pair++) {
+#ifdef CPU_KERNELS_X86
+				if (avx2) {
+					yuv_to_rgb_row_pair_avx2<PLANAR>(task, pair * 2);
+					continue;
+				}
+#endif
+				yuv_to_rgb_row_pair_scalar<YuvUnit, RgbUnit, PLANAR>(task, pair * 2, 0);
+			}
+		});
+		if (nHeight % 2 != 0) {
+			for (int x = 0; x < nWidth; x++) {
+				yuv_to_rgb_pixel_scalar<YuvUnit, RgbUnit, PLANAR>(task, x, nHeight - 1);
+			}
+		}
+	}
+
+	// ColorSpace.cuĽӿ: ƷΧ, UVYƽпͬ, pChromaΪNULLʱYƽ֮
+	template <class YuvUnit, class RgbUnit, bool PLANAR>
+	static void nv12_to_rgb(const uint8_t *pYuv, int nYuvPitch, uint8_t *pRgb, int nRgbPitch, int nWidth, int nHeight, int iMatrix,
+		ThreadPool *pool, YuvConverterKernel kernel, const uint8_t *pChroma) {
+		// ɫƽΪ(nHeight + 1) / 2, Yƽ֮
+		const uint8_t *pU = pChroma != NULL ? pChroma : pYuv + (size_t)nHeight * nYuvPitch;
+		yuv_to_rgb<YuvUnit, RgbUnit, PLANAR>(pYuv, nYuvPitch, pU, pU + sizeof(YuvUnit), nYuvPitch, 2, pRgb, nRgbPitch,
+			nWidth, nHeight, iMatrix, false, false, pool, kernel);
+	}
+
+	void Nv12ToBgra32(const uint8_t *pNv12, int nNv12Pitch, uint8_t *pBgra, int nBgraPitch, int nWidth, int nHeight, int iMatrix,
+		ThreadPool *pool, YuvConverterKernel kernel, const uint8_t *pChroma) {
+		nv12_to_rgb<uint8_t, uint8_t, false>(pNv12, nNv12Pitch, pBgra, nBgraPitch, nWidth, nHeight, iMatrix, pool, kernel, pChroma);
+	}
+
+	void Nv12ToBgra64(const uint8_t *pNv12, int nNv12Pitch, uint8_t *pBgra, int nBgraPitch, int nWidth, int nHeight, int iMatrix,
+		ThreadPool *pool, YuvConverterKernel kernel, const uint8_t *pChroma) {
+		nv12_to_rgb<uint8_t, uint16_t, false>(pNv12, nNv12Pitch, pBgra, nBgraPitch, nWidth, nHeight, iMatrix, pool, kernel, pChroma);
+	}
+
+	void P016ToBgra32(const uint8_t *pP016, int nP016Pitch, uint8_t *pBgra, int nBgraPitch, int nWidth, int nHeight, int iMatrix,
+		ThreadPool *pool, YuvConverterKernel kernel, const uint8_t *pChroma) {
+		nv12_to_rgb<uint16_t, uint8_t, false>(pP016, nP016Pitch, pBgra, nBgraPitch, nWidth, nHeight, iMatrix, pool, kernel, pChroma);
+	}
+
+	void P016ToBgra64(const uint8_t *pP016, int nP016Pitch, uint8_t *pBgra, int nBgraPitch, int nWidth, int nHeight, int iMatrix,
+		ThreadPool *pool, YuvConverterKernel kernel, const uint8_t *pChroma) {
+		nv12_to_rgb<uint16_t, uint16_t, false>(pP016, nP016Pitch, pBgra, nBgraPitch, nWidth, nHeight, iMatrix, pool, kernel, pChroma);
+	}
+
+	void Nv12ToBgrPlanar(const uint8_t *pNv12, int nNv12Pitch, uint8_t *pBgrp, int nBgrpPitch, int nWidth, int nHeight, int iMatrix,
+		ThreadPool *pool, YuvConverterKernel kernel, const uint8_t *pChroma) {
+		nv12_to_rgb<uint8_t, uint8_t, true>(pNv12, nNv12Pitch, pBgrp, nBgrpPitch, nWidth, nHeight, iMatrix, pool, kernel, pChroma);
+	}
+
+	void P016ToBgrPlanar(const uint8_t *pP016, int nP016Pitch, uint8_t *pBgrp, int nBgrpPitch, int nWidth, int nHeight, int iMatrix,
+		ThreadPool *pool, YuvConverterKernel kernel, const uint8_t *pChroma) {
+		nv12_to_rgb<uint16_t, uint8_t, true>(pP016, nP016Pitch, pBgrp, nBgrpPitch, nWidth, nHeight, iMatrix, pool, kernel, pChroma);
+	}
+
+	void Yuv420ToRgba32(const uint8_t *pY, int nYPitch, const uint8_t *pU, const uint8_t *pV, int nChromaPitch,
+		uint8_t *pRgba, int nRgbaPitch, int nWidth, int nHeight, int iMatrix, bool bFullRange, bool bRgba,
+		ThreadPool *pool, YuvConverterKernel kernel) {
+		if (pV == NULL) {
+			yuv_to_rgb<uint8_t, uint8_t, false>(pY, nYPitch, pU, pU + 1, nChromaPitch, 2, pRgba, nRgbaPitch,
+				nWidth, nHeight, iMatrix, bFullRange, bRgba, pool, kernel);
+		} else {
+			yuv_to_rgb<uint8_t, uint8_t, false>(pY, nYPitch, pU, pV, nChromaPitch, 1, pRgba, nRgbaPitch,
+				nWidth, nHeight, iMatrix, bFullRange, bRgba, pool, kernel);
+		}
+	}
+
+	void P016ToRgba32(const uint8_t *pY, int nYPitch, const uint8_t *pUV, int nChromaPitch,
+		uint8_t *pRgba, int nRgbaPitch, int nWidth, int nHeight, int iMatrix, bool bFullRange, bool bRgba,
+		ThreadPool *pool, YuvConverterKernel kernel) {
+		yuv_to_rgb<uint16_t, uint8_t, false>(pY, nYPitch, pUV, pUV + sizeof(uint16_t), nChromaPitch, 2, pRgba, nRgbaPitch,
+			nWidth, nHeight, iMatrix, bFullRange, bRgba, pool, kernel);
+	}
+
+	template <class YuvUnit>
+	static inline YuvUnit RgbToYuv(const float row[3], float r, float g, float b, YuvUnit offset) {
+		return saturate_cast<YuvUnit>(row[0] * r + row[1] * g + row[2] * b + offset);
+	}
+
+	// ֻ16λİ汾, ûAVX2ʵ
+	void Bgra64ToP016(const uint8_t *pBgra, int nBgraPitch, uint8_t *pP016, int nP016Pitch, int nWidth, int nHeight, int iMatrix,
+		ThreadPool *pool, YuvConverterKernel kernel) {
+		const ColorMatrix matrix = rgb_to_yuv_matrix(iMatrix);
+		const uint16_t low = 1 << 12, mid = 1 << 15;
+		parallel_rows(pool, nHeight / 2, [&](int first, int last) {
+			for (int pair = first; pair < last; pair++) {
+				int y = pair * 2;
+				const uint16_t *src0 = (const uint16_t *)(pBgra + (size_t)y * nBgraPitch);
+				const uint16_t *src1 = (const uint16_t *)(pBgra + (size_t)(y + 1) * nBgraPitch);
+				uint16_t *dst0 = (uint16_t *)(pP016 + (size_t)y * nP016Pitch);
+				uint16_t *dst1 = (uint16_t *)(pP016 + (size_t)(y + 1) * nP016Pitch);
+				uint16_t *chroma = (uint16_t *)(pP016 + (size_t)(nHeight + pair) * nP016Pitch);
+				for (int x = 0; x + 1 < nWidth; x += 2) {
+					// ÿΪB, G, R, A
+					const uint16_t *rgb[4] = { src0 + x * 4, src0 + x * 4 + 4, src1 + x * 4, src1 + x * 4 + 4 };
+					uint16_t
+						r = (uint16_t)((rgb[0][2] + rgb[1][2] + rgb[2][2] + rgb[3][2]) / 4),
+						g = (uint16_t)((rgb[0][1] + rgb[1][1] + rgb[2][1] + rgb[3][1]) / 4),
+						b = (uint16_t)((rgb[0][0] + rgb[1][0] + rgb[2][0] + rgb[3][0]) / 4);
+					dst0[x] = RgbToYuv<uint16_t>(matrix.m[0], rgb[0][2], rgb[0][1], rgb[0][0], low);
+					dst0[x + 1] = RgbToYuv<uint16_t>(matrix.m[0], rgb[1][2], rgb[1][1], rgb[1][0], low);
+					dst1[x] = RgbToYuv<uint16_t>(matrix.m[0], rgb[2][2], rgb[2][1], rgb[2][0], low);
+					dst1[x + 1] = RgbToYuv<uint16_t>(matrix.m[0], rgb[3][2], rgb[3][1], rgb[3][0], low);
+					chroma[x] = RgbToYuv<uint16_t>(matrix.m[1], r, g, b, mid);
+					chroma[x + 1] = RgbToYuv<uint16_t>(matrix.m[2], r, g, b, mid);
+				}
+			}
+		});
+	}
+
+	/************************************************************************/
+	/* Resize.cu                                                            */
+	/************************************************************************/
+
+	/**
+	* Ӳ˫ԲֵһϵĲλ
+	* 0.5ȡõߵ, Сְ8λΪұȨ, ΧǯλԵ
+	*/
+	struct SampleAxis {
+		std::vector<int> first;
+		std::vector<int> second;
+		std::vector<int> weight; // secondȨ, λΪ1/256
+	};
+
+	static void build_sample_axis(SampleAxis &axis, const std::vector<float> &coordinates, int size) {
+		axis.first.resize(coordinates.size());
+		axis.second.resize(coordinates.size());
+		axis.weight.resize(coordinates.size());
+		for (size_t k = 0; k < coordinates.size(); k++) {
+			float position = coordinates[k] - 0.5f;
+			float base = floorf(position);
+			int index = (int)base;
+			int weight = (int)((position - base) * 256.0f + 0.5f);
+			if (weight == 256) {
+				index++;
+				weight = 0;
+			}
+			axis.first[k] = Clamp(index, 0, size - 1);
+			axis.second[k] = Clamp(index + 1, 0, size - 1);
+			axis.weight[k] = weight;
+		}
+	}
+
+	// һƽ, ÿchannelsֽ, ˮƽĲλѾֽչ
+	struct ResampleTask {
+		const uint8_t *src;
+		int srcPitch;
+		int srcRowBytes;
+		uint8_t *dst;
+		int dstPitch;
+		int dstRowBytes;
+		SampleAxis columns; // ֽչ, ±ΪԴеֽλ
+		SampleAxis rows;
+		// Resizex * 256 / 255, Scalex
+		bool normalizeTo256;
+	};
+
+	// ˮƽֵĽΪԴֵ * 65536, ֵ
+	static inline int resample_output(int sum, bool normalizeTo256) {
+		if (!normalizeTo256) {
+			return sum >> 16;
+		}
+		// sum / 65280 = (sum >> 8) / 255, ǯλ255
+		int value = sum >> 8;
+		value = (value + 1 + (value >> 8)) >> 8;
+		return value > 255 ? 255 : value;
+	}
+
+	static void resample_row_scalar(const ResampleTask &task, const uint8_t *row0, const uint8_t *row1, int rowWeight,
+		uint16_t *blended, uint8_t *dest, int start) {
+		for (int k = start; k < task.srcRowBytes; k++) {
+			blended[k] = (uint16_t)((256 - rowWeight) * row0[k] + rowWeight * row1[k]);
+		}
+		for (int k = start; k < task.dstRowBytes; k++) {
+			int weight = task.columns.weight[k];
+			int sum = (256 - weight) * blended[task.columns.first[k]] + weight * blended[task.columns.second[k]];
+			dest[k] = (uint8_t)resample_output(sum, task.normalizeTo256);
+		}
+	}
+
+#ifdef CPU_KERNELS_X86
+	TARGET_AVX2 static void resample_row_avx2(const ResampleTask &task, const uint8_t *row0, const uint8_t *row1, int rowWeight,
+		uint16_t *blended, uint8_t *dest) {
+		// ڴֱ, 16λ
+		const __m256i weight0 = _mm256_set1_epi16((short)(256 - rowWeight));
+		const __m256i weight1 = _mm256_set1_epi16((short)rowWeight);
+		int k = 0;
+		for (; k + 16 <= task.srcRowBytes; k += 16) {
+			__m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(row0 + k)));
+			__m256i b = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(row1 + k)));
+			_mm256_storeu_si256((__m256i *)(blended + k), _mm256_add_epi16(_mm256_mullo_epi16(a, weight0), _mm256_mullo_epi16(b, weight1)));
+		}
+		for (; k < task.srcRowBytes; k++) {
+			blended[k] = (uint16_t)((256 - rowWeight) * row0[k] + rowWeight * row1[k]);
+		}
+
+		// ˮƽgatherȡ, blendedĩβ, 32λȡȡ16λ
+		const __m256i lowHalf = _mm256_set1_epi32(0xFFFF);
+		const __m256i full = _mm256_set1_epi32(256);
+		const __m256i maxValue = _mm256_set1_epi32(255);
+		for (k = 0; k + 8 <= task.dstRowBytes; k += 8) {
+			__m256i first = _mm256_loadu_si256((const __m256i *)&task.columns.first[k]);
+			__m256i second = _mm256_loadu_si256((const __m256i *)&task.columns.second[k]);
+			__m256i weight = _mm256_loadu_si256((const __m256i *)&task.columns.weight[k]);
+			__m256i a = _mm256_and_si256(_mm256_i32gather_epi32((const int *)blended, first, 2), lowHalf);
+			__m256i b = _mm256_and_si256(_mm256_i32gather_epi32((const int *)blended, second, 2), lowHalf);
+			__m256i sum = _mm256_add_epi32(_mm256_mullo_epi32(a, _mm256_sub_epi32(full, weight)), _mm256_mullo_epi32(b, weight));
+			__m256i value;
+			if (task.normalizeTo256) {
+				value = _mm256_srli_epi32(sum, 8);
+				value = _mm256_srli_epi32(_mm256_add_epi32(_mm256_add_epi32(value, _mm256_set1_epi32(1)), _mm256_srli_epi32(value, 8)), 8);
+				value = _mm256_min_epi32(value, maxValue);
+			} else {
+				value = _mm256_srli_epi32(sum, 16);
+			}
+			_mm_storel_epi64((__m128i *)(dest + k), pack_u8_avx2(value));
+		}
+		for (; k < task.dstRowBytes; k++) {
+			int weight = task.columns.weight[k];
+			int sum = (256 - weight) * blended[task.columns.first[k]] + weight * blended[task.columns.second[k]];
+			dest[k] = (uint8_t)resample_output(sum, task.normalizeTo256);
+		}
+	}
+#endif
+
+	static void resample_plane(const ResampleTask &task, int dstRows, ThreadPool *pool, YuvConverterKernel kernel) {
+		bool avx2 = use_avx2(kernel);
+		parallel_rows(pool, dstRows, [&](int first, int last) {
+			// Ԫ, gather32λȡһʱԽ
+			std::vector<uint16_t> blended(task.srcRowBytes + 2);
+			for (int y = first; y < last; y++) {
+				const uint8_t *row0 = task.src + (size_t)task.rows.first[y] * task.srcPitch;
+				const uint8_t *row1 = task.src + (size_t)task.rows.second[y] * task.srcPitch;
+				uint8_t *dest = task.dst + (size_t)y * task.dstPitch;
+#ifdef CPU_KERNELS_X86
+				if (avx2) {
+					resample_row_avx2(task, row0, row1, task.rows.weight[y], &blended[0], dest);
+					continue;
+				}
+#endif
+				resample_row_scalar(task, row0, row1, task.rows.weight[y], &blended[0], dest, 0);
+			}
+		});
+	}
+
+	// صĲչɰֽڵĲλ
+	static void build_column_axis(SampleAxis &axis, const std::vector<float> &coordinates, int srcWidth, int channels) {
+		SampleAxis pixels;
+		build_sample_axis(pixels, coordinates, srcWidth);
+		int count = (int)coordinates.size() * channels;
+		axis.first.resize(count);
+		axis.second.resize(count);
+		axis.weight.resize(count);
+		for (int k = 0; k < count; k++) {
+			int pixel = k / channels;
+			int channel = k % channels;
+			axis.first[k] = pixels.first[pixel] * channels + channel;
+			axis.second[k] = pixels.second[pixel] * channels + channel;
+			axis.weight[k] = pixels.weight[pixel];
+		}
+	}
+
+	void ResizeNv12(unsigned char *pDstNv12, int nDstPitch, int nDstWidth, int nDstHeight,
+		const unsigned char *pSrcNv12, int nSrcPitch, int nSrcWidth, int nSrcHeight, unsigned char *pDstNv12UV,
+		ThreadPool *pool, YuvConverterKernel kernel) {
+		unsigned char *pDstUV = pDstNv12UV ? pDstNv12UV : pDstNv12 + (nDstPitch * nDstHeight);
+		float fxScale = 1.0f * nDstWidth / nSrcWidth, fyScale = 1.0f * nDstHeight / nSrcHeight;
+		// CUDA汾һ2x2, Ϊʱһ/вд
+		int pairColumns = nDstWidth / 2, pairRows = nDstHeight / 2;
+
+		ResampleTask luma;
+		luma.src = pSrcNv12;
+		luma.srcPitch = nSrcPitch;
+		luma.srcRowBytes = nSrcWidth;
+		luma.dst = pDstNv12;
+		luma.dstPitch = nDstPitch;
+		luma.dstRowBytes = pairColumns * 2;
+		luma.normalizeTo256 = true;
+		std::vector<float> coordinates(pairColumns * 2);
+		for (int x = 0; x < pairColumns * 2; x++) {
+			coordinates[x] = x / fxScale;
+		}
+		build_column_axis(luma.columns, coordinates, nSrcWidth, 1);
+		coordinates.resize(pairRows * 2);
+		for (int y = 0; y < pairRows * 2; y++) {
+			coordinates[y] = y / fyScale;
+		}
+		build_sample_axis(luma.rows, coordinates, nSrcHeight);
+		resample_plane(luma, pairRows * 2, pool, kernel);
+
+		// CUDA汾һŸΪnSrcHeight * 3 / 2uchar2UV, ӻͷ
+		ResampleTask chroma;
+		chroma.src = pSrcNv12;
+		chroma.srcPitch = nSrcPitch;
+		chroma.srcRowBytes = nSrcWidth / 2 * 2;
+		chroma.dst = pDstUV;
+		chroma.dstPitch = nDstPitch;
+		chroma.dstRowBytes = pairColumns * 2;
+		chroma.normalizeTo256 = true;
+		coordinates.resize(pairColumns);
+		for (int x = 0; x < pairColumns; x++) {
+			coordinates[x] = x / fxScale;
+		}
+		build_column_axis(chroma.columns, coordinates, nSrcWidth / 2, 2);
+		coordinates.resize(pairRows);
+		for (int y = 0; y < pairRows; y++) {
+			coordinates[y] = (nDstHeight + y) / fyScale + 0.5f;
+		}
+		build_sample_axis(chroma.rows, coordinates, nSrcHeight * 3 / 2);
+		resample_plane(chroma, pairRows, pool, kernel);
+	}
+
+	// ScaleKernelLaunch: Ϊx * srcWidth / dstWidth, ûаصƫ
+	static void scale_plane(unsigned char *pDst, int nDstPitch, int nDstWidth, int nDstHeight,
+		const unsigned char *pSrc, int nSrcPitch, int nSrcWidth, int nSrcHeight, int channels,
+		ThreadPool *pool, YuvConverterKernel kernel) {
+		float fxScale = 1.0f * nSrcWidth / nDstWidth, fyScale = 1.0f * nSrcHeight / nDstHeight;
+		ResampleTask task;
+		task.src = pSrc;
+		task.srcPitch = nSrcPitch;
+		task.srcRowBytes = nSrcWidth * channels;
+		task.dst = pDst;
+		task.dstPitch = nDstPitch;
+		task.dstRowBytes = nDstWidth * channels;
+		task.normalizeTo256 = false;
+		std::vector<float> coordinates(nDstWidth);
+		for (int x = 0; x < nDstWidth; x++) {
+			coordinates[x] = x * fxScale;
+		}
+		build_column_axis(task.columns, coordinates, nSrcWidth, channels);
+		coordinates.resize(nDstHeight);
+		for (int y = 0; y < nDstHeight; y++) {
+			coordinates[y] = y * fyScale;
+		}
+		build_sample_axis(task.rows, coordinates, nSrcHeight);
+		resample_plane(task, nDstHeight, pool, kernel);
+	}
+
+	void ScaleYUV420(unsigned char *pDstY, unsigned char *pDstU, unsigned char *pDstV, int nDstPitch, int nDstChromaPitch,
+		int nDstWidth, int nDstHeight,
+		const unsigned char *pSrcY, const unsigned char *pSrcU, const unsigned char *pSrcV, int nSrcPitch, int nSrcChromaPitch,
+		int nSrcWidth, int nSrcHeight, bool bSemiplanar,
+		ThreadPool *pool, YuvConverterKernel kernel) {
+		int chromaWidthDst = (nDstWidth + 1) / 2;
+		int chromaHeightDst = (nDstHeight + 1) / 2;
+
+		int chromaWidthSrc = (nSrcWidth + 1) / 2;
+		int chromaHeightSrc = (nSrcHeight + 1) / 2;
+
+		scale_plane(pDstY, nDstPitch, nDstWidth, nDstHeight, pSrcY, nSrcPitch, nSrcWidth, nSrcHeight, 1, pool, kernel);
+
+		if (bSemiplanar) {
+			scale_plane(pDstU, nDstChromaPitch, chromaWidthDst, chromaHeightDst, pSrcU, nSrcChromaPitch, chromaWidthSrc, chromaHeightSrc, 2, pool, kernel);
+		} else {
+			scale_plane(pDstU, nDstChromaPitch, chromaWidthDst, chromaHeightDst, pSrcU, nSrcChromaPitch, chromaWidthSrc, chromaHeightSrc, 1, pool, kernel);
+			scale_plane(pDstV, nDstChromaPitch, chromaWidthDst, chromaHeightDst, pSrcV, nSrcChromaPitch, chromaWidthSrc, chromaHeightSrc, 1, pool, kernel);
+		}
+	}
+
+	/************************************************************************/
+	/* BitDepth.cu                                                          */
+	/************************************************************************/
+
+#ifdef CPU_KERNELS_X86
+	// Ѿ, ʣµɵ߰
+	TARGET_AVX2 static int convert_8_to_16_avx2(const uint8_t *src, uint16_t *dest, int width) {
+		int x = 0;
+		for (; x + 16 <= width; x += 16) {
+			__m256i value = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(src + x)));
+			_mm256_storeu_si256((__m256i *)(dest + x), _mm256_slli_epi16(value, 8));
+		}
+		return x;
+	}
+
+	TARGET_AVX2 static int convert_16_to_8_avx2(const uint16_t *src, uint8_t *dest, int width) {
+		int x = 0;
+		for (; x + 16 <= width; x += 16) {
+			__m256i high = _mm256_srli_epi16(_mm256_loadu_si256((const __m256i *)(src + x)), 8);
+			__m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(high, high), 0x08);
+			_mm_storeu_si128((__m128i *)(dest + x), _mm256_castsi256_si128(packed));
+		}
+		return x;
+	}
+#endif
+
+	void ConvertUInt8ToUInt16(const uint8_t *pUInt8, uint16_t *pUInt16, int nSrcPitch, int nDestPitch, int nWidth, int nHeight,
+		ThreadPool *pool, YuvConverterKernel kernel) {
+		bool avx2 = use_avx2(kernel);
+		int destStrideInPixels = nDestPitch / (sizeof(uint16_t));
+		parallel_rows(pool, nHeight, [&](int first, int last) {
+			for (int y = first; y < last; y++) {
+				const uint8_t *src = pUInt8 + (size_t)y * nSrcPitch;
+				uint16_t *dest = pUInt16 + (size_t)y * destStrideInPixels;
+				int x = 0;
+#ifdef CPU_KERNELS_X86
+				if (avx2) {
+					x = convert_8_to_16_avx2(src, dest, nWidth);
+				}
+#endif
+				for (; x < nWidth; x++) {
+					dest[x] = (uint16_t)(src[x] << 8);
+				}
+			}
+		});
+	}
+
+	void ConvertUInt16ToUInt8(const uint16_t *pUInt16, uint8_t *pUInt8, int nSrcPitch, int nDestPitch, int nWidth, int nHeight,
+		ThreadPool *pool, YuvConverterKernel kernel) {
+		bool avx2 = use_avx2(kernel);
+		int srcStrideInPixels = nSrcPitch / (sizeof(uint16_t));
+		parallel_rows(pool, nHeight, [&](int first, int last) {
+			for (int y = first; y < last; y++) {
+				const uint16_t *src = pUInt16 + (size_t)y * srcStrideInPixels;
+				uint8_t *dest = pUInt8 + (size_t)y * nDestPitch;
+				int x = 0;
+#ifdef CPU_KERNELS_X86
+				if (avx2) {
+					x = convert_16_to_8_avx2(src, dest, nWidth);
+				}
+#endif
+				for (; x < nWidth; x++) {
+					dest[x] = (uint8_t)(src[x] >> 8);
+				}
+			}
+		});
+	}
+
+	/************************************************************************/
+	/* ׼                                                              */
+	/************************************************************************/
+
+	// ׼õһ֡, kernel
+	struct BenchmarkFrame {
+		int width;
+		int height;
+		std::vector<uint8_t> nv12;
+		std::vector<uint8_t> p016;
+		std::vector<uint8_t> bgra64;
+		std::vector<uint8_t> output;
+	};
+
+	typedef void(*BenchmarkKernel)(BenchmarkFrame &frame, ThreadPool *pool, YuvConverterKernel kernel);
+
+	static void bench_nv12_to_rgba(BenchmarkFrame &f, ThreadPool *pool, YuvConverterKernel kernel) {
+		NV12TORGBA(&f.nv12[0], &f.nv12[0] + f.width * f.height, f.width, f.width, &f.output[0], f.width, f.height, 4, pool, kernel);
+	}
+
+	static void bench_nv12_to_bgra32(BenchmarkFrame &f, ThreadPool *pool, YuvConverterKernel kernel) {
+		Nv12ToBgra32(&f.nv12[0], f.width, &f.output[0], f.width * 4, f.width, f.height, ColorSpaceStandard_BT709, pool, kernel);
+	}
+
+	static void bench_yuv420p_to_rgba32(BenchmarkFrame &f, ThreadPool *pool, YuvConverterKernel kernel) {
+		// nv12YUV420P: Yƽ֮U, Vķ֮һСƽ
+		const uint8_t *pU = &f.nv12[0] + f.width * f.height;
+		Yuv420ToRgba32(&f.nv12[0], f.width, pU, pU + f.width / 2 * f.height / 2, f.width / 2, &f.output[0], f.width * 4,
+			f.width, f.height, ColorSpaceStandard_BT601, false, true, pool, kernel);
+	}
+
+	static void bench_nv12_to_bgr_planar(BenchmarkFrame &f, ThreadPool *pool, YuvConverterKernel kernel) {
+		Nv12ToBgrPlanar(&f.nv12[0], f.width, &f.output[0], f.width, f.width, f.height, ColorSpaceStandard_BT601, pool, kernel);
+	}
+
+	static void bench_p016_to_bgra64(BenchmarkFrame &f, ThreadPool *pool, YuvConverterKernel kernel) {
+		P016ToBgra64(&f.p016[0], f.width * 2, &f.output[0], f.width * 8, f.width, f.height, ColorSpaceStandard_BT709, pool, kernel);
+	}
+
+	static void bench_bgra64_to_p016(BenchmarkFrame &f, ThreadPool *pool, YuvConverterKernel kernel) {
+		Bgra64ToP016(&f.bgra64[0], f.width * 8, &f.output[0], f.width * 2, f.width, f.height, ColorSpaceStandard_BT709, pool, kernel);
+	}
+
+	static void bench_resize_nv12(BenchmarkFrame &f, ThreadPool *pool, YuvConverterKernel kernel) {
+		// 4KС1080p, תڵԤ÷һ
+		ResizeNv12(&f.output[0], f.width / 2, f.width / 2, f.height / 2, &f.nv12[0], f.width, f.width, f.height, NULL, pool, kernel);
+	}
+
+	static void bench_scale_nv12(BenchmarkFrame &f, ThreadPool *pool, YuvConverterKernel kernel) {
+		int dstWidth = f.width * 2 / 3, dstHeight = f.height * 2 / 3;
+		uint8_t *dstUV = &f.output[0] + dstWidth * dstHeight;
+		const uint8_t *srcUV = &f.nv12[0] + f.width * f.height;
+		ScaleYUV420(&f.output[0], dstUV, NULL, dstWidth, dstWidth + dstWidth % 2, dstWidth, dstHeight,
+			&f.nv12[0], srcUV, NULL, f.width, f.width, f.width, f.height, true, pool, kernel);
+	}
+
+	static void bench_8_to_16(BenchmarkFrame &f, ThreadPool *pool, YuvConverterKernel kernel) {
+		ConvertUInt8ToUInt16(&f.nv12[0], (uint16_t *)&f.output[0], f.width, f.width * 2, f.width, f.height * 3 / 2, pool, kernel);
+	}
+
+	static void bench_16_to_8(BenchmarkFrame &f, ThreadPool *pool, YuvConverterKernel kernel) {
+		ConvertUInt16ToUInt8((const uint16_t *)&f.p016[0], &f.output[0], f.width * 2, f.width, f.width, f.height * 3 / 2, pool, kernel);
+	}
+
+	// һʵִһ֡ƽʱ()
+	static double measure_kernel(BenchmarkKernel run, BenchmarkFrame &frame, ThreadPool *pool, YuvConverterKernel kernel, int iterations) {
+		TimeMeasurer timeMeasurer;
+		timeMeasurer.Start();
+		for (int i = 0; i < iterations; i++) {
+			run(frame, pool, kernel);
+		}
+		return timeMeasurer.elapsedMicroSecondsSinceStart() / 1000.0 / iterations;
+	}
+
+	/**
+	* GPUNV12TORGBA.cu, CPUʵֽڱȽ, CUDAdoubleҴFMA, 1
+	*/
+	static void cross_check_with_cuda(BenchmarkFrame &frame) {
+		if (!cudaDeviceAvailable()) {
+			std::cout << "No CUDA device, skipping the cross-check against NV12TORGBA.cu" << std::endl;
+			return;
+		}
+		size_t yuvBytes = (size_t)frame.width * frame.height * 3 / 2;
+		size_t rgbaBytes = (size_t)frame.width * frame.height * 4;
+		unsigned char *deviceYUV = NULL;
+		unsigned char *deviceRGBA = NULL;
+		if (cudaMalloc((void **)&deviceYUV, yuvBytes) != cudaSuccess || cudaMalloc((void **)&deviceRGBA, rgbaBytes) != cudaSuccess) {
+			std::cout << "cudaMalloc failed, skipping the cross-check against NV12TORGBA.cu" << std::endl;
+			cudaFree(deviceYUV);
+			return;
+		}
+		cudaMemcpy(deviceYUV, &frame.nv12[0], yuvBytes, cudaMemcpyHostToDevice);
+		::NV12TORGBA(deviceYUV, deviceYUV + frame.width * frame.height, frame.width, frame.width, deviceRGBA, frame.width, frame.height, 4);
+		cudaDeviceSynchronize();
+		std::vector<uint8_t> gpu(rgbaBytes);
+		cudaMemcpy(&gpu[0], deviceRGBA, rgbaBytes, cudaMemcpyDeviceToHost);
+		cudaFree(deviceYUV);
+		cudaFree(deviceRGBA);
+
+		NV12TORGBA(&frame.nv12[0], &frame.nv12[0] + frame.width * frame.height, frame.width, frame.width, &frame.output[0],
+			frame.width, frame.height, 4);
+		int maxDifference = 0;
+		size_t differentBytes = 0;
+		for (size_t i = 0; i < rgbaBytes; i++) {
+			int difference = abs((int)gpu[i] - (int)frame.output[i]);
+			if (difference > 0) {
+				differentBytes++;
+			}
+			if (difference > maxDifference) {
+				maxDifference = difference;
+			}
+		}
+		std::cout << "NV12TORGBA CPU vs CUDA: " << differentBytes << " bytes differ, max difference " << maxDifference
+			<< (maxDifference > 1 ? " (MISMATCH)" : "") << std::endl;
+	}
+
+	void benchmark(ThreadPool *pool) {
+		static const struct {
+			const char *name;
+			BenchmarkKernel run;
+			size_t outputBytesPerPixel; // һ, 8С
+		} KERNELS[] = {
+			{ "NV12TORGBA", bench_nv12_to_rgba, 32 },
+			{ "Nv12ToBgra32", bench_nv12_to_bgra32, 32 },
+			{ "Yuv420ToRgba32 YUV420P", bench_yuv420p_to_rgba32, 32 },
+			{ "Nv12ToBgrPlanar", bench_nv12_to_bgr_planar, 24 },
+			{ "P016ToBgra64", bench_p016_to_bgra64, 64 },
+			{ "Bgra64ToP016", bench_bgra64_to_p016, 24 },
+			{ "ResizeNv12 (1/2)", bench_resize_nv12, 3 },
+			{ "ScaleYUV420 NV12 (2/3)", bench_scale_nv12, 6 },
+			{ "ConvertUInt8ToUInt16", bench_8_to_16, 24 },
+			{ "ConvertUInt16ToUInt8", bench_16_to_8, 12 },
+		};
+		static const int ITERATIONS = 5;
+
+		BenchmarkFrame frame;
+		frame.width = 3840;
+		frame.height = 2160;
+		size_t pixels = (size_t)frame.width * frame.height;
+		// αĻ, ǯλ
+		frame.nv12.resize(pixels * 3 / 2);
+		unsigned int seed = 12345;
+		for (size_t i = 0; i < frame.nv12.size(); i++) {
+			seed = seed * 1103515245 + 12345;
+			frame.nv12[i] = (uint8_t)(seed >> 16);
+		}
+		frame.p016.resize(pixels * 3);
+		ConvertUInt8ToUInt16(&frame.nv12[0], (uint16_t *)&frame.p016[0], frame.width, frame.width * 2, frame.width, frame.height * 3 / 2, pool);
+		frame.bgra64.resize(pixels * 8);
+		P016ToBgra64(&frame.p016[0], frame.width * 2, &frame.bgra64[0], frame.width * 8, frame.width, frame.height, ColorSpaceStandard_BT709, pool);
+
+		std::cout << "CPU kernels benchmark, " << frame.width << "x" << frame.height << ", " << ITERATIONS << " iterations, "
+			<< (pool != NULL ? pool->size() : 1) << " threads" << std::endl;
+		for (size_t k = 0; k < sizeof(KERNELS) / sizeof(KERNELS[0]); k++) {
+			size_t outputBytes = pixels * KERNELS[k].outputBytesPerPixel / 8;
+			frame.output.assign(pixels * 8, 0);
+			double scalar = measure_kernel(KERNELS[k].run, frame, NULL, YCK_SCALAR, ITERATIONS);
+			std::vector<uint8_t> reference(frame.output.begin(), frame.output.begin() + outputBytes);
+			std::cout << KERNELS[k].name << ": scalar " << scalar << " ms";
+
+			if (yuv_converter_kernel_supported(YCK_AVX2)) {
+				frame.output.assign(pixels * 8, 0);
+				double single = measure_kernel(KERNELS[k].run, frame, NULL, YCK_AVX2, ITERATIONS);
+				bool same = memcmp(&frame.output[0], &reference[0], outputBytes) == 0;
+				std::cout << ", AVX2 " << single << " ms (" << scalar / single << "x)" << (same ? "" : " MISMATCH");
+			}
+			if (pool != NULL) {
+				frame.output.assign(pixels * 8, 0);
+				double parallel = measure_kernel(KERNELS[k].run, frame, pool, YCK_AUTO, ITERATIONS);
+				bool same = memcmp(&frame.output[0], &reference[0], outputBytes) == 0;
+				std::cout << ", " << pool->size() << " threads " << parallel << " ms (" << scalar / parallel << "x)" << (same ? "" : " MISMATCH");
+			}
+			std::cout << std::endl;
+		}
+
+		frame.output.assign(pixels * 8, 0);
+		cross_check_with_cuda(frame);
+	}
+}
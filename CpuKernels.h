@@ -0,0 +1,87 @@
+#pragma once
+#include <stdint.h>
+#include "ThreadPool.h"
+#include "yuvConverter.h"
+
+/**
+* NV12TORGBA.cuThirdParty/UtilsColorSpace.cu, Resize.cu, BitDepth.cuCUDA kernelCPUʵ
+* ӿCUDA汾һһӦ, ָָֻڴ, ָ̳߳
+* ûCUDA豸ָ-kernels 2ʱ, RGBģʽYUV420P, NV12P010֡Yuv420ToRgba32/P016ToRgba32ת(Player::convertToRGB)
+* poolΪNULLʱ̳߳ϲ, kernelΪYCK_AVX2YCK_AUTOCPU֧ʱʹAVX2, ʹñʵ, ֽ߽ͬ
+* ֻNV12TORGBAbenchmarkGPUĽȽϹ, 1; Utilsµ.cuûб, kernelԴֲ, ûGPUԱȹ
+* 16λɫת(Nv12ToBgra64, P016ToBgra32/64, P016ToBgrPlanar, Bgra64ToP016)ֻñʵ,
+* ֻ10λ, ̳߳ز; AVX2ʵָNV12TORGBA, 8λNv12ToBgra32/Nv12ToBgrPlanar/Yuv420ToRgba32, źλת
+*/
+namespace CpuKernels {
+
+	// ColorSpace.cuͬ
+	typedef enum ColorSpaceStandard {
+		ColorSpaceStandard_BT709 = 0,
+		ColorSpaceStandard_BT601 = 2,
+		ColorSpaceStandard_BT2020 = 4
+	} ColorSpaceStandard;
+
+	// ЩתCUDACPU
+	enum KernelDevice {
+		KD_AUTO = 0, // CUDA豸ʱʹCUDA, ʹCPU
+		KD_CUDA,
+		KD_CPU
+	};
+
+	bool cudaDeviceAvailable();
+	// KD_AUTOKD_CUDAKD_CPU, ҪKD_CUDAûCUDA豸ʱҲKD_CPU
+	KernelDevice resolveKernelDevice(KernelDevice requested);
+
+	// NV12TORGBA.cu: BT.601ȫΧʽתRGBA, CUDA汾һǰÿ4ֽ, channels
+	void NV12TORGBA(const unsigned char *pYdata, const unsigned char *pUVdata, int stepY, int stepUV,
+		unsigned char *pImgData, int width, int height, int channels,
+		ThreadPool *pool = NULL, YuvConverterKernel kernel = YCK_AUTO);
+
+	// ColorSpace.cu: NV12/P016ΪYƽ֮UVƽ, ƽпͬ
+	// pChromaΪNULLʱUVƽpChromaʼ(AVFramedata[1]), пYƽͬ
+	// CUDA汾ͬ, Ϊʱһ/Ҳת, packedalphaΪֵ0
+	void Nv12ToBgra32(const uint8_t *pNv12, int nNv12Pitch, uint8_t *pBgra, int nBgraPitch, int nWidth, int nHeight, int iMatrix,
+		ThreadPool *pool = NULL, YuvConverterKernel kernel = YCK_AUTO, const uint8_t *pChroma = NULL);
+	void Nv12ToBgra64(const uint8_t *pNv12, int nNv12Pitch, uint8_t *pBgra, int nBgraPitch, int nWidth, int nHeight, int iMatrix,
+		ThreadPool *pool = NULL, YuvConverterKernel kernel = YCK_AUTO, const uint8_t *pChroma = NULL);
+	void P016ToBgra32(const uint8_t *pP016, int nP016Pitch, uint8_t *pBgra, int nBgraPitch, int nWidth, int nHeight, int iMatrix,
+		ThreadPool *pool = NULL, YuvConverterKernel kernel = YCK_AUTO, const uint8_t *pChroma = NULL);
+	void P016ToBgra64(const uint8_t *pP016, int nP016Pitch, uint8_t *pBgra, int nBgraPitch, int nWidth, int nHeight, int iMatrix,
+		ThreadPool *pool = NULL, YuvConverterKernel kernel = YCK_AUTO, const uint8_t *pChroma = NULL);
+	// B, G, Rƽ, nBgrpPitch * nHeightֽ
+	void Nv12ToBgrPlanar(const uint8_t *pNv12, int nNv12Pitch, uint8_t *pBgrp, int nBgrpPitch, int nWidth, int nHeight, int iMatrix,
+		ThreadPool *pool = NULL, YuvConverterKernel kernel = YCK_AUTO, const uint8_t *pChroma = NULL);
+	void P016ToBgrPlanar(const uint8_t *pP016, int nP016Pitch, uint8_t *pBgrp, int nBgrpPitch, int nWidth, int nHeight, int iMatrix,
+		ThreadPool *pool = NULL, YuvConverterKernel kernel = YCK_AUTO, const uint8_t *pChroma = NULL);
+	void Bgra64ToP016(const uint8_t *pBgra, int nBgraPitch, uint8_t *pP016, int nP016Pitch, int nWidth, int nHeight, int iMatrix,
+		ThreadPool *pool = NULL, YuvConverterKernel kernel = YCK_AUTO);
+
+	// RGBģʽõת, ColorSpace.cuֲü, ѡȫΧ(bFullRange)RGBA(bRgba)
+	// pVΪNULLʱpUΪUVƽ(NV12), pU, pVΪU, Vƽ(YUV420P); ɫƽпΪnChromaPitch
+	void Yuv420ToRgba32(const uint8_t *pY, int nYPitch, const uint8_t *pU, const uint8_t *pV, int nChromaPitch,
+		uint8_t *pRgba, int nRgbaPitch, int nWidth, int nHeight, int iMatrix, bool bFullRange, bool bRgba,
+		ThreadPool *pool = NULL, YuvConverterKernel kernel = YCK_AUTO);
+	// ͬ, ΪP016(P01010λڸλ, ֱӵP016), UV
+	void P016ToRgba32(const uint8_t *pY, int nYPitch, const uint8_t *pUV, int nChromaPitch,
+		uint8_t *pRgba, int nRgbaPitch, int nWidth, int nHeight, int iMatrix, bool bFullRange, bool bRgba,
+		ThreadPool *pool = NULL, YuvConverterKernel kernel = YCK_AUTO);
+
+	// Resize.cu: Ӳ˫Բֵ(ȨΪ8λС, Եǯλ)NV12, pDstNv12UVΪNULLʱUVƽYƽ֮
+	void ResizeNv12(unsigned char *pDstNv12, int nDstPitch, int nDstWidth, int nDstHeight,
+		const unsigned char *pSrcNv12, int nSrcPitch, int nSrcWidth, int nSrcHeight, unsigned char *pDstNv12UV = NULL,
+		ThreadPool *pool = NULL, YuvConverterKernel kernel = YCK_AUTO);
+	void ScaleYUV420(unsigned char *pDstY, unsigned char *pDstU, unsigned char *pDstV, int nDstPitch, int nDstChromaPitch,
+		int nDstWidth, int nDstHeight,
+		const unsigned char *pSrcY, const unsigned char *pSrcU, const unsigned char *pSrcV, int nSrcPitch, int nSrcChromaPitch,
+		int nSrcWidth, int nSrcHeight, bool bSemiplanar,
+		ThreadPool *pool = NULL, YuvConverterKernel kernel = YCK_AUTO);
+
+	// BitDepth.cu: 8λֵ16λĸֽ, Լȡֽ
+	void ConvertUInt8ToUInt16(const uint8_t *pUInt8, uint16_t *pUInt16, int nSrcPitch, int nDestPitch, int nWidth, int nHeight,
+		ThreadPool *pool = NULL, YuvConverterKernel kernel = YCK_AUTO);
+	void ConvertUInt16ToUInt8(const uint16_t *pUInt16, uint8_t *pUInt8, int nSrcPitch, int nDestPitch, int nWidth, int nHeight,
+		ThreadPool *pool = NULL, YuvConverterKernel kernel = YCK_AUTO);
+
+	// 4K±Ƚϸkernel, AVX2̵߳߳ĺʱһ, CUDA豸ʱNV12TORGBAGPUԱ
+	void benchmark(ThreadPool *pool);
+}
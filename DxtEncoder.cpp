@@ -0,0 +1,330 @@
+#include "DxtEncoder.h"
+#include <iostream>
+#include <string.h>
+#include <math.h>
+#include "stb_dxt.h"
+
+// stb_dxtHIGHQUALģʽ, rygCompressʹõģʽͬ
+static const int DXT_COMPRESS_MODE_HIGH = 10;
+static const int DXT_COMPRESS_MODE_FAST = STB_DXT_FAST;
+// ÿ߳ƽֵ, мÿ̸ͬ߳ظ
+static const int BANDS_PER_THREAD = 4;
+
+static inline uint8_t clampToByte(int value) {
+    return (uint8_t)(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+DxtEncoder::DxtEncoder(ThreadPool *pool) :
+    pool(pool),
+    width(0),
+    height(0),
+    format(DXT_FORMAT_DXT1),
+    quality(DXT_QUALITY_HIGH),
+    compressMode(DXT_COMPRESS_MODE_HIGH),
+    blockRows(0),
+    bandCount(0),
+    frameCount(0),
+    totalMicroSeconds(0),
+    rgba(NULL),
+    planes(NULL),
+    linesizes(NULL),
+    chromaLayout(YCL_PLANAR),
+    blocks(NULL) {
+}
+
+bool DxtEncoder::init(int width, int height, DxtFormat format, DxtQuality quality) {
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+    this->width = width;
+    this->height = height;
+    this->format = format;
+    this->quality = quality;
+    compressMode = quality == DXT_QUALITY_FAST ? DXT_COMPRESS_MODE_FAST : DXT_COMPRESS_MODE_HIGH;
+    blockRows = (height + 3) / 4;
+    bandCount = pool->size() * BANDS_PER_THREAD;
+    if (bandCount > blockRows) {
+        bandCount = blockRows;
+    }
+    blockRowBuffers.resize((size_t)bandCount * width * 4 * 4);
+
+    // stb_compress_dxt_blockһεʱʼȫֲұ, һ̰߳ȫ, ڵǰ߳
+    uint8_t block[64] = { 0 };
+    uint8_t compressed[16];
+    stb_compress_dxt_block(compressed, block, 1, compressMode);
+    return true;
+}
+
+void DxtEncoder::encode(const uint8_t *rgba, uint8_t *blocks) {
+    this->rgba = rgba;
+    encodeFrame(blocks);
+    this->rgba = NULL;
+}
+
+void DxtEncoder::encodeYUV420(const uint8_t * const *planes, const int *linesizes, YuvChromaLayout chromaLayout, uint8_t *blocks) {
+    this->planes = planes;
+    this->linesizes = linesizes;
+    this->chromaLayout = chromaLayout;
+    encodeFrame(blocks);
+    this->planes = NULL;
+    this->linesizes = NULL;
+}
+
+void DxtEncoder::encodeFrame(uint8_t *blocks) {
+    TimeMeasurer timeMeasurer;
+    timeMeasurer.Start();
+
+    this->blocks = blocks;
+    pool->parallelFor(bandCount, encodeBand, this);
+    this->blocks = NULL;
+
+    totalMicroSeconds += timeMeasurer.elapsedMicroSecondsSinceStart();
+    frameCount++;
+}
+
+void DxtEncoder::encodeBand(void *context, int bandIndex) {
+    DxtEncoder *encoder = (DxtEncoder *)context;
+    int width = encoder->width;
+    int height = encoder->height;
+    int blockRowBytes = (width + 3) / 4 * dxtBlockBytes(encoder->format);
+    int firstBlockRow = encoder->blockRows * bandIndex / encoder->bandCount;
+    int lastBlockRow = encoder->blockRows * (bandIndex + 1) / encoder->bandCount;
+    uint8_t *blockRowBuffer = &encoder->blockRowBuffers[(size_t)bandIndex * width * 4 * 4];
+
+    for (int blockRow = firstBlockRow; blockRow < lastBlockRow; blockRow++) {
+        int firstRow = blockRow * 4;
+        // һеĸ߶ȿܲ4
+        int rows = height - firstRow < 4 ? height - firstRow : 4;
+        const uint8_t *source;
+        if (encoder->rgba != NULL) {
+            source = encoder->rgba + (size_t)firstRow * width * 4;
+        } else {
+            // firstRowż, ɫȴӵfirstRow / 2пʼ
+            const uint8_t *rowPlanes[3];
+            rowPlanes[0] = encoder->planes[0] + (size_t)firstRow * encoder->linesizes[0];
+            rowPlanes[1] = encoder->planes[1] + (size_t)firstRow / 2 * encoder->linesizes[1];
+            rowPlanes[2] = encoder->chromaLayout == YCL_PLANAR ? encoder->planes[2] + (size_t)firstRow / 2 * encoder->linesizes[2] : NULL;
+            yuv420_to_rgb(rowPlanes, encoder->linesizes, encoder->chromaLayout, blockRowBuffer, width * 4, RPL_RGBA, width, rows);
+            source = blockRowBuffer;
+        }
+        encoder->encodeBlockRow(source, rows, encoder->blocks + (size_t)blockRow * blockRowBytes);
+    }
+}
+
+void DxtEncoder::encodeBlockRow(const uint8_t *source, int rows, uint8_t *dest) {
+    if (format == DXT_FORMAT_DXT1) {
+        // бһſΪwidth, ΪrowsСͼ, ֱӽrygCompress
+        rygCompressMode(dest, source, width, rows, 0, compressMode);
+        return;
+    }
+
+    int blockBytes = dxtBlockBytes(format);
+    int blockColumns = (width + 3) / 4;
+    uint8_t rgbaBlock[64];
+    uint8_t ycocgBlock[64];
+    for (int blockColumn = 0; blockColumn < blockColumns; blockColumn++) {
+        // ͼظһ/
+        for (int y = 0; y < 4; y++) {
+            int row = y < rows ? y : rows - 1;
+            for (int x = 0; x < 4; x++) {
+                int column = blockColumn * 4 + x;
+                if (column >= width) {
+                    column = width - 1;
+                }
+                memcpy(rgbaBlock + (y * 4 + x) * 4, source + ((size_t)row * width + column) * 4, 4);
+            }
+        }
+        convertBlockToYCoCg(rgbaBlock, ycocgBlock);
+        stb_compress_dxt_block(dest, ycocgBlock, 1, compressMode);
+        dest += blockBytes;
+    }
+}
+
+void DxtEncoder::convertBlockToYCoCg(const uint8_t *rgbaBlock, uint8_t *ycocgBlock) {
+    // 1/4ΪλCo = (R - B) / 2, Cg = (2G - R - B) / 4, ⸡
+    int co[16];
+    int cg[16];
+    int maxChroma = 0;
+    for (int i = 0; i < 16; i++) {
+        int r = rgbaBlock[i * 4 + 0];
+        int g = rgbaBlock[i * 4 + 1];
+        int b = rgbaBlock[i * 4 + 2];
+        co[i] = (r - b) * 2;
+        cg[i] = 2 * g - r - b;
+        int absCo = co[i] < 0 ? -co[i] : co[i];
+        int absCg = cg[i] < 0 ? -cg[i] : cg[i];
+        if (absCo > maxChroma) {
+            maxChroma = absCo;
+        }
+        if (absCg > maxChroma) {
+            maxChroma = absCg;
+        }
+        ycocgBlock[i * 4 + 3] = clampToByte((r + 2 * g + b + 2) >> 2);
+    }
+
+    // ɫȷСĿCo/CgŴ, ŴBͨ, ɫBԭ: scale = B * 255 / 8 + 1
+    int scale = maxChroma < 32 * 4 ? 4 : (maxChroma < 64 * 4 ? 2 : 1);
+    uint8_t scaleValue = (uint8_t)((scale - 1) << 3);
+    for (int i = 0; i < 16; i++) {
+        ycocgBlock[i * 4 + 0] = clampToByte(128 + ((co[i] * scale + 2) >> 2));
+        ycocgBlock[i * 4 + 1] = clampToByte(128 + ((cg[i] * scale + 2) >> 2));
+        ycocgBlock[i * 4 + 2] = scaleValue;
+    }
+}
+
+void DxtEncoder::printStatistics() {
+    std::cout << "DXT encoder: " << (format == DXT_FORMAT_DXT1 ? "DXT1" : "YCoCg-DXT5") << ", "
+        << (quality == DXT_QUALITY_FAST ? "fast" : "high quality") << ", " << bandCount << " bands, "
+        << frameCount << " frames, average " << (frameCount > 0 ? totalMicroSeconds / 1000.0 / frameCount : 0.0) << " ms per frame" << std::endl;
+}
+
+// DXT1/DXT5Ĺһɫ, 16RGB(ÿ4ֽ, 4ֽڲʹ)
+static void decodeColorBlock(const uint8_t *block, uint8_t *rgba) {
+    int c0 = block[0] | (block[1] << 8);
+    int c1 = block[2] | (block[3] << 8);
+    int palette[4][3];
+    int colors[2] = { c0, c1 };
+    for (int i = 0; i < 2; i++) {
+        int r = (colors[i] >> 11) & 31;
+        int g = (colors[i] >> 5) & 63;
+        int b = colors[i] & 31;
+        palette[i][0] = (r << 3) | (r >> 2);
+        palette[i][1] = (g << 2) | (g >> 4);
+        palette[i][2] = (b << 3) | (b >> 2);
+    }
+    for (int ch = 0; ch < 3; ch++) {
+        if (c0 > c1) {
+            palette[2][ch] = (2 * palette[0][ch] + palette[1][ch]) / 3;
+            palette[3][ch] = (palette[0][ch] + 2 * palette[1][ch]) / 3;
+        } else {
+            palette[2][ch] = (palette[0][ch] + palette[1][ch]) / 2;
+            palette[3][ch] = 0;
+        }
+    }
+    unsigned int indices = block[4] | (block[5] << 8) | (block[6] << 16) | ((unsigned int)block[7] << 24);
+    for (int i = 0; i < 16; i++) {
+        const int *color = palette[(indices >> (i * 2)) & 3];
+        rgba[i * 4 + 0] = (uint8_t)color[0];
+        rgba[i * 4 + 1] = (uint8_t)color[1];
+        rgba[i * 4 + 2] = (uint8_t)color[2];
+    }
+}
+
+// DXT5alpha, дصĵ4ֽ
+static void decodeAlphaBlock(const uint8_t *block, uint8_t *rgba) {
+    int palette[8];
+    palette[0] = block[0];
+    palette[1] = block[1];
+    if (palette[0] > palette[1]) {
+        for (int i = 1; i < 7; i++) {
+            palette[i + 1] = ((7 - i) * palette[0] + i * palette[1]) / 7;
+        }
+    } else {
+        for (int i = 1; i < 5; i++) {
+            palette[i + 1] = ((5 - i) * palette[0] + i * palette[1]) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+    unsigned long long indices = 0;
+    for (int i = 0; i < 6; i++) {
+        indices |= (unsigned long long)block[2 + i] << (i * 8);
+    }
+    for (int i = 0; i < 16; i++) {
+        rgba[i * 4 + 3] = (uint8_t)palette[(indices >> (i * 3)) & 7];
+    }
+}
+
+// ѽYCoCgתRGB, 벥ƬԪɫYCoCg-DXT5sampleSceneͬ
+static void ycocgToRGB(uint8_t *rgba) {
+    double scale = rgba[2] / 8.0 + 1.0;
+    double co = (rgba[0] - 128.0) / scale;
+    double cg = (rgba[1] - 128.0) / scale;
+    double y = rgba[3];
+    double rgb[3] = { y + co - cg, y + cg, y - co - cg };
+    for (int ch = 0; ch < 3; ch++) {
+        rgba[ch] = clampToByte((int)floor(rgb[ch] + 0.5));
+    }
+}
+
+// ֡DXTԭʼRGBAȽRGBͨ, PSNR(dB)
+static double dxtPSNR(const uint8_t *blocks, const uint8_t *rgba, int width, int height, DxtFormat format) {
+    int blockBytes = dxtBlockBytes(format);
+    int blockColumns = (width + 3) / 4;
+    double squaredError = 0;
+    uint8_t decoded[64];
+    for (int blockRow = 0; blockRow < (height + 3) / 4; blockRow++) {
+        for (int blockColumn = 0; blockColumn < blockColumns; blockColumn++) {
+            const uint8_t *block = blocks + ((size_t)blockRow * blockColumns + blockColumn) * blockBytes;
+            if (format == DXT_FORMAT_DXT1) {
+                decodeColorBlock(block, decoded);
+            } else {
+                decodeAlphaBlock(block, decoded);
+                decodeColorBlock(block + 8, decoded);
+                for (int i = 0; i < 16; i++) {
+                    ycocgToRGB(decoded + i * 4);
+                }
+            }
+            for (int y = 0; y < 4 && blockRow * 4 + y < height; y++) {
+                for (int x = 0; x < 4 && blockColumn * 4 + x < width; x++) {
+                    const uint8_t *original = rgba + ((size_t)(blockRow * 4 + y) * width + blockColumn * 4 + x) * 4;
+                    for (int ch = 0; ch < 3; ch++) {
+                        double difference = (double)decoded[(y * 4 + x) * 4 + ch] - original[ch];
+                        squaredError += difference * difference;
+                    }
+                }
+            }
+        }
+    }
+    double meanSquaredError = squaredError / ((double)width * height * 3);
+    return meanSquaredError > 0 ? 10.0 * log10(255.0 * 255.0 / meanSquaredError) : 99.0;
+}
+
+void DxtEncoder::benchmark(ThreadPool *pool) {
+    const int width = 3840;
+    const int height = 2160;
+    const int iterations = 5;
+
+    // ϳһ֡YUV420P: ƽϵƺ, ƽ̹ͱԵ
+    std::vector<uint8_t> y((size_t)width * height);
+    std::vector<uint8_t> u((size_t)width / 2 * height / 2);
+    std::vector<uint8_t> v((size_t)width / 2 * height / 2);
+    unsigned int seed = 1;
+    for (int row = 0; row < height; row++) {
+        for (int column = 0; column < width; column++) {
+            seed = seed * 1103515245 + 12345;
+            int stripe = ((column / 24 + row / 24) & 1) * 40;
+            y[(size_t)row * width + column] = clampToByte(32 + column * 160 / width + stripe + (int)((seed >> 16) & 15));
+        }
+    }
+    for (int row = 0; row < height / 2; row++) {
+        for (int column = 0; column < width / 2; column++) {
+            u[(size_t)row * width / 2 + column] = clampToByte(64 + row * 128 / (height / 2));
+            v[(size_t)row * width / 2 + column] = clampToByte(192 - column * 128 / (width / 2));
+        }
+    }
+    const uint8_t *planes[3] = { &y[0], &u[0], &v[0] };
+    int linesizes[3] = { width, width / 2, width / 2 };
+    std::vector<uint8_t> rgba((size_t)width * height * 4);
+    yuv420_to_rgb(planes, linesizes, YCL_PLANAR, &rgba[0], width * 4, RPL_RGBA, width, height, pool);
+
+    std::cout << "DXT encoder benchmark, " << width << "x" << height << ", " << iterations << " iterations, " << pool->size() << " threads" << std::endl;
+    DxtFormat formats[2] = { DXT_FORMAT_DXT1, DXT_FORMAT_YCOCG_DXT5 };
+    DxtQuality qualities[2] = { DXT_QUALITY_HIGH, DXT_QUALITY_FAST };
+    for (int f = 0; f < 2; f++) {
+        for (int q = 0; q < 2; q++) {
+            DxtEncoder encoder(pool);
+            encoder.init(width, height, formats[f], qualities[q]);
+            std::vector<uint8_t> blocks(encoder.frameBytes());
+            TimeMeasurer timeMeasurer;
+            timeMeasurer.Start();
+            for (int i = 0; i < iterations; i++) {
+                encoder.encodeYUV420(planes, linesizes, YCL_PLANAR, &blocks[0]);
+            }
+            double milliSeconds = timeMeasurer.elapsedMicroSecondsSinceStart() / 1000.0 / iterations;
+            std::cout << (formats[f] == DXT_FORMAT_DXT1 ? "DXT1" : "YCoCg-DXT5") << " " << (qualities[q] == DXT_QUALITY_FAST ? "fast" : "high")
+                << ": " << milliSeconds << " ms per frame (" << (milliSeconds > 0 ? 1000.0 / milliSeconds : 0.0) << " fps), PSNR "
+                << dxtPSNR(&blocks[0], &rgba[0], width, height, formats[f]) << " dB" << std::endl;
+        }
+    }
+}
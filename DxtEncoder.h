@@ -0,0 +1,70 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include "ThreadPool.h"
+#include "TimeMeasurer.h"
+#include "DxtVideoFile.h"
+#include "yuvConverter.h"
+
+// ѹλ
+enum DxtQuality {
+    DXT_QUALITY_HIGH = 0, // ɷַ˵㲢Ż, rygCompressͬ
+    DXT_QUALITY_FAST // ȡɫΧеĶԽΪ˵, Ż, ٶԼΪHIGH3~4
+};
+
+/**
+* RGBAYUV420P/NV12֡ѹDXT1YCoCg-DXT5Ŀ
+* һ֡г, ̳߳ϲѹ, Ŀ껺лص
+* YUV벻֡RGBAм仺: ÿֻ4Ⱥ2ɫתԼRGBAл, תѹ
+*/
+class DxtEncoder {
+public:
+    DxtEncoder(ThreadPool *pool);
+
+    bool init(int width, int height, DxtFormat format, DxtQuality quality = DXT_QUALITY_HIGH);
+
+    // rgbaΪеRGBAͼ, blocksҪframeBytes()ֽ
+    void encode(const uint8_t *rgba, uint8_t *blocks);
+    // planes/linesizesyuv420_to_rgbͬ, yuv420_to_rgbתRGBAencodeֽͬ
+    void encodeYUV420(const uint8_t * const *planes, const int *linesizes, YuvChromaLayout chromaLayout, uint8_t *blocks);
+
+    int frameBytes() const {
+        return dxtFrameBytes(width, height, format);
+    }
+
+    void printStatistics();
+
+    // 4K±ȽϸʽλPSNR(ѹǰRGB)
+    static void benchmark(ThreadPool *pool);
+
+private:
+    static void encodeBand(void *context, int bandIndex);
+    // ѹһ, rowsΪÿе(1~4), sourceΪ⼸неRGBA
+    void encodeBlockRow(const uint8_t *source, int rows, uint8_t *dest);
+    void encodeFrame(uint8_t *blocks);
+    // һ4x4RGBAתŵYCoCg: R=Co, G=Cg, B=ϵ, A=Y
+    static void convertBlockToYCoCg(const uint8_t *rgbaBlock, uint8_t *ycocgBlock);
+
+    ThreadPool *pool;
+    int width;
+    int height;
+    DxtFormat format;
+    DxtQuality quality;
+    // stb_compress_dxt_blockģʽ
+    int compressMode;
+    int blockRows;
+    int bandCount;
+
+    int frameCount;
+    __int64 totalMicroSeconds;
+
+    // ÿһ4еRGBAл, YUVʱʹ
+    std::vector<uint8_t> blockRowBuffers;
+
+    // ǰencodeĲ, ֻencode()/encodeYUV420()ִڼЧ, rgbaΪNULLʱΪYUV
+    const uint8_t *rgba;
+    const uint8_t * const *planes;
+    const int *linesizes;
+    YuvChromaLayout chromaLayout;
+    uint8_t *blocks;
+};
@@ -0,0 +1,149 @@
+#include "DxtVideoFile.h"
+#include <iostream>
+#include <string.h>
+
+static const char DXT_VIDEO_MAGIC[4] = { 'D', 'X', 'T', 'V' };
+static const uint32_t DXT_VIDEO_VERSION = 1;
+// ÿ֡ҳ, ӳÿ֡ѹ鶼ҳĿͷʼ
+static const uint64_t DXT_FRAME_ALIGNMENT = 4096;
+// ˳ȡʱǰԤ֡
+static const int READ_AHEAD_FRAMES = 8;
+
+DxtVideoWriter::DxtVideoWriter() :
+    writeOffset(0) {
+    memset(&header, 0, sizeof(header));
+}
+
+DxtVideoWriter::~DxtVideoWriter() {
+    if (stream.is_open()) {
+        close();
+    }
+}
+
+bool DxtVideoWriter::open(const std::string &fileName, int width, int height, DxtFormat format,
+    int timeBaseNum, int timeBaseDen, int frameRateNum, int frameRateDen) {
+    stream.open(fileName, std::ios::binary | std::ios::out | std::ios::trunc);
+    if (!stream.is_open()) {
+        std::cout << "DxtVideoWriter: failed to open " << fileName << std::endl;
+        return false;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DXT_VIDEO_MAGIC, sizeof(header.magic));
+    header.version = DXT_VIDEO_VERSION;
+    header.width = width;
+    header.height = height;
+    header.format = format;
+    header.frameBytes = dxtFrameBytes(width, height, format);
+    header.timeBaseNum = timeBaseNum;
+    header.timeBaseDen = timeBaseDen;
+    header.frameRateNum = frameRateNum;
+    header.frameRateDen = frameRateDen;
+    index.clear();
+
+    // дһռλļͷ, closeʱٻ֡λ
+    stream.write((const char *)&header, sizeof(header));
+    writeOffset = sizeof(header);
+    return stream.good();
+}
+
+bool DxtVideoWriter::writeFrame(const uint8_t *blocks, int64_t pts) {
+    static const char padding[DXT_FRAME_ALIGNMENT] = { 0 };
+    uint64_t alignedOffset = (writeOffset + DXT_FRAME_ALIGNMENT - 1) / DXT_FRAME_ALIGNMENT * DXT_FRAME_ALIGNMENT;
+    stream.write(padding, (std::streamsize)(alignedOffset - writeOffset));
+    stream.write((const char *)blocks, header.frameBytes);
+    writeOffset = alignedOffset + header.frameBytes;
+
+    DxtFrameIndexEntry entry;
+    entry.offset = alignedOffset;
+    entry.pts = pts;
+    index.push_back(entry);
+    return stream.good();
+}
+
+bool DxtVideoWriter::close() {
+    header.frameCount = (uint32_t)index.size();
+    header.indexOffset = writeOffset;
+    if (!index.empty()) {
+        stream.write((const char *)&index[0], index.size() * sizeof(DxtFrameIndexEntry));
+    }
+    stream.seekp(0, std::ios::beg);
+    stream.write((const char *)&header, sizeof(header));
+    bool good = stream.good();
+    stream.close();
+    return good;
+}
+
+DxtVideoSource::DxtVideoSource() :
+    index(NULL),
+    prefetchedUntil(0) {
+    memset(&header, 0, sizeof(header));
+}
+
+DxtVideoSource::~DxtVideoSource() {
+    close();
+}
+
+bool DxtVideoSource::open(const std::string &fileName) {
+    close();
+    if (!file.open(fileName, true)) {
+        return false;
+    }
+    if (file.size() < (long long)sizeof(header)) {
+        std::cout << "DxtVideoSource: " << fileName << " is too small" << std::endl;
+        close();
+        return false;
+    }
+
+    memcpy(&header, file.data(), sizeof(header));
+    uint64_t indexBytes = (uint64_t)header.frameCount * sizeof(DxtFrameIndexEntry);
+    if (memcmp(header.magic, DXT_VIDEO_MAGIC, sizeof(header.magic)) != 0 || header.version != DXT_VIDEO_VERSION
+        || header.format > DXT_FORMAT_YCOCG_DXT5
+        || header.frameBytes != (uint32_t)dxtFrameBytes(header.width, header.height, (DxtFormat)header.format)
+        || header.indexOffset + indexBytes > (uint64_t)file.size()) {
+        std::cout << "DxtVideoSource: " << fileName << " is not a valid DXT video file" << std::endl;
+        close();
+        return false;
+    }
+    index = (const DxtFrameIndexEntry *)(file.data() + header.indexOffset);
+    for (uint32_t i = 0; i < header.frameCount; i++) {
+        if (index[i].offset + header.frameBytes > header.indexOffset) {
+            std::cout << "DxtVideoSource: frame " << i << " of " << fileName << " is truncated" << std::endl;
+            close();
+            return false;
+        }
+    }
+
+    prefetchedUntil = 0;
+    return true;
+}
+
+void DxtVideoSource::close() {
+    file.close();
+    index = NULL;
+    memset(&header, 0, sizeof(header));
+}
+
+bool DxtVideoSource::getFrame(int index, const uint8_t **blocks, int64_t *pts) {
+    if (this->index == NULL || index < 0 || index >= frameCount()) {
+        return false;
+    }
+
+    const DxtFrameIndexEntry &entry = this->index[index];
+    *blocks = file.data() + entry.offset;
+    *pts = entry.pts;
+
+    // MappedYUVSourceͬ, ˳ȡʱÿһ֡Ԥ, ԤķΧʱӵǰ֮֡Ԥ
+    int until = index + 1 + READ_AHEAD_FRAMES;
+    if (until > frameCount()) {
+        until = frameCount();
+    }
+    bool jumped = index + 1 > prefetchedUntil || index + 2 * READ_AHEAD_FRAMES < prefetchedUntil;
+    int from = jumped ? index + 1 : prefetchedUntil;
+    if (until > from) {
+        uint64_t start = this->index[from].offset;
+        file.prefetch(start, this->index[until - 1].offset + header.frameBytes - start);
+    }
+    prefetchedUntil = until;
+    return true;
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <fstream>
+#include "MappedFile.h"
+
+enum DxtFormat {
+    DXT_FORMAT_DXT1 = 0, // RGB, ÿ4x48ֽ
+    DXT_FORMAT_YCOCG_DXT5, // ŵYCoCgDXT5, ÿ4x416ֽ, ʽӽԭͼ, ҪɫתRGB
+};
+
+// ÿ4x4ѹֽ
+inline int dxtBlockBytes(DxtFormat format) {
+    return format == DXT_FORMAT_DXT1 ? 8 : 16;
+}
+
+// һ֡ѹֽ, ߲4ıʱԵĿ鰴Ŀ
+inline int dxtFrameBytes(int width, int height, DxtFormat format) {
+    return ((width + 3) / 4) * ((height + 3) / 4) * dxtBlockBytes(format);
+}
+
+/**
+* DXTƵļļͷ, λļͷ
+* ļ: ļͷ | ֡ѹ, ÿ֡ʼλðҳ | ֡
+*/
+struct DxtVideoHeader {
+    char magic[4]; // "DXTV"
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t format; // DxtFormat
+    uint32_t frameCount;
+    uint32_t frameBytes; // ÿ֡ѹֽ, ֡ͬ
+    int32_t timeBaseNum; // ptsĵλΪtimeBaseNum / timeBaseDen
+    int32_t timeBaseDen;
+    int32_t frameRateNum;
+    int32_t frameRateDen;
+    uint32_t reserved;
+    uint64_t indexOffset; // ֡ļеƫ
+};
+
+// ֡еһ, ʾ˳
+struct DxtFrameIndexEntry {
+    uint64_t offset;
+    int64_t pts;
+};
+
+/**
+* Ѱʾ˳ѹõ֡֡дDXTƵļ, ȫдcloseд֡ļͷ
+*/
+class DxtVideoWriter {
+public:
+    DxtVideoWriter();
+    ~DxtVideoWriter();
+
+    bool open(const std::string &fileName, int width, int height, DxtFormat format,
+        int timeBaseNum, int timeBaseDen, int frameRateNum, int frameRateDen);
+
+    // blocksΪheader.frameBytesֽڵѹ
+    bool writeFrame(const uint8_t *blocks, int64_t pts);
+
+    bool close();
+
+    int frameCount() const {
+        return (int)index.size();
+    }
+
+private:
+    std::ofstream stream;
+    DxtVideoHeader header;
+    std::vector<DxtFrameIndexEntry> index;
+    uint64_t writeOffset;
+};
+
+/**
+* ڴӳȡDXTƵļ, ÿ֡ѹֱָָӳļ, ֱӽglCompressedTexImage2D
+*/
+class DxtVideoSource {
+public:
+    DxtVideoSource();
+    ~DxtVideoSource();
+
+    bool open(const std::string &fileName);
+    void close();
+
+    const DxtVideoHeader &getHeader() const {
+        return header;
+    }
+
+    DxtFormat format() const {
+        return (DxtFormat)header.format;
+    }
+
+    int frameCount() const {
+        return (int)header.frameCount;
+    }
+
+    // ȡindex֡ѹʾʱ, ָclose֮ǰһֱЧ
+    bool getFrame(int index, const uint8_t **blocks, int64_t *pts);
+
+private:
+    MappedFile file;
+    DxtVideoHeader header;
+    const DxtFrameIndexEntry *index;
+    int prefetchedUntil; // ѾʾԤ֡Ͻ
+};
@@ -0,0 +1,151 @@
+#include "ErpViewport.h"
+#include <cmath>
+
+// ӿÿϵĲ, ҪСһӦĽǶ
+static const int VIEWPORT_SAMPLES = 48;
+static const double ERP_PI = 3.14159265358979323846;
+
+ErpViewport::ErpViewport(int frameWidth, int frameHeight, int tileColumns, int tileRows, int guardTiles) :
+    frameWidth(frameWidth),
+    frameHeight(frameHeight),
+    tileColumns(tileColumns),
+    tileRows(tileRows),
+    guardTiles(guardTiles),
+    fraction(1.0) {
+    visibleTiles.assign(tileColumns * tileRows, 0);
+}
+
+int ErpViewport::tileX(int column) const {
+    // 뵽ż, ֤ɫƽϵ򲻻λ
+    return (int)((long long)frameWidth * column / tileColumns) & ~1;
+}
+
+int ErpViewport::tileY(int row) const {
+    return (int)((long long)frameHeight * row / tileRows) & ~1;
+}
+
+/**
+* ɷʽһ: x = sin(lat)sin(lon), y = cos(lat), z = sin(lat)cos(lon), u = lon / 2pi, v = lat / pi
+*/
+void ErpViewport::markDirection(const glm::vec3 &direction) {
+    glm::vec3 d = glm::normalize(direction);
+    double latitude = acos(fmax(-1.0, fmin(1.0, (double)d.y)));
+    double longitude = atan2((double)d.x, (double)d.z);
+    if (longitude < 0) {
+        longitude += 2 * ERP_PI;
+    }
+    int column = (int)(longitude / (2 * ERP_PI) * tileColumns);
+    int row = (int)(latitude / ERP_PI * tileRows);
+    column = column < 0 ? 0 : (column >= tileColumns ? tileColumns - 1 : column);
+    row = row < 0 ? 0 : (row >= tileRows ? tileRows - 1 : row);
+    visibleTiles[row * tileColumns + column] = 1;
+}
+
+bool ErpViewport::isPoleVisible(const glm::mat4 &viewProjection, float y) {
+    glm::vec4 clip = viewProjection * glm::vec4(0, y, 0, 1);
+    return clip.w > 0 && fabs(clip.x) <= clip.w && fabs(clip.y) <= clip.w;
+}
+
+bool ErpViewport::update(const glm::mat4 &viewProjection) {
+    visibleTiles.assign(tileColumns * tileRows, 0);
+
+    // ӿڵĵ㷴ͶӰԶƽ, , Զƽϵĵ߷
+    glm::mat4 inverse = glm::inverse(viewProjection);
+    for (int i = 0; i <= VIEWPORT_SAMPLES; i++) {
+        for (int j = 0; j <= VIEWPORT_SAMPLES; j++) {
+            float x = -1.0f + 2.0f * j / VIEWPORT_SAMPLES;
+            float y = -1.0f + 2.0f * i / VIEWPORT_SAMPLES;
+            glm::vec4 point = inverse * glm::vec4(x, y, 1, 1);
+            markDirection(glm::vec3(point) / point.w);
+        }
+    }
+
+    // 㸽СһĻ͸о
+    if (isPoleVisible(viewProjection, 1)) {
+        for (int column = 0; column < tileColumns; column++) {
+            visibleTiles[column] = 1;
+        }
+    }
+    if (isPoleVisible(viewProjection, -1)) {
+        for (int column = 0; column < tileColumns; column++) {
+            visibleTiles[(tileRows - 1) * tileColumns + column] = 1;
+        }
+    }
+
+    // : ȷ, γȷض
+    if (guardTiles > 0) {
+        std::vector<unsigned char> dilated(visibleTiles.size(), 0);
+        for (int row = 0; row < tileRows; row++) {
+            for (int column = 0; column < tileColumns; column++) {
+                if (!visibleTiles[row * tileColumns + column]) {
+                    continue;
+                }
+                for (int dy = -guardTiles; dy <= guardTiles; dy++) {
+                    int r = row + dy;
+                    if (r < 0 || r >= tileRows) {
+                        continue;
+                    }
+                    for (int dx = -guardTiles; dx <= guardTiles; dx++) {
+                        int c = ((column + dx) % tileColumns + tileColumns) % tileColumns;
+                        dilated[r * tileColumns + c] = 1;
+                    }
+                }
+            }
+        }
+        visibleTiles.swap(dilated);
+    }
+
+    if (visibleTiles == previousTiles) {
+        return false;
+    }
+    previousTiles = visibleTiles;
+    buildRegions();
+    return true;
+}
+
+void ErpViewport::buildRegions() {
+    regions.clear();
+    long long visiblePixels = 0;
+
+    for (int row = 0; row < tileRows; row++) {
+        int y = tileY(row);
+        int height = tileY(row + 1) - y;
+        if (row == tileRows - 1) {
+            height = frameHeight - y;
+        }
+
+        int column = 0;
+        while (column < tileColumns) {
+            if (!visibleTiles[row * tileColumns + column]) {
+                column++;
+                continue;
+            }
+            int first = column;
+            while (column < tileColumns && visibleTiles[row * tileColumns + column]) {
+                column++;
+            }
+            TextureRegion region;
+            region.x = tileX(first);
+            region.width = (column == tileColumns ? frameWidth : tileX(column)) - region.x;
+            region.y = y;
+            region.height = height;
+            visiblePixels += (long long)region.width * region.height;
+
+            // һдоȷΧͬºϲ
+            bool merged = false;
+            for (size_t k = 0; k < regions.size(); k++) {
+                TextureRegion &above = regions[k];
+                if (above.x == region.x && above.width == region.width && above.y + above.height == region.y) {
+                    above.height += region.height;
+                    merged = true;
+                    break;
+                }
+            }
+            if (!merged) {
+                regions.push_back(region);
+            }
+        }
+    }
+
+    fraction = 1.0 * visiblePixels / ((long long)frameWidth * frameHeight);
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <vector>
+#include <glm.hpp>
+
+// ϵһ, ƽΪλ, ߶ż, 㻻㵽4:2:0ɫƽ
+struct TextureRegion {
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+/**
+* ݵǰERPпɼ
+* ERP滮ֳtileColumns x tileRows, ӿھȲ߷, 䵽Ŀ,
+* չguardTilesΪ, дϲɾ
+* ȷ0/360ȴ, ӿʱдɼ
+*/
+class ErpViewport {
+public:
+    ErpViewport(int frameWidth, int frameHeight, int tileColumns = 32, int tileRows = 16, int guardTiles = 1);
+
+    // viewProjectionΪͶӰԹ۲, ԭ, ؿɼǷ仯
+    bool update(const glm::mat4 &viewProjection);
+
+    const std::vector<TextureRegion> &getRegions() const {
+        return regions;
+    }
+
+    // ɼռ֡ı
+    double visibleFraction() const {
+        return fraction;
+    }
+
+private:
+    void markDirection(const glm::vec3 &direction);
+    bool isPoleVisible(const glm::mat4 &viewProjection, float y);
+    void buildRegions();
+    int tileX(int column) const;
+    int tileY(int row) const;
+
+    int frameWidth;
+    int frameHeight;
+    int tileColumns;
+    int tileRows;
+    int guardTiles;
+
+    std::vector<unsigned char> visibleTiles;
+    std::vector<unsigned char> previousTiles;
+    std::vector<TextureRegion> regions;
+    double fraction;
+};
@@ -0,0 +1,160 @@
+#include "FrameCache.h"
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+#ifdef USE_LZ4
+#include <lz4.h>
+#pragma comment (lib, "liblz4.lib")
+#endif
+
+FrameCache::FrameCache(long long budgetBytes, bool compress) :
+    budgetBytes(budgetBytes),
+    compress(compress),
+    recording(true),
+    complete(false),
+    overBudget(false),
+    storedBytes(0),
+    rawBytes(0),
+    hitCount(0),
+    missCount(0) {
+#ifndef USE_LZ4
+    if (compress) {
+        std::cout << "FrameCache: built without USE_LZ4, frames are cached uncompressed" << std::endl;
+        this->compress = false;
+    }
+#endif
+}
+
+FrameCache::~FrameCache() {
+    clear();
+}
+
+void FrameCache::clear() {
+    for (size_t i = 0; i < frames.size(); i++) {
+        free(frames[i].data);
+    }
+    frames.clear();
+    storedBytes = 0;
+    rawBytes = 0;
+}
+
+bool FrameCache::store(const uint8_t * const planes[], const int linesizes[], const int rowBytes[], const int rows[], int planeCount, int64_t pts) {
+    if (!recording) {
+        return false;
+    }
+
+    int rawSize = 0;
+    for (int p = 0; p < planeCount; p++) {
+        rawSize += rowBytes[p] * rows[p];
+    }
+    if (!compress && storedBytes + rawSize > budgetBytes) {
+        abandon();
+        return false;
+    }
+
+    // ѹʱȽеpackBuffer, ֱеڴ
+    uint8_t *packed = NULL;
+    if (compress) {
+        packBuffer.resize(rawSize);
+        packed = packBuffer.data();
+    } else {
+        packed = (uint8_t *)malloc(rawSize);
+        if (packed == NULL) {
+            abandon();
+            return false;
+        }
+    }
+    uint8_t *dst = packed;
+    for (int p = 0; p < planeCount; p++) {
+        for (int row = 0; row < rows[p]; row++) {
+            memcpy(dst, planes[p] + row * linesizes[p], rowBytes[p]);
+            dst += rowBytes[p];
+        }
+    }
+
+    CachedFrame frame;
+    frame.data = packed;
+    frame.storedSize = rawSize;
+    frame.rawSize = rawSize;
+    frame.pts = pts;
+#ifdef USE_LZ4
+    if (compress) {
+        int bound = LZ4_compressBound(rawSize);
+        frame.data = (uint8_t *)malloc(bound);
+        if (frame.data == NULL) {
+            abandon();
+            return false;
+        }
+        frame.storedSize = LZ4_compress_default((const char *)packed, (char *)frame.data, rawSize, bound);
+        // ѶĿռ仹ϵͳ
+        uint8_t *shrunk = (uint8_t *)realloc(frame.data, frame.storedSize);
+        if (shrunk != NULL) {
+            frame.data = shrunk;
+        }
+        if (storedBytes + frame.storedSize > budgetBytes) {
+            free(frame.data);
+            abandon();
+            return false;
+        }
+    }
+#endif
+
+    frames.push_back(frame);
+    storedBytes += frame.storedSize;
+    rawBytes += rawSize;
+    return true;
+}
+
+void FrameCache::abandon() {
+    std::cout << "FrameCache: budget of " << budgetBytes / (1024 * 1024) << " MB exceeded after " << frames.size()
+        << " frames, falling back to decoding every loop" << std::endl;
+    clear();
+    std::vector<uint8_t>().swap(packBuffer);
+    recording = false;
+    overBudget = true;
+}
+
+void FrameCache::finishRecording() {
+    if (recording.exchange(false)) {
+        complete = !frames.empty();
+    }
+}
+
+bool FrameCache::fetch(int index, uint8_t *buffer, int bufferSize, const uint8_t **data, int64_t *pts) {
+    if (!complete || index < 0 || index >= (int)frames.size()) {
+        return false;
+    }
+    const CachedFrame &frame = frames[index];
+    *pts = frame.pts;
+    if (!compress) {
+        *data = frame.data;
+        hitCount++;
+        return true;
+    }
+#ifdef USE_LZ4
+    if (buffer == NULL || bufferSize < frame.rawSize) {
+        return false;
+    }
+    if (LZ4_decompress_safe((const char *)frame.data, (char *)buffer, frame.storedSize, bufferSize) != frame.rawSize) {
+        return false;
+    }
+    *data = buffer;
+    hitCount++;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void FrameCache::printStatistics() {
+    long long total = hitCount + missCount;
+    std::cout << "Frame cache: " << (complete ? "complete" : (overBudget ? "over budget" : "incomplete")) << ", "
+        << frames.size() << " frames" << (compress ? " (LZ4)" : "") << std::endl
+        << "Frame cache memory: " << storedBytes / (1024.0 * 1024.0) << " MB of " << budgetBytes / (1024 * 1024) << " MB budget";
+    if (compress && storedBytes > 0) {
+        std::cout << ", compression ratio " << 1.0 * rawBytes / storedBytes;
+    }
+    std::cout << std::endl
+        << "Frame cache hits: " << hitCount << ", misses: " << missCount << ", hit rate: "
+        << (total > 0 ? 100.0 * hitCount / total : 0.0) << "%" << std::endl;
+}
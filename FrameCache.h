@@ -0,0 +1,76 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include <atomic>
+
+/**
+* repeatģʽµĽ֡ڴ滺
+* һ鲥ʱתÿһ֡еش, ֮ѭֱӴڴȡ֡, ٽ
+* ܴСԤʱ, ˵ÿѭ½
+* USE_LZ4liblz4ѡLZ4ѹ֡
+*/
+class FrameCache {
+public:
+    FrameCache(long long budgetBytes, bool compress);
+    ~FrameCache();
+
+    // һ鲥ʱת׶ε, ƽ水rowBytes/rowsܿ
+    // Ԥ󷵻false, 汻Ҳټ¼
+    bool store(const uint8_t * const planes[], const int linesizes[], const int rowBytes[], const int rows[], int planeCount, int64_t pts);
+
+    // ļһ, ˺󻺴ֻ
+    void finishRecording();
+
+    // װ߳̾ݴ˾βʱǷͷʼ, дת/̲߳ͬһ߳
+    bool isRecording() const {
+        return recording;
+    }
+
+    // һش֡
+    bool isComplete() const {
+        return complete;
+    }
+
+    int frameCount() const {
+        return (int)frames.size();
+    }
+
+    // ȡindex֡, δѹʱ*dataֱָ򻺴, ѹʱѹbufferָbuffer
+    bool fetch(int index, uint8_t *buffer, int bufferSize, const uint8_t **data, int64_t *pts);
+
+    // һ֡ǽõĶǴӻȡõ
+    void recordMiss() {
+        missCount++;
+    }
+
+    bool isCompressed() const {
+        return compress;
+    }
+
+    void printStatistics();
+
+private:
+    struct CachedFrame {
+        uint8_t *data;
+        int storedSize; // ʵռõֽ, ѹСrawSize
+        int rawSize;
+        int64_t pts;
+    };
+
+    void clear();
+    // Ԥ, ͷѻֹ֡ͣ¼
+    void abandon();
+
+    long long budgetBytes;
+    bool compress;
+    std::atomic<bool> recording;
+    bool complete;
+    bool overBudget;
+    std::vector<CachedFrame> frames;
+    std::vector<uint8_t> packBuffer;
+
+    long long storedBytes;
+    long long rawBytes;
+    long long hitCount;
+    long long missCount;
+};
@@ -0,0 +1,176 @@
+#include "FrameRing.h"
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+
+FrameRing::FrameRing() :
+    slots(NULL),
+    slotCount(0),
+    writeIndex(0),
+    readIndex(0),
+    readyCount(0),
+    closed(false),
+    writeStallCount(0),
+    readStallCount(0),
+    readCount(0),
+    depthSum(0),
+    maxDepth(0) {
+    pthread_mutex_init(&lock, NULL);
+}
+
+FrameRing::~FrameRing() {
+    if (slots != NULL) {
+        for (int i = 0; i < slotCount; i++) {
+            free(slots[i].buffer);
+            av_frame_free(&slots[i].frame);
+        }
+        delete[] slots;
+        slots = NULL;
+        sem_destroy(&freeSlotsSemaphore);
+        sem_destroy(&readySlotsSemaphore);
+    }
+    pthread_mutex_destroy(&lock);
+}
+
+bool FrameRing::init(int slotCount, int bytesPerSlot) {
+    if (slots != NULL || slotCount <= 0 || bytesPerSlot < 0) {
+        return false;
+    }
+
+    this->slotCount = slotCount;
+    slots = new FrameSlot[slotCount]();
+    sem_init(&freeSlotsSemaphore, 0, slotCount);
+    sem_init(&readySlotsSemaphore, 0, 0);
+    for (int i = 0; i < slotCount; i++) {
+        slots[i].buffer = bytesPerSlot > 0 ? (uint8_t *)malloc(bytesPerSlot) : NULL;
+        slots[i].bufferSize = bytesPerSlot;
+        slots[i].frame = av_frame_alloc();
+        memset(slots[i].planes, 0, sizeof(slots[i].planes));
+        memset(slots[i].linesizes, 0, sizeof(slots[i].linesizes));
+        slots[i].frameIndex = -1;
+        slots[i].pts = INT64_MIN;
+        slots[i].state = FSS_FREE;
+        if ((bytesPerSlot > 0 && slots[i].buffer == NULL) || slots[i].frame == NULL) {
+            std::cout << "Failed to malloc for frame slot " << i << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+FrameSlot * FrameRing::acquireWriteSlot() {
+    if (sem_trywait(&freeSlotsSemaphore) != 0) {
+        pthread_mutex_lock(&lock);
+        writeStallCount++;
+        pthread_mutex_unlock(&lock);
+        sem_wait(&freeSlotsSemaphore);
+    }
+
+    pthread_mutex_lock(&lock);
+    if (closed) {
+        pthread_mutex_unlock(&lock);
+        // źȥ, ֤ȴҲܱ
+        sem_post(&freeSlotsSemaphore);
+        return NULL;
+    }
+    FrameSlot *slot = &slots[writeIndex];
+    writeIndex = (writeIndex + 1) % slotCount;
+    slot->state = FSS_WRITING;
+    pthread_mutex_unlock(&lock);
+    return slot;
+}
+
+void FrameRing::commitWriteSlot(FrameSlot *slot) {
+    pthread_mutex_lock(&lock);
+    slot->state = FSS_READY;
+    readyCount++;
+    if (readyCount > maxDepth) {
+        maxDepth = readyCount;
+    }
+    pthread_mutex_unlock(&lock);
+    sem_post(&readySlotsSemaphore);
+}
+
+void FrameRing::cancelWriteSlot(FrameSlot *slot) {
+    // releaseReadSlotһд߿Ѿһϣ
+    slot->regions.clear();
+    slot->tileHashes.clear();
+    pthread_mutex_lock(&lock);
+    slot->state = FSS_FREE;
+    writeIndex = (writeIndex + slotCount - 1) % slotCount;
+    pthread_mutex_unlock(&lock);
+    sem_post(&freeSlotsSemaphore);
+}
+
+FrameSlot * FrameRing::acquireReadSlot() {
+    if (sem_trywait(&readySlotsSemaphore) != 0) {
+        pthread_mutex_lock(&lock);
+        if (!closed) {
+            readStallCount++;
+        }
+        pthread_mutex_unlock(&lock);
+        sem_wait(&readySlotsSemaphore);
+    }
+
+    pthread_mutex_lock(&lock);
+    if (readyCount == 0) {
+        // ֻclose()Żû֡»Ⱦ߳
+        pthread_mutex_unlock(&lock);
+        sem_post(&readySlotsSemaphore);
+        return NULL;
+    }
+    FrameSlot *slot = &slots[readIndex];
+    readIndex = (readIndex + 1) % slotCount;
+    depthSum += readyCount;
+    readCount++;
+    readyCount--;
+    slot->state = FSS_READING;
+    pthread_mutex_unlock(&lock);
+    return slot;
+}
+
+void FrameRing::releaseReadSlot(FrameSlot *slot) {
+    av_frame_unref(slot->frame);
+    slot->regions.clear();
+    slot->tileHashes.clear();
+    pthread_mutex_lock(&lock);
+    slot->state = FSS_FREE;
+    pthread_mutex_unlock(&lock);
+    sem_post(&freeSlotsSemaphore);
+}
+
+void FrameRing::close() {
+    pthread_mutex_lock(&lock);
+    if (closed) {
+        pthread_mutex_unlock(&lock);
+        return;
+    }
+    closed = true;
+    pthread_mutex_unlock(&lock);
+    sem_post(&readySlotsSemaphore);
+    sem_post(&freeSlotsSemaphore);
+}
+
+bool FrameRing::isClosed() {
+    pthread_mutex_lock(&lock);
+    bool result = closed;
+    pthread_mutex_unlock(&lock);
+    return result;
+}
+
+int FrameRing::depth() {
+    pthread_mutex_lock(&lock);
+    int result = readyCount;
+    pthread_mutex_unlock(&lock);
+    return result;
+}
+
+void FrameRing::printStatistics() {
+    pthread_mutex_lock(&lock);
+    double averageDepth = readCount > 0 ? 1.0 * depthSum / readCount : 0.0;
+    std::cout << "Frame ring slots: " << slotCount << std::endl
+        << "Frame ring average depth: " << averageDepth << ", max depth: " << maxDepth << std::endl
+        << "Decoder stalls (ring full): " << writeStallCount << std::endl
+        << "Render stalls (ring empty): " << readStallCount << std::endl;
+    pthread_mutex_unlock(&lock);
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include <pthread.h>
+#include <semaphore.h>
+#include "ErpViewport.h"
+extern "C"
+{
+#include <libavutil\frame.h>
+};
+
+enum FrameSlotState {
+    FSS_FREE = 0, // , Ա̻߳ȡ
+    FSS_WRITING, // ߳д
+    FSS_READY, // д, ȴȾ̶߳ȡ
+    FSS_READING // Ⱦ߳ڶȡ
+};
+
+/**
+* ζеһ֡λ, initʱԤȷ
+* planes/linesizes֡ʵʵ, Ҫôָbuffer,
+* ҪôָframeõĽ, ߲Ҫκο
+* regionsΪʱֻҪϴе
+*/
+struct FrameSlot {
+    uint8_t *buffer;
+    int bufferSize;
+    AVFrame *frame;
+    uint8_t *planes[3];
+    int linesizes[3];
+    int frameIndex;
+    int64_t pts; // ʾʱ, λд߾, ûʱʱΪINT64_MIN
+    std::vector<TextureRegion> regions; // ֻЩЧ, Ϊʱ֡Ч
+    std::vector<uint64_t> tileHashes; // д߼ÿݹϣ, Ϊʱûм
+    FrameSlotState state;
+};
+
+/**
+* ߳Ⱦ֮߳Nλ֡ζ
+* ߳̿Ⱦ߳N֡, ߵĺʱ
+*/
+class FrameRing {
+public:
+    FrameRing();
+    ~FrameRing();
+
+    // slotCountλ, ÿλbytesPerSlotֽ, ֻAVFrameʱbytesPerSlotΪ0
+    bool init(int slotCount, int bytesPerSlot);
+
+    // ̻߳ȡһвλ, ûпвλʱ, йرպ󷵻NULL
+    FrameSlot *acquireWriteSlot();
+    void commitWriteSlot(FrameSlot *slot);
+    // дʧʱѸջȡĲλؿ״̬, ֻһacquireWriteSlotõĲλ
+    void cancelWriteSlot(FrameSlot *slot);
+
+    // Ⱦ̰߳˳ȡһѽĲλ, Ϊʱ, йرΪʱNULL
+    FrameSlot *acquireReadSlot();
+    // 黹λ, ͬʱͷŲλеAVFrame
+    void releaseReadSlot(FrameSlot *slot);
+
+    // ֪ͨвµ֡, еȴ߳
+    void close();
+
+    int capacity() const {
+        return slotCount;
+    }
+
+    // Ⱦ߳ǷѾر˶
+    bool isClosed();
+
+    // ǰѽ뵫δȾ֡
+    int depth();
+
+    void printStatistics();
+
+private:
+    FrameSlot *slots;
+    int slotCount;
+    int writeIndex;
+    int readIndex;
+    int readyCount;
+    bool closed;
+
+    sem_t freeSlotsSemaphore;
+    sem_t readySlotsSemaphore;
+    pthread_mutex_t lock;
+
+    // ͳϢ
+    long long writeStallCount; // ߳ΪûпвλȴĴ
+    long long readStallCount; // Ⱦ߳Ϊûѽ֡ȴĴ
+    long long readCount;
+    long long depthSum;
+    int maxDepth;
+};
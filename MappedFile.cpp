@@ -0,0 +1,133 @@
+#include "MappedFile.h"
+#include <iostream>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef _WIN32
+// PrefetchVirtualMemoryWindows 8֮, ʱ, ҲͲԤ
+typedef struct {
+    PVOID VirtualAddress;
+    SIZE_T NumberOfBytes;
+} PrefetchRange;
+typedef BOOL(WINAPI *PrefetchVirtualMemoryFunc)(HANDLE, ULONG_PTR, PrefetchRange *, ULONG);
+#endif
+
+MappedFile::MappedFile() :
+    mappedData(NULL),
+    fileSize(0),
+#ifdef _WIN32
+    fileHandle(INVALID_HANDLE_VALUE),
+    mappingHandle(NULL) {
+#else
+    fileDescriptor(-1) {
+#endif
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string &fileName, bool sequential) {
+    close();
+
+#ifdef _WIN32
+    // FILE_FLAG_SEQUENTIAL_SCAN൱MADV_SEQUENTIAL, ûԤ
+    fileHandle = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+        sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS, NULL);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        std::cout << "MappedFile: failed to open " << fileName << std::endl;
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(fileHandle, &size) || size.QuadPart <= 0) {
+        close();
+        return false;
+    }
+    fileSize = size.QuadPart;
+    mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mappingHandle == NULL) {
+        close();
+        return false;
+    }
+    mappedData = (const uint8_t *)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+#else
+    fileDescriptor = ::open(fileName.c_str(), O_RDONLY);
+    if (fileDescriptor < 0) {
+        std::cout << "MappedFile: failed to open " << fileName << std::endl;
+        return false;
+    }
+    struct stat fileStat;
+    if (fstat(fileDescriptor, &fileStat) != 0 || fileStat.st_size <= 0) {
+        close();
+        return false;
+    }
+    fileSize = fileStat.st_size;
+    void *address = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    mappedData = address == MAP_FAILED ? NULL : (const uint8_t *)address;
+    if (mappedData != NULL) {
+        madvise((void *)mappedData, fileSize, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+    }
+#endif
+    if (mappedData == NULL) {
+        // 32λӳ䲻ºܴļ
+        std::cout << "MappedFile: failed to map " << fileName << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+#ifdef _WIN32
+    if (mappedData != NULL) {
+        UnmapViewOfFile(mappedData);
+    }
+    if (mappingHandle != NULL) {
+        CloseHandle(mappingHandle);
+        mappingHandle = NULL;
+    }
+    if (fileHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(fileHandle);
+        fileHandle = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (mappedData != NULL) {
+        munmap((void *)mappedData, fileSize);
+    }
+    if (fileDescriptor >= 0) {
+        ::close(fileDescriptor);
+        fileDescriptor = -1;
+    }
+#endif
+    mappedData = NULL;
+    fileSize = 0;
+}
+
+void MappedFile::prefetch(long long offset, long long length) {
+    if (mappedData == NULL || offset < 0 || offset >= fileSize || length <= 0) {
+        return;
+    }
+    if (offset + length > fileSize) {
+        length = fileSize - offset;
+    }
+    const uint8_t *start = mappedData + offset;
+#ifdef _WIN32
+    static PrefetchVirtualMemoryFunc prefetchVirtualMemory =
+        (PrefetchVirtualMemoryFunc)GetProcAddress(GetModuleHandleA("kernel32.dll"), "PrefetchVirtualMemory");
+    if (prefetchVirtualMemory != NULL) {
+        PrefetchRange range;
+        range.VirtualAddress = (PVOID)start;
+        range.NumberOfBytes = (SIZE_T)length;
+        prefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+#else
+    // madviseҪʼַҳ
+    long pageSize = sysconf(_SC_PAGESIZE);
+    uintptr_t alignedStart = (uintptr_t)start & ~(uintptr_t)(pageSize - 1);
+    madvise((void *)alignedStart, (size_t)length + ((uintptr_t)start - alignedStart), MADV_WILLNEED);
+#endif
+}
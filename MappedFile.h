@@ -0,0 +1,46 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+/**
+* ֻʽڴӳļ
+* ӳļݿڴһƫ, ϵͳҳ, Ҫκο
+*/
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    // sequentialΪtrueʱʾϵͳ˳Ԥ, ʴ
+    bool open(const std::string &fileName, bool sequential);
+    void close();
+
+    const uint8_t *data() const {
+        return mappedData;
+    }
+
+    long long size() const {
+        return fileSize;
+    }
+
+    bool isOpen() const {
+        return mappedData != NULL;
+    }
+
+    // ʾϵͳ[offset, offset + length)ڴ, ļĩβĲֱ
+    void prefetch(long long offset, long long length);
+
+private:
+    const uint8_t *mappedData;
+    long long fileSize;
+
+#ifdef _WIN32
+    HANDLE fileHandle;
+    HANDLE mappingHandle;
+#else
+    int fileDescriptor;
+#endif
+};
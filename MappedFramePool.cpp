@@ -0,0 +1,210 @@
+#include "MappedFramePool.h"
+#include <iostream>
+
+// п֡Ķֽ, libavcodecSIMDʵֵҪ
+static const int MAPPED_FRAME_ALIGN = 64;
+
+static inline size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+MappedFramePool::MappedFramePool() :
+    buffer(0),
+    mapped(NULL),
+    pixelFormat(AV_PIX_FMT_NONE),
+    width(0),
+    height(0),
+    regionBytes(0),
+    mappedFrameCount(0),
+    fallbackFrameCount(0) {
+    pthread_mutex_init(&lock, NULL);
+    for (int i = 0; i < 3; i++) {
+        linesizes[i] = 0;
+        planeOffsets[i] = 0;
+    }
+}
+
+MappedFramePool::~MappedFramePool() {
+    release();
+    pthread_mutex_destroy(&lock);
+}
+
+bool MappedFramePool::init(AVCodecContext *codecContext, int frameCount) {
+    if (!GLEW_ARB_buffer_storage || !GLEW_ARB_sync) {
+        std::cout << "GL_ARB_buffer_storage is not supported, decoder frames are allocated by FFmpeg" << std::endl;
+        return false;
+    }
+    if ((codecContext->pix_fmt != AV_PIX_FMT_YUV420P && codecContext->pix_fmt != AV_PIX_FMT_YUVJ420P) || frameCount <= 0) {
+        return false;
+    }
+
+    // ҪĶ벹, дıԵ
+    int alignedWidth = codecContext->width;
+    int alignedHeight = codecContext->height;
+    int linesizeAlign[AV_NUM_DATA_POINTERS];
+    avcodec_align_dimensions2(codecContext, &alignedWidth, &alignedHeight, linesizeAlign);
+    pixelFormat = codecContext->pix_fmt;
+    width = alignedWidth;
+    height = alignedHeight;
+    linesizes[0] = (int)alignUp(alignedWidth, MAPPED_FRAME_ALIGN);
+    linesizes[1] = linesizes[2] = (int)alignUp((alignedWidth + 1) / 2, MAPPED_FRAME_ALIGN);
+    int chromaHeight = (alignedHeight + 1) / 2;
+    planeOffsets[0] = 0;
+    planeOffsets[1] = (size_t)linesizes[0] * alignedHeight;
+    planeOffsets[2] = planeOffsets[1] + (size_t)linesizes[1] * chromaHeight;
+    // ĩβ, һЩSIMDʵֻдֽ
+    regionBytes = alignUp(planeOffsets[2] + (size_t)linesizes[2] * chromaHeight + MAPPED_FRAME_ALIGN, MAPPED_FRAME_ALIGN);
+
+    // Ҫο֡, ɶʾڿɻϵͳڴ, дϲڴο֡ǳ
+    GLsizeiptr totalBytes = (GLsizeiptr)(regionBytes * frameCount);
+    GLbitfield mapFlags = GL_MAP_READ_BIT | GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+    glBufferStorage(GL_PIXEL_UNPACK_BUFFER, totalBytes, NULL, mapFlags | GL_CLIENT_STORAGE_BIT);
+    mapped = (uint8_t *)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, totalBytes, mapFlags);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (mapped == NULL) {
+        std::cout << "Failed to map " << totalBytes / 1024.0 / 1024.0 << " MB for decoder frames" << std::endl;
+        release();
+        return false;
+    }
+
+    regions.resize(frameCount);
+    for (int i = 0; i < frameCount; i++) {
+        regions[i].pool = this;
+        regions[i].index = i;
+        regions[i].state = RS_FREE;
+        regions[i].fence = NULL;
+    }
+    return true;
+}
+
+void MappedFramePool::release() {
+    pthread_mutex_lock(&lock);
+    for (size_t i = 0; i < regions.size(); i++) {
+        if (regions[i].fence != NULL) {
+            glDeleteSync(regions[i].fence);
+            regions[i].fence = NULL;
+        }
+    }
+    if (buffer != 0) {
+        if (mapped != NULL) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+    }
+    mapped = NULL;
+    pthread_mutex_unlock(&lock);
+}
+
+int MappedFramePool::getBuffer2(AVCodecContext *codecContext, AVFrame *frame, int flags) {
+    MappedFramePool *pool = (MappedFramePool *)codecContext->opaque;
+    if (pool != NULL && pool->acquire(codecContext, frame)) {
+        return 0;
+    }
+    return avcodec_default_get_buffer2(codecContext, frame, flags);
+}
+
+bool MappedFramePool::acquire(AVCodecContext *codecContext, AVFrame *frame) {
+    pthread_mutex_lock(&lock);
+    Region *region = NULL;
+    if (mapped != NULL && frame->format == pixelFormat && frame->width <= width && frame->height <= height) {
+        for (size_t i = 0; i < regions.size(); i++) {
+            if (regions[i].state == RS_FREE) {
+                region = &regions[i];
+                region->state = RS_IN_USE;
+                break;
+            }
+        }
+    }
+    if (region == NULL) {
+        fallbackFrameCount++;
+        pthread_mutex_unlock(&lock);
+        return false;
+    }
+    mappedFrameCount++;
+    pthread_mutex_unlock(&lock);
+
+    uint8_t *base = mapped + regionBytes * region->index;
+    frame->buf[0] = av_buffer_create(base, (int)regionBytes, releaseBuffer, region, 0);
+    if (frame->buf[0] == NULL) {
+        pthread_mutex_lock(&lock);
+        region->state = RS_FREE;
+        pthread_mutex_unlock(&lock);
+        return false;
+    }
+    for (int i = 0; i < 3; i++) {
+        frame->data[i] = base + planeOffsets[i];
+        frame->linesize[i] = linesizes[i];
+    }
+    frame->extended_data = frame->data;
+    return true;
+}
+
+void MappedFramePool::releaseBuffer(void *opaque, uint8_t *data) {
+    Region *region = (Region *)opaque;
+    MappedFramePool *pool = region->pool;
+    pthread_mutex_lock(&pool->lock);
+    // ϴҪȾ߳ȷGPUѾ
+    region->state = region->fence != NULL ? RS_WAITING_FENCE : RS_FREE;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+int MappedFramePool::regionIndexOf(const unsigned char *pointer) {
+    if (mapped == NULL || pointer < mapped || pointer >= mapped + regionBytes * regions.size()) {
+        return -1;
+    }
+    return (int)((pointer - mapped) / regionBytes);
+}
+
+bool MappedFramePool::bindForUpload(unsigned char * const *planes, unsigned char *offsets[3]) {
+    if (regionIndexOf(planes[0]) < 0) {
+        return false;
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+    for (int i = 0; i < 3; i++) {
+        offsets[i] = (unsigned char *)NULL + (planes[i] - mapped);
+    }
+    return true;
+}
+
+void MappedFramePool::finishUpload(const unsigned char *plane) {
+    int index = regionIndexOf(plane);
+    GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    pthread_mutex_lock(&lock);
+    if (regions[index].fence != NULL) {
+        glDeleteSync(regions[index].fence);
+    }
+    regions[index].fence = fence;
+    pthread_mutex_unlock(&lock);
+}
+
+void MappedFramePool::recycle() {
+    pthread_mutex_lock(&lock);
+    for (size_t i = 0; i < regions.size(); i++) {
+        Region &region = regions[i];
+        if (region.fence == NULL) {
+            continue;
+        }
+        GLenum result = glClientWaitSync(region.fence, 0, 0);
+        if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) {
+            glDeleteSync(region.fence);
+            region.fence = NULL;
+            if (region.state == RS_WAITING_FENCE) {
+                region.state = RS_FREE;
+            }
+        }
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+void MappedFramePool::printStatistics() {
+    pthread_mutex_lock(&lock);
+    std::cout << "Mapped decoder frames: " << regions.size() << " regions of " << regionBytes / 1024.0 / 1024.0 << " MB, "
+        << mappedFrameCount << " frames decoded into GL memory, " << fallbackFrameCount << " frames fell back to FFmpeg buffers" << std::endl;
+    pthread_mutex_unlock(&lock);
+}
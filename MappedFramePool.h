@@ -0,0 +1,76 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include <pthread.h>
+#include "glew.h"
+extern "C"
+{
+#include <libavcodec\avcodec.h>
+};
+
+/**
+* ṩ֡AVCodecContext::get_buffer2
+* ֡һGL_ARB_buffer_storage־ӳGL, ֱӰдGLԶȡڴ,
+* Ⱦ̰߳ΪGL_PIXEL_UNPACK_BUFFERϴ, ֮䲻CPU
+*
+* ÿ֡ڸAVBufferRefü: һͷʱ,
+* ϴûбGPUִ(fenceδ), ҪȾ߳ȷfence·
+* ʽߴ粻, , ָ߲֧չʱavcodec_default_get_buffer2, Щ֡ͨϴ·
+*/
+class MappedFramePool {
+public:
+    MappedFramePool();
+    ~MappedFramePool();
+
+    // ڳGLĵ߳, codecContextĳߴظʽframeCount֡, ֻ֧YUV420P/YUVJ420P
+    bool init(AVCodecContext *codecContext, int frameCount);
+    // ɾGL, ֮з䶼˻ĬϷ; Ѿֳȥ֡ٱд
+    void release();
+
+    // ΪAVCodecContext::get_buffer2, AVCodecContext::opaqueָMappedFramePool
+    static int getBuffer2(AVCodecContext *codecContext, AVFrame *frame, int flags);
+
+    // Ⱦ߳: planesλڳʱ󶨻offsetsзظƽƫ, falseʱʲôҲ
+    bool bindForUpload(unsigned char * const *planes, unsigned char *offsets[3]);
+    // Ⱦ߳: bindForUpload󶨵Ļύϴ, fence
+    void finishUpload(const unsigned char *plane);
+    // Ⱦ߳: fenceѾͷŵŻؿб, ÿ֡һ
+    void recycle();
+
+    void printStatistics();
+
+private:
+    enum RegionState {
+        RS_FREE = 0,
+        RS_IN_USE, // AVBufferRef
+        RS_WAITING_FENCE // Ѿȫͷ, ȴGPU
+    };
+
+    struct Region {
+        MappedFramePool *pool;
+        int index;
+        RegionState state;
+        GLsync fence; // һϴfence, ֻȾ̴߳ɾ
+    };
+
+    bool acquire(AVCodecContext *codecContext, AVFrame *frame);
+    static void releaseBuffer(void *opaque, uint8_t *data);
+    int regionIndexOf(const unsigned char *pointer);
+
+    GLuint buffer;
+    uint8_t *mapped;
+    std::vector<Region> regions;
+    pthread_mutex_t lock;
+
+    // ֡
+    AVPixelFormat pixelFormat;
+    int width;
+    int height;
+    int linesizes[3];
+    size_t planeOffsets[3];
+    size_t regionBytes;
+
+    // ͳϢ, lock
+    long long mappedFrameCount;
+    long long fallbackFrameCount;
+};
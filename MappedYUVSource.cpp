@@ -0,0 +1,78 @@
+#include "MappedYUVSource.h"
+
+// ˳ȡʱǰԤ֡
+static const int READ_AHEAD_FRAMES = 8;
+
+MappedYUVSource::MappedYUVSource() :
+    width(0),
+    height(0),
+    bytesPerFrame(0),
+    frameCountInFile(0),
+    prefetchedUntil(0) {
+}
+
+MappedYUVSource::~MappedYUVSource() {
+    close();
+}
+
+bool MappedYUVSource::open(const std::string &fileName, int width, int height) {
+    close();
+    this->width = width;
+    this->height = height;
+    bytesPerFrame = (long long)width * height * 3 / 2;
+    if (bytesPerFrame <= 0) {
+        return false;
+    }
+
+    if (!file.open(fileName, true)) {
+        return false;
+    }
+    if (file.size() < bytesPerFrame) {
+        close();
+        return false;
+    }
+
+    frameCountInFile = (int)(file.size() / bytesPerFrame);
+    prefetchedUntil = 0;
+    prefetch(0, READ_AHEAD_FRAMES);
+    return true;
+}
+
+void MappedYUVSource::close() {
+    file.close();
+    frameCountInFile = 0;
+}
+
+void MappedYUVSource::prefetch(int index, int count) {
+    if (!file.isOpen() || index >= frameCountInFile) {
+        return;
+    }
+    if (index + count > frameCountInFile) {
+        count = frameCountInFile - index;
+    }
+    file.prefetch(index * bytesPerFrame, count * bytesPerFrame);
+}
+
+bool MappedYUVSource::getFrame(int index, const uint8_t *planes[3], int linesizes[3]) {
+    if (!file.isOpen() || index < 0 || index >= frameCountInFile) {
+        return false;
+    }
+
+    const uint8_t *frame = file.data() + index * bytesPerFrame;
+    planes[0] = frame;
+    planes[1] = frame + width * height;
+    planes[2] = frame + width * height / 4 * 5;
+    linesizes[0] = width;
+    linesizes[1] = width / 2;
+    linesizes[2] = width / 2;
+
+    // ˳ȡʱÿһ֡Ԥ, ԤķΧʱӵǰ֮֡Ԥ
+    int until = index + 1 + READ_AHEAD_FRAMES;
+    bool jumped = index + 1 > prefetchedUntil || index + 2 * READ_AHEAD_FRAMES < prefetchedUntil;
+    int from = jumped ? index + 1 : prefetchedUntil;
+    if (until > from) {
+        prefetch(from, until - from);
+    }
+    prefetchedUntil = until;
+    return true;
+}
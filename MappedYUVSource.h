@@ -0,0 +1,37 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include "MappedFile.h"
+
+/**
+* ڴӳȡYUV420P Rawļ
+* ÿ֡Y/U/Vƽֱָָӳļ, Ҫκο, ԰֡
+* ˳ȡʱʾϵͳԤ֡
+*/
+class MappedYUVSource {
+public:
+    MappedYUVSource();
+    ~MappedYUVSource();
+
+    bool open(const std::string &fileName, int width, int height);
+    void close();
+
+    // ļ֡ĸ, ĩβһ֡ݱ
+    int frameCount() const {
+        return frameCountInFile;
+    }
+
+    // ȡindex֡ƽָп(ֽ), ָclose֮ǰһֱЧ
+    bool getFrame(int index, const uint8_t *planes[3], int linesizes[3]);
+
+    // ʾϵͳѴindexʼcount֡ڴ
+    void prefetch(int index, int count);
+
+private:
+    int width;
+    int height;
+    long long bytesPerFrame;
+    int frameCountInFile;
+    MappedFile file;
+    int prefetchedUntil; // ѾʾԤ֡Ͻ
+};
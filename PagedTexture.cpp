@@ -0,0 +1,291 @@
+#include "PagedTexture.h"
+#include <iostream>
+
+// ÿҳܵı߿
+static const int PAGE_BORDER = 1;
+// ҳ󶨵ԪfirstTextureUnitƫ, 3ƽ֮, ƽ޹, NV12ʱûõv_texõԪ
+static const int PAGE_TABLE_UNIT_OFFSET = 3;
+
+PagedTexture::PagedTexture() :
+    width(0),
+    height(0),
+    pageSize(0),
+    pageColumns(0),
+    pageRows(0),
+    planeCount(0),
+    firstTextureUnit(0),
+    wrapColumns(false),
+    pageTableTexture(0),
+    frameNumber(0),
+    uploadedPages(0),
+    missingPages(0) {
+    for (int i = 0; i < 3; i++) {
+        textures[i] = 0;
+    }
+}
+
+PagedTexture::~PagedTexture() {
+    release();
+}
+
+bool PagedTexture::init(int width, int height, int pageSize, int planeCount, const GLenum *internalFormats, const GLenum *formats,
+    const int *bytesPerPixel, const int *chromaShifts, size_t budgetBytes, GLuint program, const char * const *samplerNames, int firstTextureUnit,
+    bool wrapColumns) {
+    release();
+    if (width <= 0 || height <= 0 || pageSize <= 0 || pageSize % 2 != 0 || planeCount < 1 || planeCount > 3) {
+        return false;
+    }
+    this->width = width;
+    this->height = height;
+    this->pageSize = pageSize;
+    this->planeCount = planeCount;
+    this->firstTextureUnit = firstTextureUnit;
+    this->wrapColumns = wrapColumns;
+    pageColumns = (width + pageSize - 1) / pageSize;
+    pageRows = (height + pageSize - 1) / pageSize;
+
+    size_t pageBytes = 0;
+    for (int i = 0; i < planeCount; i++) {
+        this->formats[i] = formats[i];
+        this->bytesPerPixel[i] = bytesPerPixel[i];
+        this->chromaShifts[i] = chromaShifts[i];
+        int layerSize = (pageSize >> chromaShifts[i]) + 2 * PAGE_BORDER;
+        pageBytes += (size_t)layerSize * layerSize * bytesPerPixel[i];
+    }
+    GLint maxLayers = 0;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+    int layers = pageCount();
+    if (layers > maxLayers) {
+        layers = maxLayers;
+    }
+    if ((size_t)layers * pageBytes > budgetBytes) {
+        layers = (int)(budgetBytes / pageBytes);
+    }
+    if (layers < 1) {
+        return false;
+    }
+
+    glGenTextures(planeCount, textures);
+    for (int i = 0; i < planeCount; i++) {
+        int layerSize = (pageSize >> chromaShifts[i]) + 2 * PAGE_BORDER;
+        glActiveTexture(GL_TEXTURE0 + firstTextureUnit + i);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, textures[i]);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        if (GLEW_ARB_texture_storage) {
+            glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, internalFormats[i], layerSize, layerSize, layers);
+        } else {
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, internalFormats[i], layerSize, layerSize, layers, 0, formats[i], GL_UNSIGNED_BYTE, NULL);
+        }
+        glUniform1i(glGetUniformLocation(program, samplerNames[i]), firstTextureUnit + i);
+    }
+
+    pageTable.assign(pageCount(), -1);
+    layerPages.assign(layers, -1);
+    layerLastUsed.assign(layers, -1);
+    requested.assign(pageCount(), 1);
+
+    // ֻ, ɫtexelFetchȡ
+    glGenTextures(1, &pageTableTexture);
+    glActiveTexture(GL_TEXTURE0 + firstTextureUnit + PAGE_TABLE_UNIT_OFFSET);
+    glBindTexture(GL_TEXTURE_2D, pageTableTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R16I, pageColumns, pageRows, 0, GL_RED_INTEGER, GL_SHORT, &pageTable[0]);
+    glUniform1i(glGetUniformLocation(program, "pageTable"), firstTextureUnit + PAGE_TABLE_UNIT_OFFSET);
+    glUniform2f(glGetUniformLocation(program, "pagesPerFrame"), 1.0f * width / pageSize, 1.0f * height / pageSize);
+    glActiveTexture(GL_TEXTURE0);
+
+    if (glGetError() != GL_NO_ERROR) {
+        std::cout << "Failed to create a paged texture of " << layers << " layers" << std::endl;
+        release();
+        return false;
+    }
+    return true;
+}
+
+void PagedTexture::release() {
+    if (planeCount > 0 && textures[0] != 0) {
+        glDeleteTextures(planeCount, textures);
+    }
+    for (int i = 0; i < 3; i++) {
+        textures[i] = 0;
+    }
+    if (pageTableTexture != 0) {
+        glDeleteTextures(1, &pageTableTexture);
+        pageTableTexture = 0;
+    }
+    pageTable.clear();
+    layerPages.clear();
+    layerLastUsed.clear();
+    requested.clear();
+}
+
+void PagedTexture::requestRegions(const std::vector<TextureRegion> *regions) {
+    if (regions == NULL) {
+        requested.assign(pageCount(), 1);
+        return;
+    }
+    requested.assign(pageCount(), 0);
+    for (size_t i = 0; i < regions->size(); i++) {
+        const TextureRegion &region = (*regions)[i];
+        if (region.width <= 0 || region.height <= 0) {
+            continue;
+        }
+        int lastColumn = (region.x + region.width - 1) / pageSize;
+        int lastRow = (region.y + region.height - 1) / pageSize;
+        for (int row = region.y / pageSize; row <= lastRow && row < pageRows; row++) {
+            for (int column = region.x / pageSize; column <= lastColumn && column < pageColumns; column++) {
+                requested[row * pageColumns + column] = 1;
+            }
+        }
+    }
+}
+
+/**
+* pageһ: ʹÿеĲ, ʹñ֡ҪĲûõ, ûʱ-1
+*/
+int PagedTexture::assignLayer(int page) {
+    int victim = -1;
+    for (int layer = 0; layer < (int)layerPages.size(); layer++) {
+        if (layerPages[layer] < 0) {
+            victim = layer;
+            break;
+        }
+        if (layerLastUsed[layer] < frameNumber && (victim < 0 || layerLastUsed[layer] < layerLastUsed[victim])) {
+            victim = layer;
+        }
+    }
+    if (victim < 0) {
+        return -1;
+    }
+    if (layerPages[victim] >= 0) {
+        pageTable[layerPages[victim]] = -1;
+    }
+    layerPages[victim] = page;
+    pageTable[page] = (short)victim;
+    return victim;
+}
+
+void PagedTexture::upload(unsigned char * const *planes, const int *linesizes) {
+    if (layerPages.empty()) {
+        return;
+    }
+    frameNumber++;
+    // ȱѾפҳ, ǵĲ㱾ܱ֡
+    for (int page = 0; page < pageCount(); page++) {
+        if (requested[page] && pageTable[page] >= 0) {
+            layerLastUsed[pageTable[page]] = frameNumber;
+        }
+    }
+    bool pageTableChanged = false;
+    for (int page = 0; page < pageCount(); page++) {
+        if (requested[page] && pageTable[page] < 0) {
+            int layer = assignLayer(page);
+            if (layer < 0) {
+                missingPages++;
+                continue;
+            }
+            layerLastUsed[layer] = frameNumber;
+            pageTableChanged = true;
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (int i = 0; i < planeCount; i++) {
+        glActiveTexture(GL_TEXTURE0 + firstTextureUnit + i);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, textures[i]);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, linesizes[i] / bytesPerPixel[i]);
+        for (int page = 0; page < pageCount(); page++) {
+            if (requested[page] && pageTable[page] >= 0) {
+                uploadPage(i, page, pageTable[page], planes[i]);
+            }
+        }
+    }
+    for (int page = 0; page < pageCount(); page++) {
+        if (requested[page] && pageTable[page] >= 0) {
+            uploadedPages++;
+        }
+    }
+
+    glActiveTexture(GL_TEXTURE0 + firstTextureUnit + PAGE_TABLE_UNIT_OFFSET);
+    glBindTexture(GL_TEXTURE_2D, pageTableTexture);
+    if (pageTableChanged) {
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+        glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+        // ҳС, Ǵڴϴ, ʱܰŵPBO
+        GLint unpackBuffer = 0;
+        glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &unpackBuffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, pageColumns, pageRows, GL_RED_INTEGER, GL_SHORT, &pageTable[0]);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, unpackBuffer);
+    }
+    glActiveTexture(GL_TEXTURE0);
+}
+
+/**
+* ҳһҪϴض, ÿΪ(, , ): ڵĲԭϴ,
+* ı߿ƱԵ(߿ֻ1ؿ, ͬclamp), wrapʱȡһ(ERPľȷβ)
+* һҳֻһڻ, ֻдŻԵı߿, Զزᱻ; ض
+*/
+static int pageSpans(int start, int end, int planeSize, bool wrap, int spans[3][3]) {
+    int sourceStart = start > 0 ? start : 0;
+    int sourceEnd = end < planeSize ? end : planeSize;
+    if (sourceEnd <= sourceStart) {
+        return 0;
+    }
+    int count = 0;
+    if (start < 0) {
+        spans[count][0] = 0;
+        spans[count][1] = wrap ? planeSize - PAGE_BORDER : 0;
+        spans[count][2] = PAGE_BORDER;
+        count++;
+    }
+    spans[count][0] = sourceStart - start;
+    spans[count][1] = sourceStart;
+    spans[count][2] = sourceEnd - sourceStart;
+    count++;
+    if (end > planeSize) {
+        spans[count][0] = planeSize - start;
+        spans[count][1] = wrap ? 0 : planeSize - PAGE_BORDER;
+        spans[count][2] = PAGE_BORDER;
+        count++;
+    }
+    return count;
+}
+
+/**
+* ѵplaneƽpageҳͬ߿ϴlayer, ܱչ, ߿򳬳ĲҲҪд, ¾ҳ
+*/
+void PagedTexture::uploadPage(int plane, int page, int layer, const unsigned char *data) {
+    int shift = chromaShifts[plane];
+    int planePage = pageSize >> shift;
+    int planeWidth = width >> shift;
+    int planeHeight = height >> shift;
+    int x0 = (page % pageColumns) * planePage - PAGE_BORDER;
+    int y0 = (page / pageColumns) * planePage - PAGE_BORDER;
+    int columns[3][3];
+    int rows[3][3];
+    int columnCount = pageSpans(x0, x0 + planePage + 2 * PAGE_BORDER, planeWidth, wrapColumns, columns);
+    int rowCount = pageSpans(y0, y0 + planePage + 2 * PAGE_BORDER, planeHeight, false, rows);
+    for (int r = 0; r < rowCount; r++) {
+        for (int c = 0; c < columnCount; c++) {
+            glPixelStorei(GL_UNPACK_SKIP_PIXELS, columns[c][1]);
+            glPixelStorei(GL_UNPACK_SKIP_ROWS, rows[r][1]);
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, columns[c][0], rows[r][0], layer, columns[c][2], rows[r][2], 1,
+                formats[plane], GL_UNSIGNED_BYTE, data);
+        }
+    }
+}
+
+void PagedTexture::printStatistics() {
+    if (frameNumber == 0) {
+        return;
+    }
+    std::cout << "Paged texture: " << pageColumns << "x" << pageRows << " pages of " << pageSize << " texels, " << layerCount() << " resident layers, "
+        << 1.0 * uploadedPages / frameNumber << " pages uploaded per frame, " << missingPages << " requested pages had no free layer" << std::endl;
+}
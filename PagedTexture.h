@@ -0,0 +1,70 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include "glew.h"
+#include "ErpViewport.h"
+
+/**
+* ҳ洢Ƶ֡, ڳGL_MAX_TEXTURE_SIZEERP/TSP֡
+* ֡pageSize x pageSize()ֳҳ, ÿƽҳһGL_TEXTURE_2D_ARRAYĲ,
+* ҳһGL_R16I, ¼ÿһҳڵĲ, פҳΪ-1, ƬԪɫͨsamplePaged
+* ÿֻ֡ϴɼ򸲸ǵҳ; ҪҳռÿеĲûõĲ, ԴԤ
+* ÿҳܶ1صı߿, ˫Թҳı߽ϲֽӷ; еöڳGLĵ߳
+*/
+class PagedTexture {
+public:
+    PagedTexture();
+    ~PagedTexture();
+
+    // width/heightƽ; ƽiinternalFormats[i]洢, formats[i]ϴ, ÿbytesPerPixel[i]ֽ,
+    // ߰chromaShifts[i]С, 󶨵ԪfirstTextureUnit + i, ҳ󶨵firstTextureUnit + 3
+    // ʱprogramʹ, samplerNames[i]pageTable, pagesPerFrameЩuniform
+    // wrapColumnsΪtrueʱ(ERP)˳ı߿ȡһ, ƱԵ
+    bool init(int width, int height, int pageSize, int planeCount, const GLenum *internalFormats, const GLenum *formats,
+        const int *bytesPerPixel, const int *chromaShifts, size_t budgetBytes, GLuint program, const char * const *samplerNames, int firstTextureUnit,
+        bool wrapColumns);
+    void release();
+
+    // Ǳ֡Ҫҳ: regions()ཻҳ, regionsΪNULLʱҳҪ
+    void requestRegions(const std::vector<TextureRegion> *regions);
+    // Ҫҳ㲢ϴ, planes/linesizesglTexSubImage2Dָͬ, PBOеƫ
+    void upload(unsigned char * const *planes, const int *linesizes);
+
+    int pageCount() const {
+        return pageColumns * pageRows;
+    }
+
+    int layerCount() const {
+        return (int)layerPages.size();
+    }
+
+    void printStatistics();
+
+private:
+    int assignLayer(int page);
+    void uploadPage(int plane, int page, int layer, const unsigned char *data);
+
+    int width;
+    int height;
+    int pageSize;
+    int pageColumns;
+    int pageRows;
+    int planeCount;
+    GLenum formats[3];
+    int bytesPerPixel[3];
+    int chromaShifts[3];
+    int firstTextureUnit;
+    bool wrapColumns;
+    GLuint textures[3];
+    GLuint pageTableTexture;
+
+    std::vector<short> pageTable; // ҳ -> , -1ʾפ
+    std::vector<int> layerPages; //  -> ҳ, -1ʾ
+    std::vector<long long> layerLastUsed; // һαҪ֡
+    std::vector<unsigned char> requested;
+    long long frameNumber;
+
+    // ͳϢ
+    long long uploadedPages;
+    long long missingPages; // Ҫûпвҳ, ʾΪɫ
+};
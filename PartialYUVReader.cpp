@@ -0,0 +1,148 @@
+#include "PartialYUVReader.h"
+#include <iostream>
+#include <string.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+PartialYUVReader::PartialYUVReader() :
+    width(0),
+    height(0),
+    bytesPerFrame(0),
+    frameCountInFile(0),
+#ifdef _WIN32
+    fileHandle(INVALID_HANDLE_VALUE),
+#else
+    fileDescriptor(-1),
+#endif
+    frameReadCount(0),
+    bytesRead(0),
+    readCalls(0) {
+}
+
+PartialYUVReader::~PartialYUVReader() {
+    close();
+}
+
+bool PartialYUVReader::open(const std::string &fileName, int width, int height) {
+    close();
+    this->width = width;
+    this->height = height;
+    bytesPerFrame = (long long)width * height * 3 / 2;
+
+    long long fileSize = 0;
+#ifdef _WIN32
+    // ÿֻ֡ɢļ, ϵͳҪ˳Ԥ
+    fileHandle = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        std::cout << "PartialYUVReader: failed to open " << fileName << std::endl;
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(fileHandle, &size)) {
+        close();
+        return false;
+    }
+    fileSize = size.QuadPart;
+#else
+    fileDescriptor = ::open(fileName.c_str(), O_RDONLY);
+    if (fileDescriptor < 0) {
+        std::cout << "PartialYUVReader: failed to open " << fileName << std::endl;
+        return false;
+    }
+    struct stat fileStat;
+    if (fstat(fileDescriptor, &fileStat) != 0) {
+        close();
+        return false;
+    }
+    fileSize = fileStat.st_size;
+    posix_fadvise(fileDescriptor, 0, 0, POSIX_FADV_RANDOM);
+#endif
+
+    frameCountInFile = (int)(fileSize / bytesPerFrame);
+    if (frameCountInFile == 0) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void PartialYUVReader::close() {
+#ifdef _WIN32
+    if (fileHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(fileHandle);
+        fileHandle = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (fileDescriptor >= 0) {
+        ::close(fileDescriptor);
+        fileDescriptor = -1;
+    }
+#endif
+    frameCountInFile = 0;
+}
+
+bool PartialYUVReader::readAt(long long offset, uint8_t *destination, int size) {
+    readCalls++;
+#ifdef _WIN32
+    // ͬϴOVERLAPPEDReadFilepread, ָƫƶȡļָ޹
+    OVERLAPPED overlapped;
+    memset(&overlapped, 0, sizeof(overlapped));
+    overlapped.Offset = (DWORD)(offset & 0xFFFFFFFF);
+    overlapped.OffsetHigh = (DWORD)(offset >> 32);
+    DWORD read = 0;
+    if (!ReadFile(fileHandle, destination, size, &read, &overlapped) || (int)read != size) {
+        return false;
+    }
+#else
+    if (pread(fileDescriptor, destination, size, offset) != size) {
+        return false;
+    }
+#endif
+    bytesRead += size;
+    return true;
+}
+
+bool PartialYUVReader::readRegions(int index, const std::vector<TextureRegion> &regions, uint8_t *frameBuffer) {
+    if (index < 0 || index >= frameCountInFile) {
+        return false;
+    }
+
+    long long frameOffset = index * bytesPerFrame;
+    long long planeOffsets[3] = { 0, (long long)width * height, (long long)width * height / 4 * 5 };
+    bool result = true;
+    for (int p = 0; p < 3; p++) {
+        int shift = p == 0 ? 0 : 1;
+        int planeWidth = width >> shift;
+        for (size_t r = 0; r < regions.size(); r++) {
+            int x = regions[r].x >> shift;
+            int y = regions[r].y >> shift;
+            int regionWidth = regions[r].width >> shift;
+            int regionHeight = regions[r].height >> shift;
+            long long offset = planeOffsets[p] + (long long)y * planeWidth + x;
+            if (regionWidth == planeWidth) {
+                // пļ, һζ
+                result &= readAt(frameOffset + offset, frameBuffer + offset, regionWidth * regionHeight);
+            } else {
+                for (int row = 0; row < regionHeight; row++) {
+                    result &= readAt(frameOffset + offset, frameBuffer + offset, regionWidth);
+                    offset += planeWidth;
+                }
+            }
+        }
+    }
+    frameReadCount++;
+    return result;
+}
+
+void PartialYUVReader::printStatistics() {
+    if (frameReadCount == 0) {
+        return;
+    }
+    double bytesPerFrameRead = 1.0 * bytesRead / frameReadCount;
+    std::cout << "Partial YUV read: " << bytesPerFrameRead / (1024 * 1024) << " MB per frame ("
+        << 100.0 * bytesPerFrameRead / bytesPerFrame << "% of a full frame), "
+        << 1.0 * readCalls / frameReadCount << " reads per frame" << std::endl;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "ErpViewport.h"
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+/**
+* ȡYUV420P Rawļеһ֡
+* ֻȡڵӦɫ, ôƫĶȡ(pread/OVERLAPPEDReadFile),
+* ƶļָ, ݰ֡ĲдĿ껺, ֮ݱֲ
+*/
+class PartialYUVReader {
+public:
+    PartialYUVReader();
+    ~PartialYUVReader();
+
+    bool open(const std::string &fileName, int width, int height);
+    void close();
+
+    int frameCount() const {
+        return frameCountInFile;
+    }
+
+    // ѵindex֡regionsڵݶframeBuffer(СΪһ֡), Ƿȫȡɹ
+    bool readRegions(int index, const std::vector<TextureRegion> &regions, uint8_t *frameBuffer);
+
+    void printStatistics();
+
+private:
+    bool readAt(long long offset, uint8_t *destination, int size);
+
+    int width;
+    int height;
+    long long bytesPerFrame;
+    int frameCountInFile;
+
+#ifdef _WIN32
+    HANDLE fileHandle;
+#else
+    int fileDescriptor;
+#endif
+
+    // ͳϢ
+    long long frameReadCount;
+    long long bytesRead;
+    long long readCalls;
+};
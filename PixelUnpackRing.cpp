@@ -0,0 +1,102 @@
+#include "PixelUnpackRing.h"
+#include <iostream>
+
+// ȴfenceʱÿʱ(), ʱȴֱGPU
+static const GLuint64 FENCE_WAIT_NANOSECONDS = 1000000;
+
+PixelUnpackRing::PixelUnpackRing() :
+    bytesPerSlot(0),
+    current(0),
+    uploadStart(0),
+    uploadMicroSeconds(0),
+    fenceWaitMicroSeconds(0),
+    uploadCount(0) {
+    timeMeasurer.Start();
+}
+
+PixelUnpackRing::~PixelUnpackRing() {
+    release();
+}
+
+bool PixelUnpackRing::init(int slotCount, size_t bytesPerSlot) {
+    release();
+    if (slotCount <= 0 || bytesPerSlot == 0) {
+        return false;
+    }
+    this->bytesPerSlot = bytesPerSlot;
+    buffers.resize(slotCount, 0);
+    fences.resize(slotCount, NULL);
+    glGenBuffers(slotCount, &buffers[0]);
+    for (int i = 0; i < slotCount; i++) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffers[i]);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, bytesPerSlot, NULL, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    current = 0;
+    if (glGetError() != GL_NO_ERROR) {
+        std::cout << "Failed to create " << slotCount << " pixel unpack buffers of " << bytesPerSlot << " bytes" << std::endl;
+        release();
+        return false;
+    }
+    return true;
+}
+
+void PixelUnpackRing::release() {
+    for (size_t i = 0; i < fences.size(); i++) {
+        if (fences[i] != NULL) {
+            glDeleteSync(fences[i]);
+        }
+    }
+    fences.clear();
+    if (!buffers.empty()) {
+        glDeleteBuffers((GLsizei)buffers.size(), &buffers[0]);
+        buffers.clear();
+    }
+    bytesPerSlot = 0;
+}
+
+uint8_t *PixelUnpackRing::map() {
+    if (buffers.empty()) {
+        return NULL;
+    }
+    uploadStart = timeMeasurer.elapsedMicroSecondsSinceStart();
+    if (fences[current] != NULL) {
+        GLenum result;
+        do {
+            result = glClientWaitSync(fences[current], GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_WAIT_NANOSECONDS);
+        } while (result == GL_TIMEOUT_EXPIRED);
+        glDeleteSync(fences[current]);
+        fences[current] = NULL;
+        fenceWaitMicroSeconds += timeMeasurer.elapsedMicroSecondsSinceStart() - uploadStart;
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffers[current]);
+    // fenceѾ֤GPUٶPBO, Ҫͬ
+    void *data = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytesPerSlot,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (data == NULL) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    return (uint8_t *)data;
+}
+
+void PixelUnpackRing::unmap() {
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+}
+
+void PixelUnpackRing::finish() {
+    fences[current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    current = (current + 1) % (int)buffers.size();
+    uploadMicroSeconds += timeMeasurer.elapsedMicroSecondsSinceStart() - uploadStart;
+    uploadCount++;
+}
+
+void PixelUnpackRing::printStatistics() {
+    if (uploadCount == 0) {
+        return;
+    }
+    std::cout << "Texture upload: " << buffers.size() << " pixel unpack buffers of " << bytesPerSlot / 1024.0 / 1024.0 << " MB, "
+        << uploadCount << " uploads, average " << uploadMicroSeconds / 1000.0 / uploadCount << " ms per frame, of which "
+        << fenceWaitMicroSeconds / 1000.0 / uploadCount << " ms waiting for the GPU" << std::endl;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include "glew.h"
+#include "TimeMeasurer.h"
+
+/**
+* ϴõؽ(PBO)
+* ÿ֡ȰؿһPBO, ٴPBOִglTexSubImage2D, 첽DMA, 
+* ÿPBOϴһfence, ٴֵʱȵȴfence, ֤GPUѾһε
+* N֡DMAN+1֡Ŀص; еöڳGLĵ߳
+*/
+class PixelUnpackRing {
+public:
+    PixelUnpackRing();
+    ~PixelUnpackRing();
+
+    // slotCountbytesPerSlotֽڵPBO, ҪGL 3.2ARB_sync
+    bool init(int slotCount, size_t bytesPerSlot);
+    void release();
+
+    size_t slotBytes() const {
+        return bytesPerSlot;
+    }
+
+    // ȴһPBO, 󶨵GL_PIXEL_UNPACK_BUFFERӳ, ʧʱNULLҲ
+    uint8_t *map();
+    // ӳ, PBOְ, ֮glTexSubImage2DָPBOƫ
+    void unmap();
+    // glTexSubImage2Dύ: fence, , һPBO
+    void finish();
+
+    void printStatistics();
+
+private:
+    std::vector<GLuint> buffers;
+    std::vector<GLsync> fences;
+    size_t bytesPerSlot;
+    int current;
+
+    // ͳϢ
+    TimeMeasurer timeMeasurer;
+    __int64 uploadStart;
+    __int64 uploadMicroSeconds; // mapfinishʱ, ύ
+    __int64 fenceWaitMicroSeconds; // еȴGPUݵʱ
+    long long uploadCount;
+};
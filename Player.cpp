@@ -1,4 +1,6 @@
 #include "Player.h"
+#include "yuvConverter.h"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <string>
@@ -10,6 +12,382 @@
 
 static const char* TEXTURE_UNIFORMS[] = { "y_tex", "u_tex", "v_tex" };
 
+// ˮие
+static const int PACKET_QUEUE_SIZE = 64;
+static const int DECODED_FRAME_QUEUE_SIZE = 4;
+
+// ģʽÿƬٰİ, Լÿȵ֡
+static const int BATCH_MIN_PACKETS_PER_SEGMENT = 30;
+static const int BATCH_BUFFERED_FRAMES_PER_DECODER = 16;
+
+// ϴPBOеPBO, 3㹻ÿ, DMAƻص
+static const int PIXEL_UNPACK_BUFFER_COUNT = 3;
+
+// ϴʱı߳(), Լ仯Ŀ鳬ʱΪ֡ϴ
+static const int DIRTY_TILE_SIZE = 64;
+static const double DIRTY_TILE_FULL_UPLOAD_FRACTION = 0.75;
+
+// ӿϴʱ, ӿֳôд, ÿ֡һ
+static const int VIEWPORT_BACKGROUND_FILL_FRAMES = 16;
+
+// ҳÿҳı߳(), ԼҳռõԴԤ(MB)
+static const int PAGED_TEXTURE_PAGE_SIZE = 1024;
+static const int PAGED_TEXTURE_BUDGET_MB = 512;
+
+// ֱдGLʱ, ֮֡֡, ڽеĲο֡֡߳
+static const int MAPPED_FRAME_EXTRA_REGIONS = 8;
+
+// ͶӰ׼ʱÿ֡ˮƽתĽǶ
+static const float BENCHMARK_DEGREES_PER_FRAME = 0.5f;
+
+// 3x2д, ϵÿλöӦcubemap
+static const GLenum CUBEMAP_FACES[6] = {
+    GL_TEXTURE_CUBE_MAP_POSITIVE_Z, GL_TEXTURE_CUBE_MAP_NEGATIVE_Z, GL_TEXTURE_CUBE_MAP_POSITIVE_Y,
+    GL_TEXTURE_CUBE_MAP_NEGATIVE_Y, GL_TEXTURE_CUBE_MAP_NEGATIVE_X, GL_TEXTURE_CUBE_MAP_POSITIVE_X
+};
+static const GLenum EAC_FACES[6] = {
+    GL_TEXTURE_CUBE_MAP_NEGATIVE_Z, GL_TEXTURE_CUBE_MAP_NEGATIVE_X, GL_TEXTURE_CUBE_MAP_POSITIVE_Z,
+    GL_TEXTURE_CUBE_MAP_NEGATIVE_Y, GL_TEXTURE_CUBE_MAP_POSITIVE_X, GL_TEXTURE_CUBE_MAP_POSITIVE_Y
+};
+
+// ͶӰ(-procedural 1), ֻһȫ; ɫMVP(Խmatrix)
+// ϵ߷, ԭ, ĻԲֵ; ƬԪɫٰѷӳ䵽֡
+static const char *PROCEDURAL_VERTEX_SHADER =
+    "#version 410 core\n"
+    "uniform mat4 matrix;\n"
+    "out vec3 rayDirection;\n"
+    "void main() {\n"
+    "   vec2 position = vec2(float((gl_VertexID & 1) << 2) - 1.0, float((gl_VertexID & 2) << 1) - 1.0);\n"
+    "   vec4 farPoint = matrix * vec4(position, 1.0, 1.0);\n"
+    "   rayDirection = farPoint.xyz / farPoint.w;\n"
+    "   gl_Position = vec4(position, 0.0, 1.0);\n"
+    "}\n";
+
+// ͶӰframeCoords: Ӧ񶥵ϵ깫ʽͬ, ֻÿƬԪϾȷ
+// ERP: ȴ+zת+x, γȴӱ, setupERPCoordinatesWithIndexͬ
+static const char *PROCEDURAL_ERP_FUNCTION =
+    "vec2 frameCoords(vec3 direction) {\n"
+    "   float longitude = atan(direction.x, direction.z);\n"
+    "   if (longitude < 0.0) {\n"
+    "       longitude += 6.28318531;\n"
+    "   }\n"
+    "   return vec2(longitude / 6.28318531, acos(clamp(direction.y, -1.0, 1.0)) / 3.14159265);\n"
+    "}\n";
+
+// CPP: setupCppEqualDistanceCoordinatesͬ, frameAspectΪ֡ĸ߿
+static const char *PROCEDURAL_CPP_FUNCTION =
+    "uniform float frameAspect;\n"
+    "vec2 frameCoords(vec3 direction) {\n"
+    "   float latitude = asin(clamp(direction.y, -1.0, 1.0));\n"
+    "   float longitude = atan(-direction.x, -direction.z);\n"
+    "   return vec2(0.5 + longitude / 3.14159265 * frameAspect * (2.0 * cos(2.0 * latitude / 3.0) - 1.0), 0.5 - sin(latitude / 3.0));\n"
+    "}\n";
+
+// TSP: ͶӰs, t, ٰcalculateTSPTextureCoordinatesи˫Թʽ
+static const char *PROCEDURAL_TSP_FUNCTION =
+    "vec2 frameCoords(vec3 direction) {\n"
+    "   vec3 a = abs(direction);\n"
+    "   vec3 p = direction / max(a.x, max(a.y, a.z));\n"
+    "   float s;\n"
+    "   float t;\n"
+    "   vec2 uv;\n"
+    "   if (a.z >= a.x && a.z >= a.y) {\n"
+    "       t = (p.y + 1.0) * 0.5;\n"
+    "       if (direction.z > 0.0) {\n"
+    "           s = (p.x + 1.0) * 0.5;\n"
+    "           uv = vec2(s * 0.5, t);\n"
+    "       } else {\n"
+    "           s = (1.0 - p.x) * 0.5;\n"
+    "           uv = vec2(0.125 * s + 0.6875, 0.25 * t + 0.375);\n"
+    "       }\n"
+    "   } else if (a.y >= a.x) {\n"
+    "       s = (p.x + 1.0) * 0.5;\n"
+    "       if (direction.y > 0.0) {\n"
+    "           t = (1.0 - p.z) * 0.5;\n"
+    "           uv = vec2(1.0 - 0.1875 * t - 0.5 * s + 0.375 * s * t, 1.0 - 0.375 * t);\n"
+    "       } else {\n"
+    "           t = (p.z + 1.0) * 0.5;\n"
+    "           uv = vec2(0.1875 * t - 0.375 * s * t - 0.125 * s + 0.8125, 0.375 - 0.375 * t);\n"
+    "       }\n"
+    "   } else {\n"
+    "       t = (p.y + 1.0) * 0.5;\n"
+    "       if (direction.x > 0.0) {\n"
+    "           s = (1.0 - p.z) * 0.5;\n"
+    "           uv = vec2(0.1875 * s + 0.5, 0.375 * s - 0.75 * s * t + t);\n"
+    "       } else {\n"
+    "           s = (p.z + 1.0) * 0.5;\n"
+    "           uv = vec2(0.1875 * s + 0.8125, 0.25 * t + 0.75 * s * t - 0.375 * s + 0.375);\n"
+    "       }\n"
+    "   }\n"
+    "   return vec2(uv.x, 1.0 - uv.y);\n"
+    "}\n";
+
+// Cubemap/EAC/ACP: ϵcubemapǶλ, ֻм水֡ת
+static const char *PROCEDURAL_CUBEMAP_FUNCTION =
+    "vec3 frameCoords(vec3 direction) {\n"
+    "   vec3 a = abs(direction);\n"
+    "   if (a.y > a.x && a.y > a.z) {\n"
+    "       return vec3(direction.z, direction.y, -direction.x);\n"
+    "   }\n"
+    "   return direction;\n"
+    "}\n";
+static const char *PROCEDURAL_EAC_FUNCTION =
+    "vec3 frameCoords(vec3 direction) {\n"
+    "   vec3 a = abs(direction);\n"
+    "   if (direction.x > 0.0 && a.x >= a.y && a.x >= a.z) {\n"
+    "       return vec3(direction.x, direction.z, -direction.y);\n"
+    "   }\n"
+    "   if (direction.y > 0.0 && a.y > a.x && a.y >= a.z) {\n"
+    "       return vec3(-direction.x, direction.y, -direction.z);\n"
+    "   }\n"
+    "   return direction;\n"
+    "}\n";
+static const char *PROCEDURAL_ACP_FUNCTION =
+    "vec3 frameCoords(vec3 direction) {\n"
+    "   return direction;\n"
+    "}\n";
+
+/**
+* ͶӰʽɳͶӰƬԪɫ, ͶӰһֻͨsampleScene,
+* ͼ, ҳ, YUVYCoCgsceneSamplingFunctionsṩ; ֵ֧ͶӰؿմ
+*/
+static std::string proceduralFragmentShader(ProjectionMode projectionMode) {
+    const char *function = NULL;
+    bool cube = false;
+    switch (projectionMode) {
+    case PM_ERP:
+        function = PROCEDURAL_ERP_FUNCTION;
+        break;
+    case PM_CPP:
+        function = PROCEDURAL_CPP_FUNCTION;
+        break;
+    case PM_TSP:
+        function = PROCEDURAL_TSP_FUNCTION;
+        break;
+    case PM_CUBEMAP:
+        function = PROCEDURAL_CUBEMAP_FUNCTION;
+        cube = true;
+        break;
+    case PM_EAC:
+        function = PROCEDURAL_EAC_FUNCTION;
+        cube = true;
+        break;
+    case PM_ACP:
+        function = PROCEDURAL_ACP_FUNCTION;
+        cube = true;
+        break;
+    default:
+        return std::string();
+    }
+    std::string shader =
+        "in vec3 rayDirection;\n"
+        "out vec4 outputColor;\n";
+    shader += function;
+    if (cube) {
+        shader +=
+            "void main() {\n"
+            "   vec3 coords = frameCoords(rayDirection);\n"
+            "   outputColor = sampleScene(coords);\n"
+            "}\n";
+    } else {
+        shader +=
+            "void main() {\n"
+            "   vec2 coords = frameCoords(normalize(rayDirection));\n"
+            "   outputColor = sampleScene(coords);\n"
+            "}\n";
+    }
+    return shader;
+}
+
+// ͼģʽ°OpenGLѡcubemapĹ, atlasCells[]3x2еλ
+// հΪ, ˫Թ˲ȡͼڵһ
+static const char *CUBE_ATLAS_FUNCTION =
+    "uniform int atlasCells[6];\n"
+    "vec4 sampleAtlas(sampler2D atlas, vec3 direction) {\n"
+    "   vec3 a = abs(direction);\n"
+    "   int face;\n"
+    "   float ma;\n"
+    "   vec2 st;\n"
+    "   if (a.x >= a.y && a.x >= a.z) {\n"
+    "       face = direction.x > 0.0 ? 0 : 1;\n"
+    "       ma = a.x;\n"
+    "       st = vec2(direction.x > 0.0 ? -direction.z : direction.z, -direction.y);\n"
+    "   } else if (a.y >= a.z) {\n"
+    "       face = direction.y > 0.0 ? 2 : 3;\n"
+    "       ma = a.y;\n"
+    "       st = vec2(direction.x, direction.y > 0.0 ? direction.z : -direction.z);\n"
+    "   } else {\n"
+    "       face = direction.z > 0.0 ? 4 : 5;\n"
+    "       ma = a.z;\n"
+    "       st = vec2(direction.z > 0.0 ? direction.x : -direction.x, -direction.y);\n"
+    "   }\n"
+    "   float guard = 0.5 / float(textureSize(atlas, 0).y / 2);\n"
+    "   st = clamp(st / ma * 0.5 + 0.5, guard, 1.0 - guard);\n"
+    "   int cell = atlasCells[face];\n"
+    "   return texture(atlas, vec2((float(cell % 3) + st.x) / 3.0, (float(cell / 3) + st.y) / 2.0));\n"
+    "}\n";
+
+// ҳģʽȲҳõuvҳĲ, ڸòв; ܸ1صı߿, ҳӱ߿֮ʼ
+// פҳʾΪɫ, RGBYUV(ת)ԵĻ
+static const char *PAGED_TEXTURE_FUNCTION =
+    "uniform isampler2D pageTable;\n"
+    "uniform vec2 pagesPerFrame;\n"
+    "vec4 samplePaged(sampler2DArray pages, vec2 uv) {\n"
+    "   vec2 pageCoords = uv * pagesPerFrame;\n"
+    "   ivec2 page = clamp(ivec2(pageCoords), ivec2(0), textureSize(pageTable, 0) - 1);\n"
+    "   int layer = texelFetch(pageTable, page, 0).r;\n"
+    "   if (layer < 0) {\n"
+    "       return vec4(0.5, 0.5, 0.5, 1.0);\n"
+    "   }\n"
+    "   vec2 layerSize = vec2(textureSize(pages, 0).xy);\n"
+    "   vec2 texel = (pageCoords - vec2(page)) * (layerSize - 2.0) + 1.0;\n"
+    "   return texture(pages, vec3(texel / layerSize, float(layer)));\n"
+    "}\n";
+
+// Ĵ洢ʽ, sampleSceneĲ, 
+enum SceneTextureStorage {
+    STS_2D,
+    STS_CUBEMAP,
+    STS_CUBE_ATLAS,
+    STS_PAGED
+};
+
+// sampleSceneģеSAMPLER, COORDSFETCHsceneSamplingFunctionsʵʵĲ, 
+// RGBģʽֱӴmytexture
+static const char *RGB_SAMPLE_FUNCTION =
+    "uniform SAMPLER mytexture;\n"
+    "vec4 sampleScene(COORDS coords) {\n"
+    "   return FETCH(mytexture, coords);\n"
+    "}\n";
+
+// DXTļΪYCoCg-DXT5ʱѲŵYCoCgתRGB, dxtYCoCgǷת
+static const char *YCOCG_SAMPLE_FUNCTION =
+    "uniform SAMPLER mytexture;\n"
+    "uniform bool dxtYCoCg;\n"
+    "vec4 sampleScene(COORDS coords) {\n"
+    "   vec4 color = FETCH(mytexture, coords);\n"
+    "   if (!dxtYCoCg) {\n"
+    "       return color;\n"
+    "   }\n"
+    "   float scale = color.b * (255.0 / 8.0) + 1.0;\n"
+    "   float co = (color.r - 128.0 / 255.0) / scale;\n"
+    "   float cg = (color.g - 128.0 / 255.0) / scale;\n"
+    "   return vec4(color.a + co - cg, color.a + cg, color.a - co - cg, 1.0);\n"
+    "}\n";
+
+// YUVģʽ´ӸƽתRGB
+static const char *YUV_SAMPLE_FUNCTION =
+    "uniform SAMPLER y_tex;\n"
+    "uniform SAMPLER u_tex;\n"
+    "uniform SAMPLER v_tex;\n"
+    "uniform bool yuvNV12;\n"
+    "vec4 sampleScene(COORDS coords) {\n"
+    "   float y = 1.164 * (FETCH(y_tex, coords).r - 0.0625);\n"
+    "   vec2 uv = yuvNV12 ? FETCH(u_tex, coords).rg : vec2(FETCH(u_tex, coords).r, FETCH(v_tex, coords).r);\n"
+    "   uv -= 0.5;\n"
+    "   return vec4(y + 1.596 * uv.y, y - 0.391 * uv.x - 0.813 * uv.y, y + 2.018 * uv.x, 1.0);\n"
+    "}\n";
+
+static void replaceAll(std::string &text, const std::string &from, const std::string &to) {
+    for (size_t position = text.find(from); position != std::string::npos; position = text.find(from, position + to.length())) {
+        text.replace(position, from.length(), to);
+    }
+}
+
+/**
+* ƬԪɫsampleScene(coords), ͶӰɫֻsampleScene, δ洢ת
+* ͼҳȶλڵҳٲ; YCoCgֻRGB(DXTļ)
+*/
+static std::string sceneSamplingFunctions(SceneTextureStorage storage, bool yuv, bool ycocg) {
+    std::string result;
+    const char *sampler = "sampler2D";
+    const char *coords = "vec2";
+    const char *fetch = "texture(";
+    if (storage == STS_CUBEMAP) {
+        sampler = "samplerCube";
+        coords = "vec3";
+    } else if (storage == STS_CUBE_ATLAS) {
+        coords = "vec3";
+        fetch = "sampleAtlas(";
+        result += CUBE_ATLAS_FUNCTION;
+    } else if (storage == STS_PAGED) {
+        sampler = "sampler2DArray";
+        fetch = "samplePaged(";
+        result += PAGED_TEXTURE_FUNCTION;
+    }
+    std::string function = yuv ? YUV_SAMPLE_FUNCTION : (ycocg ? YCOCG_SAMPLE_FUNCTION : RGB_SAMPLE_FUNCTION);
+    replaceAll(function, "SAMPLER", sampler);
+    replaceAll(function, "COORDS", coords);
+    replaceAll(function, "FETCH(", fetch);
+    return result + function;
+}
+
+/**
+* bandûбregionsоθǵĲ׷ӵregionsĩβ, еľλص
+* оε±߰bandгд, ÿдڵľζдĸ߶, ȡxϵĿ϶;
+* һдĿ϶Χͬʱºϲ, ϴ
+*/
+static void appendUncoveredRegions(const TextureRegion &band, std::vector<TextureRegion> &regions) {
+    size_t coveredCount = regions.size();
+    std::vector<int> cuts;
+    cuts.push_back(band.y);
+    cuts.push_back(band.y + band.height);
+    for (size_t i = 0; i < coveredCount; i++) {
+        const TextureRegion &region = regions[i];
+        if (region.y > band.y && region.y < band.y + band.height) {
+            cuts.push_back(region.y);
+        }
+        if (region.y + region.height > band.y && region.y + region.height < band.y + band.height) {
+            cuts.push_back(region.y + region.height);
+        }
+    }
+    std::sort(cuts.begin(), cuts.end());
+    cuts.erase(std::unique(cuts.begin(), cuts.end()), cuts.end());
+
+    std::vector<std::pair<int, int> > covered;
+    for (size_t c = 0; c + 1 < cuts.size(); c++) {
+        int top = cuts[c];
+        int bottom = cuts[c + 1];
+        covered.clear();
+        for (size_t i = 0; i < coveredCount; i++) {
+            const TextureRegion &region = regions[i];
+            if (region.y <= top && region.y + region.height >= bottom) {
+                covered.push_back(std::make_pair(region.x, region.x + region.width));
+            }
+        }
+        std::sort(covered.begin(), covered.end());
+        int x = band.x;
+        for (size_t i = 0; i <= covered.size(); i++) {
+            int gapEnd = i < covered.size() ? covered[i].first : band.x + band.width;
+            if (gapEnd > band.x + band.width) {
+                gapEnd = band.x + band.width;
+            }
+            if (gapEnd > x) {
+                TextureRegion gap;
+                gap.x = x;
+                gap.y = top;
+                gap.width = gapEnd - x;
+                gap.height = bottom - top;
+                bool merged = false;
+                for (size_t j = coveredCount; j < regions.size(); j++) {
+                    TextureRegion &previous = regions[j];
+                    if (previous.x == gap.x && previous.width == gap.width && previous.y + previous.height == top) {
+                        previous.height += gap.height;
+                        merged = true;
+                        break;
+                    }
+                }
+                if (!merged) {
+                    regions.push_back(gap);
+                }
+            }
+            if (i < covered.size() && covered[i].second > x) {
+                x = covered[i].second;
+            }
+        }
+    }
+}
+
 void addShader(int type, const char * source, int program) {
 	int shader = glCreateShader(type);
 	glShaderSource(shader, 1, &source, NULL);
@@ -35,9 +413,18 @@ namespace Player {
         vertexArray(NULL),
         uvArray(NULL),
         indexArray(NULL) {
+        pthread_mutex_init(&viewportLock, NULL);
+        // ڹ캯гʼ, ȲsetupThreadͷصģʽʱͬ; ߳ʱҲѾ
+        sem_init(&decodeOneFrameFinishedSemaphore, 0, 0);
+        sem_init(&decodeAllFramesFinishedSemaphore, 0, 0);
+        sem_init(&renderFinishedSemaphore, 0, 1);
+        pthread_mutex_init(&lock, NULL);
         parseArguments(argc, argv);
         
-        init();
+        // , DXTת׼ģʽҪںGL
+        if (!isBatchMode() && !isDxtConvertMode() && !isYuvConverterBenchmark() && !isMeshBuilderBenchmark()) {
+            init();
+        }
 
 
     }
@@ -68,6 +455,19 @@ namespace Player {
 			decodedYUVBuffer = NULL;
 		}
 
+		if (yuvSource != NULL) {
+			delete yuvSource;
+			yuvSource = NULL;
+		}
+		if (partialYUVReader != NULL) {
+			delete partialYUVReader;
+			partialYUVReader = NULL;
+		}
+		if (erpViewport != NULL) {
+			delete erpViewport;
+			erpViewport = NULL;
+		}
+		pthread_mutex_destroy(&viewportLock);
 		if (videoFileInputStream.is_open()) {
 			videoFileInputStream.close();
 		}
@@ -77,10 +477,6 @@ namespace Player {
             compressedTextureBuffer = NULL;
         }
 
-        if (decodedRGBABuffer != NULL) {
-            delete[] decodedRGBABuffer;
-            decodedRGBABuffer = NULL;
-        }
 
 		if (cudaRGBABuffer != NULL) {
 			cudaFree(cudaRGBABuffer);
@@ -91,13 +487,66 @@ namespace Player {
 			delete pNVDecoder;
 			pNVDecoder = NULL;
 		}
-        if (faceBufferOne) {
-            free(faceBufferOne);
-            faceBufferOne = NULL;
+        if (frameRing != NULL) {
+            delete frameRing;
+            frameRing = NULL;
+        }
+        if (frameCache != NULL) {
+            delete frameCache;
+            frameCache = NULL;
+        }
+        if (slicedScaler != NULL) {
+            delete slicedScaler;
+            slicedScaler = NULL;
+        }
+        if (tileHasher != NULL) {
+            delete tileHasher;
+            tileHasher = NULL;
+        }
+        if (workerPool != NULL) {
+            delete workerPool;
+            workerPool = NULL;
+        }
+        if (batchSwsContext != NULL) {
+            sws_freeContext(batchSwsContext);
+            batchSwsContext = NULL;
+        }
+        if (batchYUVBuffer != NULL) {
+            av_free(batchYUVBuffer);
+            batchYUVBuffer = NULL;
+        }
+        if (dxtWriter != NULL) {
+            delete dxtWriter;
+            dxtWriter = NULL;
+        }
+        if (dxtEncoder != NULL) {
+            delete dxtEncoder;
+            dxtEncoder = NULL;
+        }
+        if (dxtSwsContext != NULL) {
+            sws_freeContext(dxtSwsContext);
+            dxtSwsContext = NULL;
+        }
+        if (dxtRGBABuffer != NULL) {
+            av_free(dxtRGBABuffer);
+            dxtRGBABuffer = NULL;
+        }
+        if (dxtBlockBuffer != NULL) {
+            av_free(dxtBlockBuffer);
+            dxtBlockBuffer = NULL;
+        }
+        if (dxtSource != NULL) {
+            delete dxtSource;
+            dxtSource = NULL;
         }
 
 		destroyGL();
 		destroyCodec();
+		// ֡ͷ֮֡ɾ
+		if (mappedFramePool != NULL) {
+			delete mappedFramePool;
+			mappedFramePool = NULL;
+		}
 		destoryThread();
 		SDL_Quit();
 	}
@@ -130,12 +579,33 @@ namespace Player {
 
     // proj: 0-ERP, 1-CPP_Obsolete, 2-Cubemap, 3-Cpp, 4-Notspecial
     // draw: 0-useIndex, 1-dontUseIndex
-    // type: 0-yuv, 1-encoded
+    // type: 0-yuv, 1-encoded, 2-dxt
     // decode: 0-software, 1-hardware
-    // -patch 200 -video D:\\WangZewei\\360Video\\VRTest_1920_960.mp4 -output 200.png -proj 0 -draw 0 -dt 0 -type 1 -w 1920 -h 960 -repeat 0 -yuv 0
+    // yuv: 1-ϴYUVƽ沢ɫתRGB(ͶӰ֧), 0-CPUתRGBA/BGRAϴ
+    // ring: ߳Ⱦ֮߳֡вλ
+    // slices: RGBģʽ²ת߳, 0ʾCPU
+    // clock: 0-ʾʱŲ֡, 1-ȴҲ֡, ڲ֡
+    // fps: YUVļ֡
+    // cache: repeatģʽ½֡ڴԤ(MB), 0ʾ; lz4: 1-LZ4ѹ֡
+    // partial: 1-ERPʽYUVļֻȡϴӿڵ
+    // batch: ģʽ²нĸ, 0ʾ; batchout: YUV420Pļ, ʡ
+    // dxtout: -videoתDXTļ˳, ; dxtformat: 0-DXT1, 1-YCoCg-DXT5; dxtquality: 0-, 1-
+    // projbench: 1-ͶӰ׼, ȴʾʱת
+    // yuvbench: 1-ֻYUV420PתRGB24, CpuKernelsDXTѹʵֵٶ, slicesָ߳
+    // bgra: RGBģʽϴʽ, 1-GL_BGRA, 0-GL_RGBA
+    // kernels: 0-CUDA豸ʱCUDA, CPU, 1-CUDA, 2-CPU; CPUʱӲΪ, RGBģʽYUV420P, NV12P010֡CpuKernelsɫʿռת
+    // mapped: 1-ֱӰYUV420P֡뵽־ӳGL
+    // atlas: 1-Cubemap/EAC/ACP֡ϴһ2Dͼ, 0-ϴcubemap
+    // dirty: 1-֡ݵĹϣ, ֻϴһϴȱ仯Ŀ
+    // viewport: 1-ERPֻϴӿڵ, ӿ֮֡з
+    // procedural: 1-, ƬԪɫа߷ؼͶӰ֡, patch޹
+    // pages: 1-ERP/TSP֡ҳ, ERPֻӿڵҳפ; ֡GL_MAX_TEXTURE_SIZEʱԶ
+    // pbo: 1-֡PBO첽ϴ, 0-ֱӴڴϴ
+    // meshbench: 1-ֻERP-patch 648192µʱ, slicesָ߳
+    // -patch 200 -video D:\\WangZewei\\360Video\\VRTest_1920_960.mp4 -output 200.png -proj 0 -draw 0 -dt 0 -type 1 -w 1920 -h 960 -repeat 0 -yuv 0 -ring 4 -slices 0 -clock 0 -fps 30 -cache 1024 -lz4 0 -partial 0 -batch 0 -batchout out.yuv -dxtout out.dxt -dxtformat 0 -dxtquality 0 -projbench 0 -yuvbench 0 -bgra 1 -kernels 0 -pbo 1 -mapped 1 -atlas 1 -dirty 0 -viewport 0 -pages 0 -procedural 0 -meshbench 0
     void Player::parseArguments(int argc, char ** argv) {
         if (!stricmp(argv[1], "-h") || !stricmp(argv[1], "-help")) {
-            std::cout << "Arguments Format:\n-patch 200 -video D:\\WangZewei\\360Video\\VRTest_1920_960.mp4 -output 200.png -proj 0 -draw 0 -decode 0 -type 0 -w 1920 -h 960 -repeat 0 -yuv 0\n";
+            std::cout << "Arguments Format:\n-patch 200 -video D:\\WangZewei\\360Video\\VRTest_1920_960.mp4 -output 200.png -proj 0 -draw 0 -decode 0 -type 0 -w 1920 -h 960 -repeat 0 -yuv 0 -ring 4 -slices 0 -clock 0 -fps 30 -cache 1024 -lz4 0 -partial 0 -batch 0 -batchout out.yuv -dxtout out.dxt -dxtformat 0 -dxtquality 0 -projbench 0 -yuvbench 0 -bgra 1 -kernels 0 -pbo 1 -mapped 1 -atlas 1 -dirty 0 -viewport 0 -pages 0 -procedural 0 -meshbench 0\n";
         } else {
             {
                 for (int i = 1; i < argc; i += 2) {
@@ -161,15 +631,83 @@ namespace Player {
                         this->repeatRendering = (atoi(argv[i + 1]) == 0 ? false : true);
                     } else if (!stricmp(argv[i], "-yuv")) {
                         this->renderYUV = (atoi(argv[i + 1]) == 0 ? false : true);
+                    } else if (!stricmp(argv[i], "-ring")) {
+                        this->frameRingSize = atoi(argv[i + 1]);
+                        if (this->frameRingSize < 1) {
+                            this->frameRingSize = 1;
+                        }
+                    } else if (!stricmp(argv[i], "-slices")) {
+                        this->sliceCount = atoi(argv[i + 1]);
+                    } else if (!stricmp(argv[i], "-clock")) {
+                        this->clockMode = (ClockMode)atoi(argv[i + 1]);
+                    } else if (!stricmp(argv[i], "-fps")) {
+                        this->yuvFrameRate = atof(argv[i + 1]);
+                        if (this->yuvFrameRate <= 0) {
+                            this->yuvFrameRate = 30;
+                        }
+                    } else if (!stricmp(argv[i], "-cache")) {
+                        this->frameCacheBudgetMB = atoi(argv[i + 1]);
+                    } else if (!stricmp(argv[i], "-lz4")) {
+                        this->frameCacheCompress = (atoi(argv[i + 1]) == 0 ? false : true);
+                    } else if (!stricmp(argv[i], "-partial")) {
+                        this->partialYUVRead = (atoi(argv[i + 1]) == 0 ? false : true);
+                    } else if (!stricmp(argv[i], "-batch")) {
+                        this->batchDecoderCount = atoi(argv[i + 1]);
+                    } else if (!stricmp(argv[i], "-batchout")) {
+                        this->batchOutputFileName = argv[i + 1];
+                    } else if (!stricmp(argv[i], "-dxtout")) {
+                        this->dxtOutputFileName = argv[i + 1];
+                    } else if (!stricmp(argv[i], "-dxtformat")) {
+                        this->dxtFormat = (atoi(argv[i + 1]) == 0 ? DXT_FORMAT_DXT1 : DXT_FORMAT_YCOCG_DXT5);
+                    } else if (!stricmp(argv[i], "-dxtquality")) {
+                        this->dxtQuality = (atoi(argv[i + 1]) == 0 ? DXT_QUALITY_HIGH : DXT_QUALITY_FAST);
+                    } else if (!stricmp(argv[i], "-projbench")) {
+                        this->projectionBenchmark = (atoi(argv[i + 1]) == 0 ? false : true);
+                    } else if (!stricmp(argv[i], "-yuvbench")) {
+                        this->yuvConverterBenchmark = (atoi(argv[i + 1]) == 0 ? false : true);
+                    } else if (!stricmp(argv[i], "-bgra")) {
+                        this->uploadBGRA = (atoi(argv[i + 1]) == 0 ? false : true);
+                    } else if (!stricmp(argv[i], "-pbo")) {
+                        this->pixelUnpackBuffers = (atoi(argv[i + 1]) == 0 ? false : true);
+                    } else if (!stricmp(argv[i], "-mapped")) {
+                        this->mappedDecoderFrames = (atoi(argv[i + 1]) == 0 ? false : true);
+                    } else if (!stricmp(argv[i], "-atlas")) {
+                        this->cubeAtlas = (atoi(argv[i + 1]) == 0 ? false : true);
+                    } else if (!stricmp(argv[i], "-dirty")) {
+                        this->dirtyTileUploads = (atoi(argv[i + 1]) == 0 ? false : true);
+                    } else if (!stricmp(argv[i], "-viewport")) {
+                        this->viewportUploads = (atoi(argv[i + 1]) == 0 ? false : true);
+                    } else if (!stricmp(argv[i], "-pages")) {
+                        this->pagedTextures = (atoi(argv[i + 1]) == 0 ? false : true);
+                    } else if (!stricmp(argv[i], "-procedural")) {
+                        this->proceduralProjection = (atoi(argv[i + 1]) == 0 ? false : true);
+                    } else if (!stricmp(argv[i], "-meshbench")) {
+                        this->meshBuilderBenchmark = (atoi(argv[i + 1]) == 0 ? false : true);
+                    } else if (!stricmp(argv[i], "-kernels")) {
+                        int device = atoi(argv[i + 1]);
+                        this->kernelDevice = (device == 1 ? CpuKernels::KD_CUDA : (device == 2 ? CpuKernels::KD_CPU : CpuKernels::KD_AUTO));
                     }
                 }
             }
 
-            if (this->projectionMode == PM_EAC || this->projectionMode == PM_ACP || this->projectionMode == PM_CUBEMAP) {
-                int width = this->videoFrameWidth / 3;
-                this->faceBufferOne = (uint8_t *)malloc(sizeof(uint8_t)*width*width * 3);
-                this->faceBufferTwo = (uint8_t *)malloc(sizeof(uint8_t)*width*width * 3);
+            // DXTļѹRGB(A), ɫinitд, Ҫȷ
+            if (this->videoFileType == VFT_DXT) {
+                this->renderYUV = false;
+            }
+            if (this->projectionBenchmark) {
+                this->clockMode = CM_AS_FAST_AS_POSSIBLE;
             }
+            // ӲCUDANV12תRGBA, ûCUDA豸ָCPUʱΪ
+            if (this->decodeType == DT_HARDWARE && CpuKernels::resolveKernelDevice(this->kernelDevice) == CpuKernels::KD_CPU) {
+                std::cout << "No CUDA device selected, falling back to software decoding" << std::endl;
+                this->decodeType = DT_SOFTWARE;
+            }
+            // ӲCUDAֱRGBA
+            if (this->decodeType == DT_HARDWARE) {
+                this->renderYUV = false;
+            }
+            // ֻ֮CUDACPU, convertToRGBѡתʵ
+            this->kernelDevice = CpuKernels::resolveKernelDevice(this->kernelDevice);
         }
     }
 
@@ -238,6 +776,7 @@ namespace Player {
             return false;
         }
 
+        setupPagedTextureMode();
         setupShaders();
         setupCoordinates();
         setupTexture();
@@ -283,6 +822,21 @@ namespace Player {
                     return false; // Codec not found
                 }
 
+                // ֡ɵ߳, Ⱦֱ߳̿ӴӽĻϴ
+                pCodecContext->refcounted_frames = 1;
+                // ʱýֱдGL, ϴʱپCPU; ʽʱԶ˻FFmpegķ
+                if (mappedDecoderFrames && !isDxtConvertMode() && !isBatchMode() && (pCodec->capabilities & CODEC_CAP_DR1)) {
+                    mappedFramePool = new MappedFramePool();
+                    if (mappedFramePool->init(pCodecContext, frameRingSize + MAPPED_FRAME_EXTRA_REGIONS)) {
+                        pCodecContext->opaque = mappedFramePool;
+                        pCodecContext->get_buffer2 = MappedFramePool::getBuffer2;
+                        pCodecContext->thread_safe_callbacks = 1;
+                    } else {
+                        delete mappedFramePool;
+                        mappedFramePool = NULL;
+                    }
+                }
+
                 if (avcodec_open2(pCodecContext, pCodec, NULL) < 0) {
                     return false;
                 }
@@ -295,13 +849,21 @@ namespace Player {
                 av_init_packet(&packet);
 
                 numberOfBytesPerFrame = avpicture_get_size(AV_PIX_FMT_YUV420P, pCodecContext->width, pCodecContext->height);
-                decodedYUVBuffer = (uint8_t *)av_malloc(numberOfBytesPerFrame * sizeof(uint8_t));
-                if (decodedYUVBuffer == NULL) {
-                    std::cout << "Failed to malloc for decodedYUVBuffer" << std::endl;
-                    return false;
-                }
 
-                avpicture_fill((AVPicture *)pFrame, decodedYUVBuffer, AV_PIX_FMT_YUV420P, pCodecContext->width, pCodecContext->height);
+                // setupTextureYUV420Pƽ, NV12ʱɫƽ´
+                // batchdxtoutģʽGL, ҲûҪؽ
+                YuvChromaLayout chromaLayout;
+                if (yuvChromaLayout(pCodecContext->pix_fmt, &chromaLayout) && chromaLayout != yuvFrameLayout) {
+                    yuvFrameLayout = chromaLayout;
+                    if (!isBatchMode() && !isDxtConvertMode()) {
+                        if (pagedTexture != NULL) {
+                            pagedTexture->release();
+                        } else {
+                            glDeleteTextures(3, yuvTexturesID);
+                        }
+                        setupTexture();
+                    }
+                }
 
             } else {
                 pCodecContextOriginal = pFormatContext->streams[videoStreamIndex]->codec;
@@ -317,6 +879,9 @@ namespace Player {
                     return false; // Error copying codec context
                 }
 
+                // ֡ƽת߳, ɵ߳, һν벻Ḳת̻߳ڶȡĻ
+                pCodecContext->refcounted_frames = 1;
+
                 // Open codec
                 if (avcodec_open2(pCodecContext, pCodec, NULL) < 0) {
                     return false; // Could not open codec
@@ -337,7 +902,8 @@ namespace Player {
 
                 //numberOfBytesPerFrame = avpicture_get_size(AV_PIX_FMT_YUV420P, pCodecContext->width, pCodecContext->height);
 
-                numberOfBytesPerFrame = avpicture_get_size(AV_PIX_FMT_RGB24,
+                // RGBA/BGRAÿ4ֽ, Ȼ4ֽڶ
+                numberOfBytesPerFrame = avpicture_get_size(AV_PIX_FMT_RGBA,
                     pCodecContext->width, pCodecContext->height);
                 decodedRGB24Buffer = (uint8_t *)av_malloc(numberOfBytesPerFrame * sizeof(uint8_t));
                 if (decodedRGB24Buffer == NULL) {
@@ -346,9 +912,39 @@ namespace Player {
                 }
 
 
-                avpicture_fill((AVPicture *)pFrameRGB, decodedRGB24Buffer, AV_PIX_FMT_RGB24, pCodecContext->width, pCodecContext->height);
+                AVPixelFormat rgbPixelFormat = uploadBGRA ? AV_PIX_FMT_BGRA : AV_PIX_FMT_RGBA;
+                avpicture_fill((AVPicture *)pFrameRGB, decodedRGB24Buffer, rgbPixelFormat, pCodecContext->width, pCodecContext->height);
+
+                swsContext = sws_getContext(pCodecContext->width, pCodecContext->height, pCodecContext->pix_fmt, pCodecContext->width, pCodecContext->height, rgbPixelFormat, SWS_BILINEAR, NULL, NULL, NULL);
+
+                if (sliceCount <= 0) {
+                    sliceCount = ThreadPool::hardwareThreadCount();
+                }
+                // ERPʱѾ
+                if (workerPool == NULL) {
+                    workerPool = new ThreadPool(sliceCount);
+                }
+                slicedScaler = new SlicedScaler(workerPool);
+                if (!slicedScaler->init(pCodecContext->width, pCodecContext->height, pCodecContext->pix_fmt, rgbPixelFormat, sliceCount, SWS_BILINEAR)) {
+                    std::cout << "Failed to init slicedScaler" << std::endl;
+                    return false;
+                }
+            }
+
+            AVStream *videoStream = pFormatContext->streams[videoStreamIndex];
+            AVRational frameRate = videoStream->avg_frame_rate.num > 0 ? videoStream->avg_frame_rate : videoStream->r_frame_rate;
+            presentationClock.setup(av_q2d(videoStream->time_base), frameRate.num > 0 ? 1.0 / av_q2d(frameRate) : 0, clockMode);
+
+            if (this->repeatRendering && frameCacheBudgetMB > 0) {
+                frameCache = new FrameCache((long long)frameCacheBudgetMB * 1024 * 1024, frameCacheCompress);
+            }
 
-                swsContext = sws_getContext(pCodecContext->width, pCodecContext->height, pCodecContext->pix_fmt, pCodecContext->width, pCodecContext->height, AV_PIX_FMT_RGB24, SWS_BILINEAR, NULL, NULL, NULL);
+            // YUVģʽ²λֻAVFrame, ҪԤ仺, ҪѹĻнѹ֡
+            bool needsSlotBuffer = !this->renderYUV || (frameCache != NULL && frameCache->isCompressed());
+            frameRing = new FrameRing();
+            if (!frameRing->init(frameRingSize, needsSlotBuffer ? numberOfBytesPerFrame : 0)) {
+                std::cout << "Failed to init frameRing" << std::endl;
+                return false;
             }
 			return true;
 		} else if (videoFileType == VFT_Encoded && decodeType == DT_HARDWARE) {
@@ -389,16 +985,76 @@ namespace Player {
 
 			return true;
 		} else if (videoFileType == VFT_YUV) {
-			this->videoFileInputStream.open(videoFileName, std::ios::binary | std::ios::in);
-
 			assert(this->videoFrameWidth != 0 && this->videoFrameHeight != 0);
+
+			if (partialYUVRead && (this->projectionMode != PM_ERP || !this->renderYUV)) {
+				std::cout << "Partial YUV reading only supports ERP rendered as YUV, reading whole frames" << std::endl;
+				partialYUVRead = false;
+			}
+			if (partialYUVRead) {
+				partialYUVReader = new PartialYUVReader();
+				if (!partialYUVReader->open(videoFileName, this->videoFrameWidth, this->videoFrameHeight)) {
+					return false;
+				}
+				erpViewport = new ErpViewport(this->videoFrameWidth, this->videoFrameHeight);
+				updateVisibleRegions();
+			}
+
+			// ʹڴӳ, ӳʧʱ(32λ̴򿪺ܴļ)˻ص֡ȡ
+			yuvSource = partialYUVRead ? NULL : new MappedYUVSource();
+			if (yuvSource != NULL && !yuvSource->open(videoFileName, this->videoFrameWidth, this->videoFrameHeight)) {
+				delete yuvSource;
+				yuvSource = NULL;
+			}
+			if (yuvSource == NULL && partialYUVReader == NULL) {
+				this->videoFileInputStream.open(videoFileName, std::ios::binary | std::ios::in);
+			}
+
 			//this->decodedYUVBuffer = new uint8_t[this->videoFrameWidth*this->videoFrameHeight * 3 / 2];
             decodedYUVBuffer = (uint8_t *)av_malloc(this->videoFrameWidth*this->videoFrameHeight*3/2 * sizeof(uint8_t));
 			if (this->decodedYUVBuffer == NULL) {
 				return false;
-			} else {
-				return true;
 			}
+
+            numberOfBytesPerFrame = this->videoFrameWidth * this->videoFrameHeight * 3 / 2;
+            // YUVļеĵi֡ʾʱi
+            presentationClock.setup(1.0 / yuvFrameRate, 1.0 / yuvFrameRate, clockMode);
+            // ڴӳʱλֱָļ, Ҫ
+            frameRing = new FrameRing();
+            if (!frameRing->init(frameRingSize, yuvSource != NULL ? 0 : numberOfBytesPerFrame)) {
+                std::cout << "Failed to init frameRing" << std::endl;
+                return false;
+            }
+            return true;
+		} else if (videoFileType == VFT_DXT) {
+			dxtSource = new DxtVideoSource();
+			if (!dxtSource->open(videoFileName) || dxtSource->frameCount() == 0) {
+				return false;
+			}
+
+			const DxtVideoHeader &header = dxtSource->getHeader();
+			if (this->videoFrameWidth != (int)header.width || this->videoFrameHeight != (int)header.height) {
+				std::cout << "Using the frame size stored in " << videoFileName << ": " << header.width << "x" << header.height << std::endl;
+				this->videoFrameWidth = header.width;
+				this->videoFrameHeight = header.height;
+			}
+			numberOfBytesPerFrame = header.frameBytes;
+
+			glUseProgram(sceneProgramID);
+			glUniform1i(glGetUniformLocation(sceneProgramID, "dxtYCoCg"), dxtSource->format() == DXT_FORMAT_YCOCG_DXT5 ? 1 : 0);
+			glUseProgram(0);
+
+			double timeBase = header.timeBaseDen > 0 ? 1.0 * header.timeBaseNum / header.timeBaseDen : 0;
+			double frameDuration = header.frameRateNum > 0 ? 1.0 * header.frameRateDen / header.frameRateNum : 0;
+			presentationClock.setup(timeBase, frameDuration, clockMode);
+
+			// λֱָӳļ, Ҫ
+			frameRing = new FrameRing();
+			if (!frameRing->init(frameRingSize, 0)) {
+				std::cout << "Failed to init frameRing" << std::endl;
+				return false;
+			}
+			return true;
 		} else {
 			return false;
 		}
@@ -455,7 +1111,9 @@ namespace Player {
 	*/
 	bool Player::setupCoordinates() {
 		bool result;
-		if (this->projectionMode == PM_CPP_OBSOLETE) {
+		if (drawsProcedurally()) {
+			result = setupProceduralCoordinates();
+		} else if (this->projectionMode == PM_CPP_OBSOLETE) {
 			if (this->drawMode == DM_USE_INDEX) {
 				result = setupCPPCoordinatesWithIndex_Obsolete();
 			} else {
@@ -598,20 +1256,7 @@ namespace Player {
             1.0f, -1.0f,  1.0f
         };
 
-        glGenVertexArrays(1, &sceneVAO);
-        glBindVertexArray(sceneVAO);
-
-        glGenBuffers(1, &sceneVertexBuffer);
-        glBindBuffer(GL_ARRAY_BUFFER, sceneVertexBuffer);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxVertices), &skyboxVertices, GL_STATIC_DRAW);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-
-        glGenBuffers(1, &sceneUVBuffer);
-        glBindBuffer(GL_ARRAY_BUFFER, sceneUVBuffer);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxTextures), &skyboxTextures, GL_STATIC_DRAW);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
-
-        glBindVertexArray(0);
+        uploadSceneMesh("EAC", skyboxVertices, skyboxTextures, 3, 36, NULL, 0);
         return true;
     }
 
@@ -733,20 +1378,7 @@ namespace Player {
 
         };
 
-        glGenVertexArrays(1, &sceneVAO);
-        glBindVertexArray(sceneVAO);
-
-        glGenBuffers(1, &sceneVertexBuffer);
-        glBindBuffer(GL_ARRAY_BUFFER, sceneVertexBuffer);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxVertices), &skyboxVertices, GL_STATIC_DRAW);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-
-        glGenBuffers(1, &sceneUVBuffer);
-        glBindBuffer(GL_ARRAY_BUFFER, sceneUVBuffer);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxTextures), &skyboxTextures, GL_STATIC_DRAW);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
-
-        glBindVertexArray(0);
+        uploadSceneMesh("Cubemap", skyboxVertices, skyboxTextures, 3, 36, NULL, 0);
         return true;
     }
 
@@ -908,22 +1540,7 @@ namespace Player {
 
         vertexCount = vertexVector.size() / 3;
 
-        glGenVertexArrays(1, &sceneVAO);
-        glBindVertexArray(sceneVAO);
-
-        int vertexBufferSize = this->vertexCount * 3 * sizeof(float);
-        int uvBufferSize = this->vertexCount * 2 * sizeof(float);
-
-        glGenBuffers(1, &sceneVertexBuffer);
-        glBindBuffer(GL_ARRAY_BUFFER, sceneVertexBuffer);
-        glBufferData(GL_ARRAY_BUFFER, vertexBufferSize, &this->vertexVector[0], GL_STATIC_DRAW);
-
-        glGenBuffers(1, &sceneUVBuffer);
-        glBindBuffer(GL_ARRAY_BUFFER, sceneUVBuffer);
-        glBufferData(GL_ARRAY_BUFFER, uvBufferSize, &this->uvVector[0], GL_STATIC_DRAW);
-
-
-        glBindVertexArray(0);
+        uploadSceneMesh("TSP", &this->vertexVector[0], &this->uvVector[0], 2, this->vertexCount, NULL, 0);
         glCheckError();
         
     }
@@ -934,9 +1551,8 @@ namespace Player {
 
 		int radius = 10;
 		int pieces = this->patchNumber;
-		int halfPieces = pieces / 2;
 
-		this->vertexCount = ((halfPieces + 1) * (pieces + 1));
+		this->vertexCount = SphereMeshBuilder::vertexCount(pieces, true);
 
 		if (this->indexArray) {
 			delete[] indexArray;
@@ -951,76 +1567,19 @@ namespace Player {
 			uvArray = NULL;
 		}
 
-		this->indexArraySize = (pieces)*(halfPieces)* 6;
+		this->indexArraySize = SphereMeshBuilder::indexCount(pieces);
 		this->vertexArray = new float[this->vertexCount * 3];
 		this->uvArray = new float[this->vertexCount * 2];
 		this->indexArray = new int[this->indexArraySize];
 
-		double verticalInterval = M_PI / halfPieces;
-		double horizontalInterval = verticalInterval;
-
-		double latitude, longitude;
-		float xt, yt, zt;
-		float ut, vt;
-
-		int m = 0, n = 0;
-		for (int verticalIndex = 0; verticalIndex <= halfPieces; verticalIndex++) {
-			latitude = verticalIndex * verticalInterval;
-			for (int horizontalIndex = 0; horizontalIndex <= pieces; horizontalIndex++) {
-				longitude = horizontalIndex * horizontalInterval;
-
-				zt = (float)(radius*sin(latitude)*cos(longitude));
-				xt = (float)(radius*sin(latitude)*sin(longitude));
-				yt = (float)(radius*cos(latitude));
-
-				ut = 1.0f * horizontalIndex / pieces;
-				vt = 1.0f * verticalIndex / halfPieces;
-				this->vertexArray[m++] = xt;
-				this->vertexArray[m++] = yt;
-				this->vertexArray[m++] = zt;
-				this->uvArray[n++] = ut;
-				this->uvArray[n++] = vt;
-			}
-		}
-
-		m = 0;
-		for (int i = 1; i <= halfPieces; i++) {
-			for (int j = 0; j <= pieces - 1; j++) {
-				// index,0-1-2, 2-3-0
-				// 1---2
-				// |  /|
-				// | / |
-				// |/  |
-				// 0---3
-				indexArray[m++] = (i - 1) * (pieces + 1) + j;
-				indexArray[m++] = i * (pieces + 1) + j;
-				indexArray[m++] = i * (pieces + 1) + j + 1;
-				indexArray[m++] = i * (pieces + 1) + j + 1;
-				indexArray[m++] = (i - 1) * (pieces + 1) + j + 1;
-				indexArray[m++] = (i - 1) * (pieces + 1) + j;
-			}
+		// в, initopenVideo֮ǰ, ̳߳Ƚ
+		if (workerPool == NULL) {
+			workerPool = new ThreadPool(sliceCount > 0 ? sliceCount : ThreadPool::hardwareThreadCount());
 		}
+		SphereMeshBuilder builder(workerPool);
+		builder.build(pieces, (float)radius, this->vertexArray, this->uvArray, this->indexArray);
 
-		glGenVertexArrays(1, &sceneVAO);
-		glBindVertexArray(sceneVAO);
-
-		int vertexBufferSize = this->vertexCount * 3 * sizeof(float);
-		int uvBufferSize = this->vertexCount * 2 * sizeof(float);
-		int indexBufferSize = this->indexArraySize * sizeof(int);
-
-		glGenBuffers(1, &sceneVertexBuffer);
-		glBindBuffer(GL_ARRAY_BUFFER, sceneVertexBuffer);
-		glBufferData(GL_ARRAY_BUFFER, vertexBufferSize, this->vertexArray, GL_STATIC_DRAW);
-
-		glGenBuffers(1, &sceneUVBuffer);
-		glBindBuffer(GL_ARRAY_BUFFER, sceneUVBuffer);
-		glBufferData(GL_ARRAY_BUFFER, uvBufferSize, this->uvArray, GL_STATIC_DRAW);
-
-		glGenBuffers(1, &sceneIndexBuffer);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sceneIndexBuffer);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBufferSize, this->indexArray, GL_STATIC_DRAW);
-
-		glBindVertexArray(0);
+		uploadSceneMesh("ERP", this->vertexArray, this->uvArray, 2, this->vertexCount, this->indexArray, this->indexArraySize);
 		glCheckError();
 		return true;
 	}
@@ -1031,7 +1590,7 @@ namespace Player {
 	*/
 	bool Player::setupERPCoordinatesWithoutIndex() {
 		glCheckError();
-		this->vertexCount = this->patchNumber * this->patchNumber * 3;
+		this->vertexCount = SphereMeshBuilder::vertexCount(this->patchNumber, false);
 
 		if (this->vertexArray) {
 			delete[] this->vertexArray;
@@ -1042,102 +1601,14 @@ namespace Player {
 		this->vertexArray = new float[this->vertexCount * 3];
 		this->uvArray = new float[this->vertexCount * 2];
 
-
 		int radius = 10;
-		int pieces = this->patchNumber;
-		int halfPieces = this->patchNumber / 2;
-		double verticalInterval = M_PI / (halfPieces);
-		double horizontalInterval = verticalInterval;
-		double latitude;
-		double longitude;
-		float z[4] = { 0.0f };
-		float x[4] = { 0.0f };
-		float y[4] = { 0.0f };
-		float u[4] = { 0.0f };
-		float v[4] = { 0.0f };
-		int m = 0, n = 0;
-		for (int verticalIndex = 0; verticalIndex < halfPieces; verticalIndex++) {
-			latitude = verticalIndex * verticalInterval;
-			for (int horizontalIndex = 0; horizontalIndex < pieces; horizontalIndex++) {
-				longitude = horizontalIndex * horizontalInterval;
-				z[0] = (float)(radius*sin(latitude)*cos(longitude));
-				x[0] = (float)(radius*sin(latitude)*sin(longitude));
-				y[0] = (float)(radius*cos(latitude));
-				u[0] = (float)horizontalIndex / pieces;
-				v[0] = (float)verticalIndex / halfPieces;
-
-				z[1] = (float)(radius*sin(latitude + verticalInterval)*cos(longitude));
-				x[1] = (float)(radius*sin(latitude + verticalInterval)*sin(longitude));
-				y[1] = (float)(radius*cos(latitude + verticalInterval));
-				u[1] = (float)horizontalIndex / pieces;
-				v[1] = (float)(verticalIndex + 1) / halfPieces;
-
-				z[2] = (float)(radius*sin(latitude + verticalInterval)*cos(longitude + horizontalInterval));
-				x[2] = (float)(radius*sin(latitude + verticalInterval)*sin(longitude + horizontalInterval));
-				y[2] = (float)(radius*cos(latitude + verticalInterval));
-				u[2] = (float)(horizontalIndex + 1) / pieces;
-				v[2] = (float)(verticalIndex + 1) / halfPieces;
-
-				z[3] = (float)(radius*sin(latitude)*cos(longitude + horizontalInterval));
-				x[3] = (float)(radius*sin(latitude)*sin(longitude + horizontalInterval));
-				y[3] = (float)(radius*cos(latitude));
-				u[3] = (float)(horizontalIndex + 1) / pieces;
-				v[3] = (float)verticalIndex / halfPieces;
-
-				this->vertexArray[m++] = x[0];
-				this->vertexArray[m++] = y[0];
-				this->vertexArray[m++] = z[0];
-				this->uvArray[n++] = u[0];
-				this->uvArray[n++] = v[0];
-
-				this->vertexArray[m++] = x[1];
-				this->vertexArray[m++] = y[1];
-				this->vertexArray[m++] = z[1];
-				this->uvArray[n++] = u[1];
-				this->uvArray[n++] = v[1];
-
-				this->vertexArray[m++] = x[2];
-				this->vertexArray[m++] = y[2];
-				this->vertexArray[m++] = z[2];
-				this->uvArray[n++] = u[2];
-				this->uvArray[n++] = v[2];
-
-				this->vertexArray[m++] = x[2];
-				this->vertexArray[m++] = y[2];
-				this->vertexArray[m++] = z[2];
-				this->uvArray[n++] = u[2];
-				this->uvArray[n++] = v[2];
-
-
-				this->vertexArray[m++] = x[3];
-				this->vertexArray[m++] = y[3];
-				this->vertexArray[m++] = z[3];
-				this->uvArray[n++] = u[3];
-				this->uvArray[n++] = v[3];
-
-				this->vertexArray[m++] = x[0];
-				this->vertexArray[m++] = y[0];
-				this->vertexArray[m++] = z[0];
-				this->uvArray[n++] = u[0];
-				this->uvArray[n++] = v[0];
-			}
+		if (workerPool == NULL) {
+			workerPool = new ThreadPool(sliceCount > 0 ? sliceCount : ThreadPool::hardwareThreadCount());
 		}
+		SphereMeshBuilder builder(workerPool);
+		builder.build(this->patchNumber, (float)radius, this->vertexArray, this->uvArray, NULL);
 
-		glGenVertexArrays(1, &sceneVAO);
-		glBindVertexArray(sceneVAO);
-
-		int vertexSize = this->vertexCount * 3 * sizeof(float);
-		int uvSize = this->vertexCount * 2 * sizeof(float);
-
-		glGenBuffers(1, &sceneVertexBuffer);
-		glBindBuffer(GL_ARRAY_BUFFER, sceneVertexBuffer);
-		glBufferData(GL_ARRAY_BUFFER, vertexSize, this->vertexArray, GL_STATIC_DRAW);
-
-		glGenBuffers(1, &sceneUVBuffer);
-		glBindBuffer(GL_ARRAY_BUFFER, sceneUVBuffer);
-		glBufferData(GL_ARRAY_BUFFER, uvSize, this->uvArray, GL_STATIC_DRAW);
-
-		glBindVertexArray(0);
+		uploadSceneMesh("ERP", this->vertexArray, this->uvArray, 2, this->vertexCount, NULL, 0);
 		glCheckError();
 		return true;
 	}
@@ -1236,21 +1707,7 @@ namespace Player {
 			}
 		}
 
-		glGenVertexArrays(1, &sceneVAO);
-		glBindVertexArray(sceneVAO);
-
-		int vertexSize = this->vertexCount * 3 * sizeof(float);
-		int uvSize = this->vertexCount * 2 * sizeof(float);
-
-		glGenBuffers(1, &sceneVertexBuffer);
-		glBindBuffer(GL_ARRAY_BUFFER, sceneVertexBuffer);
-		glBufferData(GL_ARRAY_BUFFER, vertexSize, this->vertexArray, GL_STATIC_DRAW);
-
-		glGenBuffers(1, &sceneUVBuffer);
-		glBindBuffer(GL_ARRAY_BUFFER, sceneUVBuffer);
-		glBufferData(GL_ARRAY_BUFFER, uvSize, this->uvArray, GL_STATIC_DRAW);
-
-		glBindVertexArray(0);
+		uploadSceneMesh("CPP", this->vertexArray, this->uvArray, 2, this->vertexCount, NULL, 0);
 		glCheckError();
 		return true;
 	}
@@ -1331,26 +1788,7 @@ namespace Player {
 		}
 
 
-		glGenVertexArrays(1, &sceneVAO);
-		glBindVertexArray(sceneVAO);
-
-		int vertexBufferSize = this->vertexCount * 3 * sizeof(float);
-		int uvBufferSize = this->vertexCount * 2 * sizeof(float);
-		int indexBufferSize = this->indexArraySize * sizeof(int);
-
-		glGenBuffers(1, &sceneVertexBuffer);
-		glBindBuffer(GL_ARRAY_BUFFER, sceneVertexBuffer);
-		glBufferData(GL_ARRAY_BUFFER, vertexBufferSize, this->vertexArray, GL_STATIC_DRAW);
-
-		glGenBuffers(1, &sceneUVBuffer);
-		glBindBuffer(GL_ARRAY_BUFFER, sceneUVBuffer);
-		glBufferData(GL_ARRAY_BUFFER, uvBufferSize, this->uvArray, GL_STATIC_DRAW);
-
-		glGenBuffers(1, &sceneIndexBuffer);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sceneIndexBuffer);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBufferSize, this->indexArray, GL_STATIC_DRAW);
-
-		glBindVertexArray(0);
+		uploadSceneMesh("CPP", this->vertexArray, this->uvArray, 2, this->vertexCount, this->indexArray, this->indexArraySize);
 		glCheckError();
 		return true;
 	}
@@ -1377,17 +1815,42 @@ namespace Player {
 	}
 
 	/**
-	* ͶӰʽòͬȾ
+	* ͶӰʽòͬȾ, Ƿʾһ֡; ѿջһ֡ʾʱfalse
 	*/
-	void Player::drawFrame() {
-        sem_wait(&(this->decodeOneFrameFinishedSemaphore));
-        if (this->videoFileType == VFT_YUV) {
-
-            pthread_mutex_lock(&this->lock);
-            this->setupTextureData(decodedYUVBuffer);
-            pthread_mutex_unlock(&this->lock);
-
+	bool Player::drawFrame() {
+        if (this->projectionBenchmark) {
+            this->advanceBenchmarkCamera();
+        }
+        if (this->erpViewport != NULL) {
+            this->updateVisibleRegions();
+        }
+        if (this->frameRing != NULL) {
+            FrameSlot *slot = this->frameRing->acquireReadSlot();
+            if (slot == NULL) {
+                // ߳ѾҶûʣ֡
+                this->allFrameRead = true;
+                return false;
+            }
+            dequeuedFrameCount++;
+            if (!this->presentationClock.waitForPresentation(slot->pts)) {
+                // һ֡Ѿʾ, ϴͻ
+                this->frameRing->releaseReadSlot(slot);
+                return false;
+            }
+            // ѾPBOglTexSubImage2D, λ̻߳
+            const std::vector<TextureRegion> *regions = slot->regions.empty() ? NULL : &slot->regions;
+            if (regions == NULL && this->pagedTexture != NULL && this->erpViewport != NULL) {
+                // ҳֻҪӿڵҳפ, ӿҳϴ
+                regions = &this->erpViewport->getRegions();
+            } else if (regions == NULL && this->viewportUploads) {
+                regions = this->selectViewportRegions();
+            } else if (regions == NULL && this->tileHasher != NULL) {
+                regions = this->selectDirtyTiles(slot);
+            }
+            this->setupTextureData(slot->planes, slot->linesizes, regions);
+            this->frameRing->releaseReadSlot(slot);
         } else if (this->videoFileType == VFT_Encoded) {
+            sem_wait(&(this->decodeOneFrameFinishedSemaphore));
             if (this->decodeType == DT_HARDWARE) {
                 glBindTexture(GL_TEXTURE_2D, cudaTextureID);
 
@@ -1401,419 +1864,500 @@ namespace Player {
                     }
                     firstTime = false;
                 }
-            } else if (this->decodeType == DT_SOFTWARE) {
-                pthread_mutex_lock(&this->lock);
+            }
+        }
 
-                if (this->renderYUV) {
-                    this->setupTextureData(decodedYUVBuffer);
-                } else {
-                    this->setupTextureData(decodedRGB24Buffer);
-                }
-
-                pthread_mutex_unlock(&this->lock);
-            }
-        }
-
-
-		if (this->projectionMode == PM_ERP) {
 
-			if (drawMode == DM_USE_INDEX) {
-				drawFrameERPWithIndex();
-			} else {
-				drawFrameERPWithoutIndex();
-			}
-		} else if (this->projectionMode == PM_CPP_OBSOLETE) {
-			if (drawMode == DM_USE_INDEX) {
-				drawFrameCPPWithIndex_Obsolete();
-			} else {
-				drawFrameCPPWithoutIndex_Obsolete();
-			}
-		} else if (this->projectionMode == PM_CPP) {
-			drawFrameCppEqualDistance();
-        } else if (this->projectionMode == PM_CUBEMAP) {
-            drawFrameCubeMap();
-        } else if (this->projectionMode == PM_TSP) {
-            drawFrameTSP();
-        } else if (this->projectionMode == PM_EAC) {
-            drawFrameEAC();
-        }
+		if (drawsProcedurally()) {
+			drawFrameProcedural();
+		} else {
+			drawFrameMesh();
+		}
 
         SDL_GL_SwapWindow(pWindow);
 
-        sem_post(&this->renderFinishedSemaphore);
+        if (this->frameRing == NULL) {
+            sem_post(&this->renderFinishedSemaphore);
+        }
+        return true;
 	}
 
 
-    void Player::drawFrameTSP() {
-        glViewport(0, 0, windowWidth, windowHeight);
-        glDisable(GL_DEPTH_TEST);
-        glCheckError();
-        computeMVPMatrix();
-        glUseProgram(sceneProgramID);
-
-        glUniformMatrix4fv(sceneMVPMatrixPointer, 1, GL_FALSE, &mvpMatrix[0][0]);
-        glBindVertexArray(sceneVAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, sceneVertexBuffer);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (const void *)0);
-
-        glBindBuffer(GL_ARRAY_BUFFER, sceneUVBuffer);
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, (const void *)0);
-
-        glDrawArrays(GL_TRIANGLES, 0, vertexCount);
-
-        glBindVertexArray(0);
-        glCheckError();
-    }
-
-    void Player::drawFrameEAC() {
-        glViewport(0, 0, windowWidth, windowHeight);
-        glDisable(GL_DEPTH_TEST);
-        glCheckError();
-        computeMVPMatrix();
-        glUseProgram(sceneProgramID);
-
-        glUniformMatrix4fv(sceneMVPMatrixPointer, 1, GL_FALSE, &mvpMatrix[0][0]);
-        glBindVertexArray(sceneVAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, sceneVertexBuffer);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (const void *)0);
-
-        glBindBuffer(GL_ARRAY_BUFFER, sceneUVBuffer);
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, (const void *)0);
-
-        glDrawArrays(GL_TRIANGLES, 0, vertexCount);
-
-        glBindVertexArray(0);
-        glCheckError();
-    }
-
-
-    void Player::drawFrameCubeMap() {
-        glCheckError();
-        glViewport(0, 0, windowWidth, windowHeight);
-        glDisable(GL_DEPTH_TEST);
-
-        computeMVPMatrix();
-        glUseProgram(sceneProgramID);
-
-        glUniformMatrix4fv(sceneMVPMatrixPointer, 1, GL_FALSE, &mvpMatrix[0][0]);
-        glBindVertexArray(sceneVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, sceneVertexBuffer);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (const void *)0);
-
-        glBindBuffer(GL_ARRAY_BUFFER, sceneUVBuffer);
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, (const void *)0);
-
-        glDrawArrays(GL_TRIANGLES, 0, this->vertexCount);
-
-        glBindVertexArray(0);
-        glCheckError();
-    }
-
-	void Player::drawFrameERPWithIndex() {
-		glViewport(0, 0, windowWidth, windowHeight);
-		glDisable(GL_DEPTH_TEST);
-		glCheckError();
+	/**
+	* ͶӰ׼ʱˮƽת, ÿ֡ͶӰĲͬ
+	*/
+	void Player::advanceBenchmarkCamera() {
+		this->touchPointX += BENCHMARK_DEGREES_PER_FRAME;
+		this->previousXposition = this->currentXposition;
+		this->previousYposition = this->currentYposition;
+		computeViewMatrix();
 		computeMVPMatrix();
-		glUseProgram(sceneProgramID);
-
-		glUniformMatrix4fv(sceneMVPMatrixPointer, 1, GL_FALSE, &mvpMatrix[0][0]);
-		glBindVertexArray(sceneVAO);
-
-		glBindBuffer(GL_ARRAY_BUFFER, sceneVertexBuffer);
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (const void *)0);
-
-		glBindBuffer(GL_ARRAY_BUFFER, sceneUVBuffer);
-		glEnableVertexAttribArray(1);
-		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, (const void *)0);
-
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sceneIndexBuffer);
-		glDrawElements(GL_TRIANGLES, this->indexArraySize, GL_UNSIGNED_INT, (const void *)0);
-		glBindVertexArray(0);
-
 	}
 
-
+	/**
+	* ͶӰҪ, ģʽ»ʱһVAO
+	*/
+	bool Player::setupProceduralCoordinates() {
+		glGenVertexArrays(1, &sceneVAO);
+		this->vertexCount = 3;
+		glCheckError();
+		return true;
+	}
 
 	/**
-	* ͶӰʽΪERPƵ֡
+	* ͶӰ: ϴMVP, һȫ
 	*/
-	void Player::drawFrameERPWithoutIndex() {
-		/*glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);*/
+	void Player::drawFrameProcedural() {
 		glViewport(0, 0, windowWidth, windowHeight);
 		glDisable(GL_DEPTH_TEST);
-
 		computeMVPMatrix();
 		glUseProgram(sceneProgramID);
 
-		glUniformMatrix4fv(sceneMVPMatrixPointer, 1, GL_FALSE, &mvpMatrix[0][0]);
-
+		glm::mat4 inverseMatrix = glm::inverse(mvpMatrix);
+		glUniformMatrix4fv(sceneMVPMatrixPointer, 1, GL_FALSE, &inverseMatrix[0][0]);
 		glBindVertexArray(sceneVAO);
-
-		glBindBuffer(GL_ARRAY_BUFFER, sceneVertexBuffer);
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (const void *)0);
-
-		glBindBuffer(GL_ARRAY_BUFFER, sceneUVBuffer);
-		glEnableVertexAttribArray(1);
-		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, (const void *)0);
-
-		glDrawArrays(GL_TRIANGLES, 0, this->vertexCount);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
 		glBindVertexArray(0);
-
+		glCheckError();
 	}
 
 	/**
-	* ͶӰʽΪCPPƵ֡
+	* תɽյĽʽ(, Ż, 16λ)ϴsceneVAO
+	* ͶӰCPU鱣ֲ, ͶӰͳȻʹ
 	*/
-	void Player::drawFrameCPPWithIndex_Obsolete() {
-		/*glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);*/
-		glViewport(0, 0, windowWidth, windowHeight);
-		glDisable(GL_DEPTH_TEST);
-
-		computeMVPMatrix();
-		glUseProgram(sceneProgramID);
-
-
-		glUniformMatrix4fv(sceneMVPMatrixPointer, 1, GL_FALSE, &mvpMatrix[0][0]);
-
+	bool Player::uploadSceneMesh(const char *name, const float *positions, const float *coords, int coordComponents, int vertexCount,
+		const int *indices, int indexCount) {
+		if (!sceneMesh.build(positions, coords, coordComponents, vertexCount, indices, indexCount)) {
+			std::cout << "Failed to build the " << name << " mesh" << std::endl;
+			return false;
+		}
+		glGenVertexArrays(1, &sceneVAO);
 		glBindVertexArray(sceneVAO);
-
-		glBindBuffer(GL_ARRAY_BUFFER, sceneVertexBuffer);
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (const void *)0);
-
-		glBindBuffer(GL_ARRAY_BUFFER, sceneUVBuffer);
-		glEnableVertexAttribArray(1);
-		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, (const void *)0);
-
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sceneIndexBuffer);
-
-		glDrawElements(GL_TRIANGLES, this->indexArraySize, GL_UNSIGNED_INT, (const void *)0);
-
+		bool result = sceneMesh.upload();
 		glBindVertexArray(0);
-		
+		sceneMesh.printStatistics(name);
 		glCheckError();
+		return result;
 	}
 
-	void Player::drawFrameCPPWithoutIndex_Obsolete() {
-		/*glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);*/
+	/**
+	* ͶӰõĻ: ϴʱѾ¼VAO, ÿֻ֡ҪVAO
+	*/
+	void Player::drawFrameMesh() {
 		glViewport(0, 0, windowWidth, windowHeight);
 		glDisable(GL_DEPTH_TEST);
-
 		computeMVPMatrix();
 		glUseProgram(sceneProgramID);
 
 		glUniformMatrix4fv(sceneMVPMatrixPointer, 1, GL_FALSE, &mvpMatrix[0][0]);
-
 		glBindVertexArray(sceneVAO);
+		sceneMesh.draw();
+		glBindVertexArray(0);
+		glCheckError();
+	}
 
-		glBindBuffer(GL_ARRAY_BUFFER, sceneVertexBuffer);
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (const void *)0);
-
-		glBindBuffer(GL_ARRAY_BUFFER, sceneUVBuffer);
-		glEnableVertexAttribArray(1);
-		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, (const void *)0);
+	/**
+	* ͶӰƬԪɫͬĹʽ, CPUϰѷӳ䵽֡, ֻ֧ERP, CPPTSP
+	*/
+	bool Player::directionToFrameCoords(const glm::vec3 &direction, float &u, float &v) {
+		glm::vec3 d = glm::normalize(direction);
+		if (this->projectionMode == PM_ERP) {
+			float longitude = atan2(d.x, d.z);
+			if (longitude < 0) {
+				longitude += (float)(2 * M_PI);
+			}
+			u = (float)(longitude / (2 * M_PI));
+			v = (float)(acos(fmax(-1.0, fmin(1.0, d.y))) / M_PI);
+		} else if (this->projectionMode == PM_CPP) {
+			float latitude = (float)asin(fmax(-1.0, fmin(1.0, d.y)));
+			float longitude = atan2(-d.x, -d.z);
+			u = (float)(0.5 + longitude / M_PI * videoFrameHeight / videoFrameWidth * (2 * cos(2 * latitude / 3) - 1));
+			v = (float)(0.5 - sin(latitude / 3));
+		} else if (this->projectionMode == PM_TSP) {
+			glm::vec3 a = glm::abs(d);
+			glm::vec3 p = d / glm::max(a.x, glm::max(a.y, a.z));
+			float s, t;
+			if (a.z >= a.x && a.z >= a.y) {
+				t = (p.y + 1) * 0.5f;
+				if (d.z > 0) {
+					s = (p.x + 1) * 0.5f;
+					u = s * 0.5f;
+					v = t;
+				} else {
+					s = (1 - p.x) * 0.5f;
+					u = 0.125f * s + 0.6875f;
+					v = 0.25f * t + 0.375f;
+				}
+			} else if (a.y >= a.x) {
+				s = (p.x + 1) * 0.5f;
+				if (d.y > 0) {
+					t = (1 - p.z) * 0.5f;
+					u = 1 - 0.1875f * t - 0.5f * s + 0.375f * s * t;
+					v = 1 - 0.375f * t;
+				} else {
+					t = (p.z + 1) * 0.5f;
+					u = 0.1875f * t - 0.375f * s * t - 0.125f * s + 0.8125f;
+					v = 0.375f - 0.375f * t;
+				}
+			} else {
+				t = (p.y + 1) * 0.5f;
+				if (d.x > 0) {
+					s = (1 - p.z) * 0.5f;
+					u = 0.1875f * s + 0.5f;
+					v = 0.375f * s - 0.75f * s * t + t;
+				} else {
+					s = (p.z + 1) * 0.5f;
+					u = 0.1875f * s + 0.8125f;
+					v = 0.25f * t + 0.75f * s * t - 0.375f * s + 0.375f;
+				}
+			}
+			v = 1 - v;
+		} else {
+			return false;
+		}
+		return true;
+	}
 
-		glDrawArrays(GL_TRIANGLES, 0, this->vertexCount);
+	/**
+	* ·Ĳ: ÿεеϱȽϲֵõ뾫ȷ֡, ()
+	* ERPˮƽγȦܳС, Ϊ0; ERPCPPھȡ180ȴĽӷ찴һл
+	* -1ʾǰͶӰûпɱȽϵ(CubemapǾȷ)
+	*/
+	double Player::meshSamplingError(int *triangleCount) {
+		const float *positions = NULL;
+		const float *uvs = NULL;
+		const int *indices = NULL;
+		int indexCount = 0;
+		if (this->projectionMode == PM_ERP && this->drawMode == DM_USE_INDEX) {
+			positions = this->vertexArray;
+			uvs = this->uvArray;
+			indices = this->indexArray;
+			indexCount = this->indexArraySize;
+		} else if (this->projectionMode == PM_ERP) {
+			positions = this->vertexArray;
+			uvs = this->uvArray;
+			indexCount = this->vertexCount;
+		} else if ((this->projectionMode == PM_CPP || this->projectionMode == PM_TSP) && !this->vertexVector.empty()) {
+			positions = &this->vertexVector[0];
+			uvs = &this->uvVector[0];
+			indexCount = (int)this->vertexVector.size() / 3;
+		}
+		if (positions == NULL || uvs == NULL) {
+			return -1;
+		}
 
-		glBindVertexArray(0);
+		static const float SAMPLES[4][3] = {
+			{ 1.0f / 3, 1.0f / 3, 1.0f / 3 }, { 0.5f, 0.5f, 0 }, { 0, 0.5f, 0.5f }, { 0.5f, 0, 0.5f }
+		};
+		double maxError = 0;
+		for (int triangle = 0; triangle + 2 < indexCount; triangle += 3) {
+			for (int sample = 0; sample < 4; sample++) {
+				glm::vec3 position(0.0f);
+				float meshU = 0, meshV = 0;
+				for (int k = 0; k < 3; k++) {
+					int vertex = indices != NULL ? indices[triangle + k] : triangle + k;
+					position += SAMPLES[sample][k] * glm::vec3(positions[vertex * 3], positions[vertex * 3 + 1], positions[vertex * 3 + 2]);
+					meshU += SAMPLES[sample][k] * uvs[vertex * 2];
+					meshV += SAMPLES[sample][k] * uvs[vertex * 2 + 1];
+				}
+				float u, v;
+				if (glm::length(position) == 0 || !directionToFrameCoords(position, u, v)) {
+					continue;
+				}
+				double du = fabs(meshU - u);
+				double dv = fabs(meshV - v);
+				glm::vec3 d = glm::normalize(position);
+				if (this->projectionMode == PM_ERP) {
+					du = fmin(du, 1 - du) * sqrt(fmax(0.0, 1.0 - d.y * d.y));
+				} else if (this->projectionMode == PM_CPP) {
+					double latitude = asin(fmax(-1.0, fmin(1.0, d.y)));
+					double rowWidth = 2.0 * videoFrameHeight / videoFrameWidth * (2 * cos(2 * latitude / 3) - 1);
+					du = fmin(du, fabs(rowWidth - du));
+				}
+				maxError = fmax(maxError, fmax(du * videoFrameWidth, dv * videoFrameHeight));
+			}
+		}
+		*triangleCount = indexCount / 3;
+		return maxError;
+	}
 
+	/**
+	* ͶӰ׼ԽʱƷʽ, ͬ±ȽͶӰ
+	*/
+	void Player::printProjectionQuality() {
+		if (drawsProcedurally()) {
+			std::cout << "Procedural projection: 1 full-screen triangle, exact frame coordinates per fragment" << std::endl;
+			return;
+		}
+		int triangleCount = 0;
+		double error = meshSamplingError(&triangleCount);
+		if (error >= 0) {
+			std::cout << "Mesh projection: " << triangleCount << " triangles (-patch " << patchNumber << "), max sampling error "
+				<< error << " texels" << std::endl;
+		}
 	}
 
+
 	/**
 	* OpenGL
 	*/
 	void Player::destroyGL() {
-		if (sceneProgramID) {
+		if (pixelUnpackRing != NULL) {
+			if (glContext != NULL) {
+				pixelUnpackRing->release();
+			}
+			delete pixelUnpackRing;
+			pixelUnpackRing = NULL;
+		}
+		if (mappedFramePool != NULL && glContext != NULL) {
+			mappedFramePool->release();
+		}
+		if (pagedTexture != NULL) {
+			if (glContext != NULL) {
+				pagedTexture->release();
+			}
+			delete pagedTexture;
+			pagedTexture = NULL;
+		}
+		if (glContext != NULL) {
+			sceneMesh.release();
+		}
+		if (glContext != NULL && sceneProgramID) {
 			glDeleteProgram(sceneProgramID);
 		}
 	}
 
+	/**
+	* еYUV420PRGBA/BGRAƽʼַп
+	*/
+	void Player::fillContiguousPlanes(unsigned char *textureData, unsigned char *planes[3], int linesizes[3]) {
+		if (this->renderYUV) {
+			planes[0] = textureData;
+			planes[1] = textureData + this->videoFrameWidth * this->videoFrameHeight;
+			linesizes[0] = this->videoFrameWidth;
+			if (this->yuvFrameLayout == YCL_NV12) {
+				planes[2] = NULL;
+				linesizes[1] = this->videoFrameWidth;
+				linesizes[2] = 0;
+			} else {
+				planes[2] = textureData + this->videoFrameWidth * this->videoFrameHeight / 4 * 5;
+				linesizes[1] = this->videoFrameWidth / 2;
+				linesizes[2] = this->videoFrameWidth / 2;
+			}
+		} else {
+			planes[0] = textureData;
+			planes[1] = planes[2] = NULL;
+			linesizes[0] = this->videoFrameWidth * 4;
+			linesizes[1] = linesizes[2] = 0;
+		}
+	}
+
 	/**
 	* Ƶ֡
 	*/
 	bool Player::setupTextureData(unsigned char *textureData) {
-		static bool firstTime = true;
+		unsigned char *planes[3];
+		int linesizes[3];
+		fillContiguousPlanes(textureData, planes, linesizes);
+		return setupTextureData(planes, linesizes);
+	}
+
+	/**
+	* Ƶ֡, ֱӴӸƽ水ʵпϴ
+	* 洢setupTextureһη, ֻglTexSubImage2D; ֡ϴʱȰѸƽ濽PBO,
+	* ٴPBOϴ, 첽DMA, ʱλеѾҪ;
+	* ֡ɽдMappedFramePoolʱֱӴӸûϴ, κο
+	*/
+	bool Player::setupTextureData(unsigned char * const *planes, const int *linesizes, const std::vector<TextureRegion> *regions) {
+		if (this->videoFileType == VFT_DXT) {
+			return setupCompressedTextureData(planes[0], linesizes[0]);
+		}
+		if (regions != NULL && regions->empty()) {
+			// еûб仯
+			return true;
+		}
+		// PBOʱƽ"ָ"PBOƫ
+		unsigned char *uploadPlanes[3] = { planes[0], planes[1], planes[2] };
+		if (mappedFramePool != NULL) {
+			mappedFramePool->recycle();
+		}
+		bool fromMappedFrame = mappedFramePool != NULL && mappedFramePool->bindForUpload(planes, uploadPlanes);
+		// ҳÿֻ֡ϴһҳ, PBO
+		bool fromPixelUnpackBuffer = !fromMappedFrame && regions == NULL && pagedTexture == NULL && stageFrameInPixelUnpackRing(planes, linesizes, uploadPlanes);
+		unsigned char *textureData = uploadPlanes[0];
+		int rowLength = linesizes[0] / 4;
+		GLenum rgbFormat = rgbUploadFormat();
 		glUseProgram(sceneProgramID);
         glCheckError();
-        if (this->projectionMode == PM_CUBEMAP) {
-            glBindTexture(GL_TEXTURE_CUBE_MAP, sceneTextureID);
-            glPixelStorei(GL_UNPACK_ROW_LENGTH, videoFrameWidth);
-
-            assert(videoFrameWidth / 3 == videoFrameHeight / 2);
-            int width = videoFrameWidth / 3;     
-            int height = width;
-
-            glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
-            glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_Z, 0, GL_RGB, width, width, 0, GL_RGB, GL_UNSIGNED_BYTE, textureData);
-
-            glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
-            glPixelStorei(GL_UNPACK_SKIP_PIXELS, width);
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_NEGATIVE_Z, 0, GL_RGB, width, width, 0, GL_RGB, GL_UNSIGNED_BYTE, textureData);
-
-
-            glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
-            glPixelStorei(GL_UNPACK_SKIP_PIXELS, width * 2);
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_Y, 0, GL_RGB, width, width, 0, GL_RGB, GL_UNSIGNED_BYTE, textureData);
-
-
-            glPixelStorei(GL_UNPACK_SKIP_ROWS, width);
-            glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_NEGATIVE_Y, 0, GL_RGB, width, width, 0, GL_RGB, GL_UNSIGNED_BYTE, textureData);
-
-            glPixelStorei(GL_UNPACK_SKIP_ROWS, width);
-            glPixelStorei(GL_UNPACK_SKIP_PIXELS, width);
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_NEGATIVE_X, 0, GL_RGB, width, width, 0, GL_RGB, GL_UNSIGNED_BYTE, textureData);
-
-            glPixelStorei(GL_UNPACK_SKIP_ROWS, width);
-            glPixelStorei(GL_UNPACK_SKIP_PIXELS, width * 2);
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X, 0, GL_RGB, width, width, 0, GL_RGB, GL_UNSIGNED_BYTE, textureData);
-
-
-            //// 2 Ҳbottom Ҫʱת90
-            //uint8_t *start = textureData + videoFrameWidth * height * 3;
-            //for (int j = 0; j < height; j++) {
-            //    for (int i = 0; i < width; i++) {
-            //        faceBufferOne[((width - 1 - i) * width + j) * 3 + 0] = *(start + i * 3 + 0);
-            //        faceBufferOne[((width - 1 - i) * width + j) * 3 + 1] = *(start + i * 3 + 1);
-            //        faceBufferOne[((width - 1 - i) * width + j) * 3 + 2] = *(start + i * 3 + 2);
-            //    }
-            //    start += videoFrameWidth * 3;
-            //}
-            //glPixelStorei(GL_UNPACK_ROW_LENGTH, width);
-            //glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
-            //glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
-            //glTexImage2D(GL_TEXTURE_CUBE_MAP_NEGATIVE_Y, 0, GL_RGB, width, width, 0, GL_RGB, GL_UNSIGNED_BYTE, faceBufferOne);
-
-
-            //// 0 Ҳtop Ҫ˳ʱת90
-            //start = textureData + width * 2 * 3;
-            //for (int j = 0; j < height; j++) {
-            //    for (int i = 0; i < width; i++) {
-            //        faceBufferTwo[(i*width + height - 1 - j) * 3 + 0] = *(start + i * 3 + 0);
-            //        faceBufferTwo[(i*width + height - 1 - j) * 3 + 1] = *(start + i * 3 + 1);
-            //        faceBufferTwo[(i*width + height - 1 - j) * 3 + 2] = *(start + i * 3 + 2);
-            //    }
-            //    start += videoFrameWidth * 3;
-            //}
-            //glPixelStorei(GL_UNPACK_ROW_LENGTH, width);
-            //glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
-            //glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
-            //glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_Y, 0, GL_RGB, width, width, 0, GL_RGB, GL_UNSIGNED_BYTE, faceBufferTwo);
-
-
-        } else if (this->projectionMode == PM_EAC || this->projectionMode == PM_ACP) {
-            glBindTexture(GL_TEXTURE_CUBE_MAP, sceneTextureID);
-            glPixelStorei(GL_UNPACK_ROW_LENGTH, videoFrameWidth);
-
-            int width = videoFrameWidth / 3;
-            int height = width;
-
-            glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
-            glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_NEGATIVE_Z, 0, GL_RGB, width, width, 0, GL_RGB, GL_UNSIGNED_BYTE, textureData);
-
-            glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
-            glPixelStorei(GL_UNPACK_SKIP_PIXELS, width);
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_NEGATIVE_X, 0, GL_RGB, width, width, 0, GL_RGB, GL_UNSIGNED_BYTE, textureData);
-
-            glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
-            glPixelStorei(GL_UNPACK_SKIP_PIXELS, width * 2);
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_Z, 0, GL_RGB, width, width, 0, GL_RGB, GL_UNSIGNED_BYTE, textureData);
-
-            glPixelStorei(GL_UNPACK_SKIP_ROWS, width);
-            glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_NEGATIVE_Y, 0, GL_RGB, width, width, 0, GL_RGB, GL_UNSIGNED_BYTE, textureData);
-
-            glPixelStorei(GL_UNPACK_SKIP_ROWS, width);
-            glPixelStorei(GL_UNPACK_SKIP_PIXELS, width);
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X, 0, GL_RGB,width,width,0,GL_RGB,GL_UNSIGNED_BYTE, textureData);
-
-            glPixelStorei(GL_UNPACK_SKIP_ROWS, width);
-            glPixelStorei(GL_UNPACK_SKIP_PIXELS, width * 2);
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_Y, 0, GL_RGB, width, width, 0, GL_RGB, GL_UNSIGNED_BYTE, textureData);
-            
-            /*
-            uint8_t *start = textureData + videoFrameWidth * height * 3 + width * 3;
-
-            for (int j = 0; j < height; j++) {
-                for (int i = 0; i < width; i++) {
-                    faceBufferOne[((width - 1 - i) * width + j) * 3 + 0] = *(start + i * 3 + 0);
-                    faceBufferOne[((width - 1 - i) * width + j) * 3 + 1] = *(start + i * 3 + 1);
-                    faceBufferOne[((width - 1 - i) * width + j) * 3 + 2] = *(start + i * 3 + 2);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        // ͼģʽ3x2֡ERPһ֡ϴ2D
+        bool cubemap = isCubeProjection() && !cubeAtlas;
+        const GLenum *faces = this->projectionMode == PM_CUBEMAP ? CUBEMAP_FACES : EAC_FACES;
+        if (isCubeProjection()) {
+            assert(this->projectionMode != PM_CUBEMAP || videoFrameWidth / 3 == videoFrameHeight / 2);
+        }
+        if (pagedTexture != NULL) {
+            // ֻϴregionsǵҳ, regionsΪNULL(TSP֡ϴ)ʱϴҳ
+            pagedTexture->requestRegions(regions);
+            pagedTexture->upload(uploadPlanes, linesizes);
+        } else if (this->renderYUV) {
+            // ͶӰֱϴY, U, V(򽻴UV)ƽ, ƬԪɫתRGB
+            for (int i = 0; i < yuvPlaneCount(); i++) {
+                int shift = (i == 0 ? 0 : 1);
+                GLenum format = yuvPlaneFormat(i);
+                int pixelBytes = (format == GL_RG ? 2 : 1);
+                glActiveTexture(GL_TEXTURE0 + i);
+                glPixelStorei(GL_UNPACK_ROW_LENGTH, linesizes[i] / pixelBytes);
+                if (cubemap) {
+                    glBindTexture(GL_TEXTURE_CUBE_MAP, yuvTexturesID[i]);
+                    uploadCubeFaces(faces, (videoFrameWidth / 3) >> shift, format, uploadPlanes[i]);
+                } else if (regions != NULL) {
+                    glBindTexture(GL_TEXTURE_2D, yuvTexturesID[i]);
+                    uploadRegions(*regions, shift, format, uploadPlanes[i]);
+                } else {
+                    glBindTexture(GL_TEXTURE_2D, yuvTexturesID[i]);
+                    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, videoFrameWidth >> shift, videoFrameHeight >> shift,
+                        format, GL_UNSIGNED_BYTE, static_cast<const GLvoid*>(uploadPlanes[i]));
                 }
-                start += videoFrameWidth * 3;
             }
-
-            glPixelStorei(GL_UNPACK_ROW_LENGTH, width);
-
-            glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
-            glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X, 0, GL_RGB, width, width, 0, GL_RGB, GL_UNSIGNED_BYTE, faceBufferOne);
-
-            start = textureData + videoFrameWidth * height * 3 + width * 2 * 3;
-            for (int j = 0; j < height; j++) {
-                for (int i = 0; i < width; i++) {
-                    faceBufferTwo[((height - 1 - j)*width + (width - i)) * 3 + 0] = *(start + (i) * 3);
-                    faceBufferTwo[((height - 1 - j)*width + (width - i)) * 3 + 1] = *(start + (i) * 3 + 1);
-                    faceBufferTwo[((height - 1 - j)*width + (width - i)) * 3 + 2] = *(start + (i) * 3 + 2);
-                }
-                start += videoFrameWidth * 3;
+            glActiveTexture(GL_TEXTURE0);
+        } else if (cubemap) {
+            glBindTexture(GL_TEXTURE_CUBE_MAP, sceneTextureID);
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, rowLength);
+            uploadCubeFaces(faces, videoFrameWidth / 3, rgbFormat, textureData);
+        } else if (this->projectionMode == PM_ERP || this->projectionMode == PM_TSP || this->projectionMode == PM_CPP || samplesCubeAtlas()) {
+            glBindTexture(GL_TEXTURE_2D, sceneTextureID);
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, rowLength);
+            if (regions != NULL) {
+                uploadRegions(*regions, 0, rgbFormat, textureData);
+            } else {
+                glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, videoFrameWidth, videoFrameHeight, rgbFormat, GL_UNSIGNED_BYTE, textureData);
             }
+        }
 
-            glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
-            glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_Y, 0, GL_RGB, width, width, 0, GL_RGB, GL_UNSIGNED_BYTE, faceBufferTwo);
-            */
-        } else if (this->projectionMode == PM_ERP){
-            if (this->renderYUV) {
-                unsigned char *yuvPlanes[3];
-                yuvPlanes[0] = textureData;
-                yuvPlanes[1] = textureData + this->videoFrameWidth * this->videoFrameHeight;
-                yuvPlanes[2] = textureData + this->videoFrameWidth * this->videoFrameHeight / 4 * 5;
-
-                for (int i = 0; i < 3; i++) {
-                    int w = (i == 0 ? this->videoFrameWidth : this->videoFrameWidth / 2);
-                    int h = (i == 0 ? this->videoFrameHeight : this->videoFrameHeight / 2);
-                    glActiveTexture(GL_TEXTURE0 + i);
-                    glBindTexture(GL_TEXTURE_2D, yuvTexturesID[i]);
-                    if (firstTime) {
-                        glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, w, h, 0, GL_RED, GL_UNSIGNED_BYTE, static_cast<const GLvoid*>(yuvPlanes[i]));
-                        firstTime = true;
-                    } else {
-                        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_RED, GL_UNSIGNED_BYTE, static_cast<const GLvoid*>(yuvPlanes[i]));
-                    }
-                }
-            } else {
-                glBindTexture(GL_TEXTURE_2D, sceneTextureID);
+        if (fromMappedFrame) {
+            mappedFramePool->finishUpload(planes[0]);
+        } else if (fromPixelUnpackBuffer) {
+            pixelUnpackRing->finish();
+        }
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+        glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+        glCheckError();
+		return true;
+	}
+
+	/**
+	* dataеϴǰ󶨵2D, Ϊλ, shift㵽ϴƽ
+	* ǰúGL_UNPACK_ROW_LENGTH
+	*/
+	void Player::uploadRegions(const std::vector<TextureRegion> &regions, int shift, GLenum format, const unsigned char *data) {
+		for (size_t r = 0; r < regions.size(); r++) {
+			const TextureRegion &region = regions[r];
+			glPixelStorei(GL_UNPACK_SKIP_PIXELS, region.x >> shift);
+			glPixelStorei(GL_UNPACK_SKIP_ROWS, region.y >> shift);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, region.x >> shift, region.y >> shift, region.width >> shift, region.height >> shift,
+				format, GL_UNSIGNED_BYTE, static_cast<const GLvoid*>(data));
+		}
+	}
 
-                /*glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, videoFrameWidth, videoFrameHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, textureData);*/
+	/**
+	* 3x2ְһ֡е6ֱϴǰ󶨵cubemap, facesÿλöӦ
+	* ǰúGL_UNPACK_ROW_LENGTH, faceWidthformatϴƽ
+	*/
+	void Player::uploadCubeFaces(const GLenum *faces, int faceWidth, GLenum format, const unsigned char *data) {
+		for (int i = 0; i < 6; i++) {
+			glPixelStorei(GL_UNPACK_SKIP_ROWS, (i / 3) * faceWidth);
+			glPixelStorei(GL_UNPACK_SKIP_PIXELS, (i % 3) * faceWidth);
+			glTexSubImage2D(faces[i], 0, 0, 0, faceWidth, faceWidth, format, GL_UNSIGNED_BYTE, data);
+		}
+	}
 
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, videoFrameWidth, videoFrameHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, textureData);
+	/**
+	* һ֡ĸƽ濽PBOһPBO, uploadPlanesظƽPBOеƫ
+	* trueʱPBOְ, ϴҪpixelUnpackRing->finish(); ֧PBOʱfalse, ڴֱϴ
+	*/
+	bool Player::stageFrameInPixelUnpackRing(unsigned char * const *planes, const int *linesizes, unsigned char *uploadPlanes[3]) {
+		if (!pixelUnpackBuffers || !GLEW_ARB_sync) {
+			return false;
+		}
+		int planeCount = this->renderYUV ? yuvPlaneCount() : 1;
+		size_t planeBytes[3] = { 0, 0, 0 };
+		size_t frameBytes = 0;
+		for (int i = 0; i < planeCount; i++) {
+			int rows = (i == 0 ? this->videoFrameHeight : this->videoFrameHeight / 2);
+			planeBytes[i] = (size_t)linesizes[i] * rows;
+			frameBytes += planeBytes[i];
+		}
+		if (pixelUnpackRing == NULL) {
+			pixelUnpackRing = new PixelUnpackRing();
+		}
+		// ͬԴ֡пܲͬ, PBOʱ´
+		if (pixelUnpackRing->slotBytes() < frameBytes && !pixelUnpackRing->init(PIXEL_UNPACK_BUFFER_COUNT, frameBytes)) {
+			pixelUnpackBuffers = false;
+			return false;
+		}
+		uint8_t *mapped = pixelUnpackRing->map();
+		if (mapped == NULL) {
+			return false;
+		}
+		size_t offset = 0;
+		for (int i = 0; i < planeCount; i++) {
+			memcpy(mapped + offset, planes[i], planeBytes[i]);
+			uploadPlanes[i] = (unsigned char *)NULL + offset;
+			offset += planeBytes[i];
+		}
+		pixelUnpackRing->unmap();
+		return true;
+	}
 
-                /*unsigned int size = ((videoFrameWidth + 3) / 4)*((videoFrameHeight + 3) / 4) * 8;
-                glCompressedTexImage2D(GL_TEXTURE_2D, 0, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, videoFrameWidth, videoFrameHeight, 0, size, compressedTextureBuffer);*/
-            }
-        } else if (this->projectionMode == PM_TSP) {
-            glBindTexture(GL_TEXTURE_2D, sceneTextureID);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, videoFrameWidth, videoFrameHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, textureData);
-        }
+	/**
+	* ϴһ֡DXTѹ, GPUֱӲѹ, ҪCPUϽѹ
+	* Cubemap/EAC/ACPͼʱ3x2ϴ, ÿĿȿһ, ѹ, С
+	*/
+	bool Player::setupCompressedTextureData(const unsigned char *blocks, int size) {
+		GLenum internalFormat = dxtSource->format() == DXT_FORMAT_DXT1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		glUseProgram(sceneProgramID);
+		glCheckError();
+		if (isCubeProjection() && !cubeAtlas) {
+			const GLenum *faces = this->projectionMode == PM_CUBEMAP ? CUBEMAP_FACES : EAC_FACES;
 
-        glCheckError();
+			int width = videoFrameWidth / 3;
+			if (width % 4 != 0) {
+				// ı߽粻ڿı߽, ޷
+				std::cout << "The face width of a DXT cubemap must be a multiple of 4" << std::endl;
+				return false;
+			}
+			int blockBytes = dxtBlockBytes(dxtSource->format());
+			int blockColumns = (videoFrameWidth + 3) / 4;
+			int faceBlocks = width / 4;
+			int faceBytes = faceBlocks * faceBlocks * blockBytes;
+			dxtFaceBuffer.resize(faceBytes);
+
+			glBindTexture(GL_TEXTURE_CUBE_MAP, sceneTextureID);
+			for (int i = 0; i < 6; i++) {
+				int firstBlockColumn = (i % 3) * faceBlocks;
+				int firstBlockRow = (i / 3) * faceBlocks;
+				for (int row = 0; row < faceBlocks; row++) {
+					memcpy(&dxtFaceBuffer[row * faceBlocks * blockBytes],
+						blocks + ((size_t)(firstBlockRow + row) * blockColumns + firstBlockColumn) * blockBytes, faceBlocks * blockBytes);
+				}
+				if (!compressedTextureAllocated) {
+					glCompressedTexImage2D(faces[i], 0, internalFormat, width, width, 0, faceBytes, &dxtFaceBuffer[0]);
+				} else {
+					glCompressedTexSubImage2D(faces[i], 0, 0, 0, width, width, internalFormat, faceBytes, &dxtFaceBuffer[0]);
+				}
+			}
+		} else {
+			glBindTexture(GL_TEXTURE_2D, sceneTextureID);
+			if (!compressedTextureAllocated) {
+				glCompressedTexImage2D(GL_TEXTURE_2D, 0, internalFormat, videoFrameWidth, videoFrameHeight, 0, size, blocks);
+			} else {
+				glCompressedTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, videoFrameWidth, videoFrameHeight, internalFormat, size, blocks);
+			}
+		}
+		compressedTextureAllocated = true;
+		glCheckError();
 		return true;
 	}
 
@@ -1829,6 +2373,8 @@ namespace Player {
 
         if (this->videoFileType == VFT_YUV) {
             this->setRenderYUV(true);
+        } else if (this->videoFileType == VFT_DXT) {
+            this->setRenderYUV(false);
         }
         setupShaders();
 		setupCoordinates();
@@ -1962,11 +2508,9 @@ namespace Player {
                 "   gl_Position = matrix * position;\n"
                 "}\n";
             FRAGMENT_SHADER =
-                "#version 410 core\n"
                 "varying vec3 TexCoords;\n"
-                "uniform samplerCube mytexture;\n"
                 "void main() {\n"
-                "   gl_FragColor = texture(mytexture, TexCoords);\n"
+                "   gl_FragColor = sampleScene(TexCoords);\n"
                 "}\n";
         } else if (this->projectionMode == PM_ACP) {
             VERTEX_SHADER =
@@ -1979,13 +2523,11 @@ namespace Player {
                 "   gl_Position = matrix * position;\n"
                 "}\n"; 
             FRAGMENT_SHADER =
-                "#version 410 core\n"
                 "varying vec3 TexCoords;\n"
-                "uniform samplerCube mytexture;\n"
                 "void main() {\n"
-                "   gl_FragColor = texture(mytexture, TexCoords);\n"
+                "   gl_FragColor = sampleScene(TexCoords);\n"
                 "}\n";
-        } else if (this->projectionMode == PM_ERP) {
+        } else if (this->projectionMode == PM_ERP || this->projectionMode == PM_CPP) {
             VERTEX_SHADER =
                 "#version 410 core\n"
                 "uniform mat4 matrix;\n"
@@ -1997,32 +2539,11 @@ namespace Player {
                 "	gl_Position = matrix * position;\n"
                 "}\n";
 
-            if (this->renderYUV == true) {
-                FRAGMENT_SHADER =
-                    "#version 410 core\n"
-                    "precision mediump float;\n"
-                    "varying vec2 uvCoordsOut;\n"
-                    "uniform sampler2D y_tex;\n"
-                    "uniform sampler2D u_tex;\n"
-                    "uniform sampler2D v_tex;\n"
-                    "void main() {\n"
-                    "       float y = 1.164 * (texture2D(y_tex, uvCoordsOut).r - 0.0625);\n"
-                    "       float u = texture2D(u_tex, uvCoordsOut).r - 0.5;\n"
-                    "       float v = texture2D(v_tex, uvCoordsOut).r - 0.5;\n"
-                    "       gl_FragColor = vec4(y + 1.596 * v, "
-                    "                      y - 0.391 * u - 0.813 * v, "
-                    "                      y + 2.018 * u, "
-                    "                      1.0);\n"
-                    "}\n";
-            } else {
-                FRAGMENT_SHADER =
-                    "#version 410 core\n"
-                    "uniform sampler2D mytexture;\n"
-                    "in vec2 uvCoordsOut;\n"
-                    "void main() {\n"
-                    "	gl_FragColor = texture(mytexture,uvCoordsOut);\n"
-                    "}\n";
-            }
+            FRAGMENT_SHADER =
+                "in vec2 uvCoordsOut;\n"
+                "void main() {\n"
+                "	gl_FragColor = sampleScene(uvCoordsOut);\n"
+                "}\n";
         } else if (this->projectionMode == PM_TSP) {
             VERTEX_SHADER =
                 "#version 410 core\n"
@@ -2036,12 +2557,10 @@ namespace Player {
                 "}\n";
 
             FRAGMENT_SHADER =
-                "#version 410 core\n"
-                "uniform sampler2D mytexture;\n"
                 "in vec2 uvCoordsOut;\n"
                 "out vec4 outputColor;\n"
                 "void main() {\n"
-                "	outputColor = texture(mytexture,uvCoordsOut);\n"
+                "	outputColor = sampleScene(uvCoordsOut);\n"
                 "}\n";
             //FRAGMENT_SHADER =
             //    "#version 410 core\n"
@@ -2059,6 +2578,30 @@ namespace Player {
             //    "}\n";
         }
 
+        std::string proceduralShader;
+        if (drawsProcedurally()) {
+            proceduralShader = proceduralFragmentShader(this->projectionMode);
+            VERTEX_SHADER = (char *)PROCEDURAL_VERTEX_SHADER;
+            FRAGMENT_SHADER = (char *)proceduralShader.c_str();
+        }
+
+        // ƬԪɫֻsampleScene, Ĵ洢ʽ, YUVDXTǰƴĶ
+        std::string fragmentShader;
+        if (FRAGMENT_SHADER != NULL) {
+            SceneTextureStorage storage = STS_2D;
+            if (this->pagedTextures) {
+                storage = STS_PAGED;
+            } else if (samplesCubeAtlas()) {
+                storage = STS_CUBE_ATLAS;
+            } else if (isCubeProjection()) {
+                storage = STS_CUBEMAP;
+            }
+            fragmentShader = "#version 410 core\n";
+            fragmentShader += sceneSamplingFunctions(storage, this->renderYUV, this->videoFileType == VFT_DXT);
+            fragmentShader += FRAGMENT_SHADER;
+            FRAGMENT_SHADER = (char *)fragmentShader.c_str();
+        }
+
 		addShader(GL_VERTEX_SHADER, VERTEX_SHADER, sceneProgramID);
 		glCheckError();
 		addShader(GL_FRAGMENT_SHADER, FRAGMENT_SHADER, sceneProgramID);
@@ -2084,7 +2627,14 @@ namespace Player {
 	bool Player::setupTexture() {
 		glUseProgram(sceneProgramID);
         glCheckError();
-        if (this->projectionMode == PM_CUBEMAP || this->projectionMode == PM_EAC || this->projectionMode == PM_ACP) {
+        if (this->pagedTextures) {
+            if (!setupPagedTexture()) {
+                glUseProgram(0);
+                return false;
+            }
+        } else if (isCubeProjection() && !cubeAtlas && this->renderYUV) {
+            setupYuvTextures(GL_TEXTURE_CUBE_MAP, videoFrameWidth / 3, videoFrameWidth / 3);
+        } else if (isCubeProjection() && !cubeAtlas) {
             glGenTextures(1, &sceneTextureID);
 
             glBindTexture(GL_TEXTURE_CUBE_MAP, sceneTextureID);
@@ -2101,26 +2651,13 @@ namespace Player {
             glTexParameterf(GL_TEXTURE_CUBE_MAP, 
                 GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 
-            for (int i = 0; i < 6; i++) {
-                glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, videoFrameWidth/3, videoFrameWidth/3, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+            if (this->videoFileType != VFT_DXT) {
+                allocateTextureStorage(GL_TEXTURE_CUBE_MAP, GL_RGBA8, videoFrameWidth / 3, videoFrameWidth / 3);
             }
         } else if(this->projectionMode == PM_ERP){
             if (this->decodeType == DT_SOFTWARE) {
                 if (this->renderYUV) {
-                    glGenTextures(3, yuvTexturesID);
-                    for (int i = 0; i < 3; i++) {
-                        glUniform1i(glGetUniformLocation(sceneProgramID, TEXTURE_UNIFORMS[i]), i);
-                        glActiveTexture(GL_TEXTURE0 + i);
-                        glBindTexture(GL_TEXTURE_2D, yuvTexturesID[i]);
-                        glTexParameterf(GL_TEXTURE_2D,
-                            GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-                        glTexParameterf(GL_TEXTURE_2D,
-                            GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-                        glTexParameterf(GL_TEXTURE_2D,
-                            GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-                        glTexParameterf(GL_TEXTURE_2D,
-                            GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-                    }
+                    setupYuvTextures(GL_TEXTURE_2D, videoFrameWidth, videoFrameHeight);
                 } else {
                     glGenTextures(1, &sceneTextureID);
                     glUniform1i(glGetUniformLocation(sceneProgramID, "mytexture"), 0);
@@ -2133,6 +2670,9 @@ namespace Player {
                         GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
                     glTexParameterf(GL_TEXTURE_2D,
                         GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+                    if (this->videoFileType != VFT_DXT) {
+                        allocateTextureStorage(GL_TEXTURE_2D, GL_RGBA8, videoFrameWidth, videoFrameHeight);
+                    }
                 }
             } else if (this->decodeType == DT_HARDWARE) {
                 cudaDeviceProp prop;
@@ -2160,7 +2700,9 @@ namespace Player {
 
                 //glBindTexture(GL_TEXTURE_2D, 0);
             }
-        } else if (this->projectionMode == PM_TSP) {
+        } else if ((this->projectionMode == PM_TSP || this->projectionMode == PM_CPP || samplesCubeAtlas()) && this->renderYUV) {
+            setupYuvTextures(GL_TEXTURE_2D, videoFrameWidth, videoFrameHeight);
+        } else if (this->projectionMode == PM_TSP || this->projectionMode == PM_CPP || samplesCubeAtlas()) {
             glCheckError();
             glGenTextures(1, &sceneTextureID);
             glUniform1i(glGetUniformLocation(sceneProgramID, "mytexture"), 0);
@@ -2173,7 +2715,21 @@ namespace Player {
                 GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
             glTexParameterf(GL_TEXTURE_2D,
                 GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            //glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, videoFrameWidth, videoFrameHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+            if (this->videoFileType != VFT_DXT) {
+                allocateTextureStorage(GL_TEXTURE_2D, GL_RGBA8, videoFrameWidth, videoFrameHeight);
+            }
+        }
+        if (samplesCubeAtlas()) {
+            // atlasCells[ - GL_TEXTURE_CUBE_MAP_POSITIVE_X]Ǹ3x2еλ, ϴʱĶӦϵͬ
+            const GLenum *faces = this->projectionMode == PM_CUBEMAP ? CUBEMAP_FACES : EAC_FACES;
+            GLint atlasCells[6];
+            for (int i = 0; i < 6; i++) {
+                atlasCells[faces[i] - GL_TEXTURE_CUBE_MAP_POSITIVE_X] = i;
+            }
+            glUniform1iv(glGetUniformLocation(sceneProgramID, "atlasCells"), 6, atlasCells);
+        }
+        if (drawsProcedurally() && this->projectionMode == PM_CPP) {
+            glUniform1f(glGetUniformLocation(sceneProgramID, "frameAspect"), 1.0f * videoFrameHeight / videoFrameWidth);
         }
 
 		glUseProgram(0);
@@ -2181,16 +2737,109 @@ namespace Player {
 		return true;
 	}
 
-    void fast_unpack(char* rgba, const char* rgb, const int count) {
-        if (count == 0)
-            return;
-        for (int i = count; --i; rgba += 4, rgb += 3) {
-            *(uint32_t*)(void*)rgba = *(const uint32_t*)(const void*)rgb;
-        }
-        for (int j = 0; j < 3; ++j) {
-            rgba[j] = rgb[j];
-        }
-    }
+	/**
+	* ǰ󶨵䲻ɱ洢, ֮ÿֻ֡glTexSubImage2D, ·
+	* ֧ARB_texture_storageʱ˻glTexImage2D(..., NULL)
+	*/
+	void Player::allocateTextureStorage(GLenum target, GLenum internalFormat, int width, int height) {
+		if (GLEW_ARB_texture_storage) {
+			glTexStorage2D(target, 1, internalFormat, width, height);
+		} else {
+			GLenum format = internalFormat == GL_R8 ? GL_RED : (internalFormat == GL_RG8 ? GL_RG : rgbUploadFormat());
+			if (target == GL_TEXTURE_CUBE_MAP) {
+				for (int i = 0; i < 6; i++) {
+					glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, internalFormat, width, height, 0, format, GL_UNSIGNED_BYTE, NULL);
+				}
+			} else {
+				glTexImage2D(target, 0, internalFormat, width, height, 0, format, GL_UNSIGNED_BYTE, NULL);
+			}
+		}
+		glCheckError();
+	}
+
+	/**
+	* YUVģʽµy_tex/u_tex/v_texƽ, targetΪGL_TEXTURE_2DGL_TEXTURE_CUBE_MAP,
+	* width/heightƽ(cubemapʱÿ)ĳߴ; NV12ɫֻu_texһGL_RG8
+	*/
+	void Player::setupYuvTextures(GLenum target, int width, int height) {
+		glGenTextures(3, yuvTexturesID);
+		for (int i = 0; i < 3; i++) {
+			glUniform1i(glGetUniformLocation(sceneProgramID, TEXTURE_UNIFORMS[i]), i);
+			glActiveTexture(GL_TEXTURE0 + i);
+			glBindTexture(target, yuvTexturesID[i]);
+			glTexParameterf(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameterf(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexParameterf(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameterf(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			if (target == GL_TEXTURE_CUBE_MAP) {
+				glTexParameterf(target, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+			}
+			if (i < yuvPlaneCount()) {
+				int shift = (i == 0 ? 0 : 1);
+				allocateTextureStorage(target, yuvPlaneFormat(i) == GL_RG ? GL_RG8 : GL_R8, width >> shift, height >> shift);
+			}
+		}
+		glUniform1i(glGetUniformLocation(sceneProgramID, "yuvNV12"), yuvFrameLayout == YCL_NV12 ? 1 : 0);
+		glActiveTexture(GL_TEXTURE0);
+	}
+
+	/**
+	* ڴɫǰǷʹ÷ҳ: ֡GL_MAX_TEXTURE_SIZEʱԶ
+	* ֻERP/TSP֧, DXT֡ϴ, ӲCUDAдһ֡
+	*/
+	void Player::setupPagedTextureMode() {
+		GLint maxTextureSize = 0;
+		glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+		if (!pagedTextures && (videoFrameWidth > maxTextureSize || videoFrameHeight > maxTextureSize)) {
+			std::cout << "Frame " << videoFrameWidth << "x" << videoFrameHeight << " exceeds GL_MAX_TEXTURE_SIZE " << maxTextureSize
+				<< ", using paged textures" << std::endl;
+			pagedTextures = true;
+		}
+		if (pagedTextures && ((projectionMode != PM_ERP && projectionMode != PM_TSP) || videoFileType == VFT_DXT || decodeType != DT_SOFTWARE)) {
+			std::cout << "Paged textures only support software decoded ERP/TSP frames" << std::endl;
+			pagedTextures = false;
+		}
+	}
+
+	/**
+	* ҳ, YUVģʽÿƽһ, mytextureһRGBA
+	*/
+	bool Player::setupPagedTexture() {
+		int planeCount = this->renderYUV ? yuvPlaneCount() : 1;
+		GLenum internalFormats[3];
+		GLenum formats[3];
+		int bytesPerPixel[3];
+		int chromaShifts[3];
+		const char *samplerNames[3];
+		for (int i = 0; i < planeCount; i++) {
+			if (this->renderYUV) {
+				formats[i] = yuvPlaneFormat(i);
+				internalFormats[i] = (formats[i] == GL_RG ? GL_RG8 : GL_R8);
+				bytesPerPixel[i] = (formats[i] == GL_RG ? 2 : 1);
+				chromaShifts[i] = (i == 0 ? 0 : 1);
+				samplerNames[i] = TEXTURE_UNIFORMS[i];
+			} else {
+				formats[i] = rgbUploadFormat();
+				internalFormats[i] = GL_RGBA8;
+				bytesPerPixel[i] = 4;
+				chromaShifts[i] = 0;
+				samplerNames[i] = "mytexture";
+			}
+		}
+		if (pagedTexture == NULL) {
+			pagedTexture = new PagedTexture();
+		}
+		if (!pagedTexture->init(videoFrameWidth, videoFrameHeight, PAGED_TEXTURE_PAGE_SIZE, planeCount, internalFormats, formats, bytesPerPixel,
+			chromaShifts, (size_t)PAGED_TEXTURE_BUDGET_MB * 1024 * 1024, sceneProgramID, samplerNames, 0, this->projectionMode == PM_ERP)) {
+			std::cout << __FUNCTION__ << "- Failed to create paged textures." << std::endl;
+			return false;
+		}
+		if (this->renderYUV) {
+			glUniform1i(glGetUniformLocation(sceneProgramID, "yuvNV12"), yuvFrameLayout == YCL_NV12 ? 1 : 0);
+		}
+		std::cout << "Paged texture: " << pagedTexture->pageCount() << " pages, " << pagedTexture->layerCount() << " resident layers" << std::endl;
+		return true;
+	}
 
 	bool Player::decodeOneFrame() {
 		if (this->videoFileType == VFT_Encoded && this->decodeType == DT_SOFTWARE) {
@@ -2203,16 +2852,38 @@ namespace Player {
 			if (packet.stream_index == videoStreamIndex) {
 				avcodec_decode_video2(pCodecContext, pFrame, &frameFinished, &packet);
 				if (frameFinished) {
-                    sws_scale(swsContext, (uint8_t const *const *)pFrame->data,
-                        pFrame->linesize, 0, pCodecContext->height,
-                        pFrameRGB->data, pFrameRGB->linesize);
-                    avpicture_layout((AVPicture *)pFrameRGB, AV_PIX_FMT_RGB24, pCodecContext->width, pCodecContext->height, decodedRGB24Buffer, numberOfBytesPerFrame);
-
-                    
-                    fast_unpack((char *)decodedRGBABuffer, (const char *)decodedRGB24Buffer, pCodecContext->width * pCodecContext->height);
+                    if (dxtEncoder == NULL) {
+                        if (workerPool == NULL) {
+                            workerPool = new ThreadPool(sliceCount > 0 ? sliceCount : ThreadPool::hardwareThreadCount());
+                        }
+                        dxtEncoder = new DxtEncoder(workerPool);
+                        if (!dxtEncoder->init(pCodecContext->width, pCodecContext->height, DXT_FORMAT_DXT1, dxtQuality)) {
+                            // runDxtConversionгʼʧʱһ޷, ļѾ
+                            std::cout << "Failed to init dxtEncoder" << std::endl;
+                            delete dxtEncoder;
+                            dxtEncoder = NULL;
+                            av_free_packet(&packet);
+                            allFrameRead = true;
+                            return false;
+                        }
+                        compressedTextureBuffer = new uint8_t[dxtEncoder->frameBytes()];
+                    }
+                    // YUV420P/NV12ֱӰתѹ, ֡RGBA
+                    YuvChromaLayout chromaLayout;
+                    if (yuvChromaLayout(pCodecContext->pix_fmt, &chromaLayout)) {
+                        dxtEncoder->encodeYUV420(pFrame->data, pFrame->linesize, chromaLayout, compressedTextureBuffer);
+                    } else {
+                        if (dxtRGBABuffer == NULL) {
+                            dxtRGBABuffer = (uint8_t *)av_malloc(pCodecContext->width * pCodecContext->height * 4);
+                        }
+                        uint8_t *rgbaPlanes[4] = { dxtRGBABuffer, NULL, NULL, NULL };
+                        int rgbaLinesizes[4] = { pCodecContext->width * 4, 0, 0, 0 };
+                        swsContext = sws_getCachedContext(swsContext, pCodecContext->width, pCodecContext->height, pCodecContext->pix_fmt,
+                            pCodecContext->width, pCodecContext->height, AV_PIX_FMT_RGBA, SWS_BILINEAR, NULL, NULL, NULL);
+                        sws_scale(swsContext, (uint8_t const *const *)pFrame->data, pFrame->linesize, 0, pCodecContext->height, rgbaPlanes, rgbaLinesizes);
+                        dxtEncoder->encode(dxtRGBABuffer, compressedTextureBuffer);
+                    }
 
-                    rygCompress(compressedTextureBuffer, decodedRGBABuffer, pCodecContext->width, pCodecContext->height,0);
-                    
 
 					av_free_packet(&packet);
 					return true;
@@ -2269,8 +2940,7 @@ namespace Player {
 		SDL_StartTextInput();
 		timeMeasurer->Start();
 		while (!bQuit && !allFrameRead) {
-			if (decodeOneFrame()) {
-				this->drawFrame();
+			if (decodeOneFrame() && this->drawFrame()) {
 				frameIndex++;
 			}
             bQuit = handleInput();
@@ -2460,7 +3130,7 @@ namespace Player {
 				float x = 0.0f;
 				float y = radius;
 				float u = 0.5f;
-				float v = 1.0f;
+				float v = 0.0f;
 				VertexStruct vertexStruct(x, y, z, u, v);
 				verts.push_back(vertexStruct);
 				allVerts.push_back(verts);
@@ -2470,7 +3140,7 @@ namespace Player {
 				float x = 0;
 				float y = -radius;
 				float u = 0.5f;
-				float v = 0.0f;
+				float v = 1.0f;
 				VertexStruct vertexStruct(x, y, z, u, v);
 				verts.push_back(vertexStruct);
 				allVerts.push_back(verts);
@@ -2517,48 +3187,11 @@ namespace Player {
 
 		this->organizeVerts(allVerts);
 
-		glGenVertexArrays(1, &sceneVAO);
-		glBindVertexArray(sceneVAO);
-
-		int vertexDataSize = this->vertexVector.size() * sizeof(float);
-		int uvDataSize = this->uvVector.size() * sizeof(float);
-
-		glGenBuffers(1, &sceneVertexBuffer);
-		glBindBuffer(GL_ARRAY_BUFFER, sceneVertexBuffer);
-		glBufferData(GL_ARRAY_BUFFER, vertexDataSize, &this->vertexVector[0], GL_STATIC_DRAW);
-
-		glGenBuffers(1, &sceneUVBuffer);
-		glBindBuffer(GL_ARRAY_BUFFER, sceneUVBuffer);
-		glBufferData(GL_ARRAY_BUFFER, uvDataSize, &this->uvVector[0], GL_STATIC_DRAW);
-
-		glBindVertexArray(0);
+		uploadSceneMesh("CPP", &this->vertexVector[0], &this->uvVector[0], 2, (int)this->vertexVector.size() / 3, NULL, 0);
 		glCheckError();
 		return true;
 	}
 
-	void Player::drawFrameCppEqualDistance() {
-		glViewport(0, 0, windowWidth, windowHeight);
-		glDisable(GL_DEPTH_TEST);
-
-		computeMVPMatrix();
-		glUseProgram(sceneProgramID);
-		glCheckError();
-
-		glUniformMatrix4fv(sceneMVPMatrixPointer, 1, GL_FALSE, &mvpMatrix[0][0]);
-		glBindVertexArray(sceneVAO);
-
-		glBindBuffer(GL_ARRAY_BUFFER, sceneVertexBuffer);
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (const void *)0);
-
-		glBindBuffer(GL_ARRAY_BUFFER, sceneUVBuffer);
-		glEnableVertexAttribArray(1);
-		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, (const void *)0);
-
-		glDrawArrays(GL_TRIANGLES, 0, this->vertexVector.size() / 3);
-		glBindVertexArray(0);
-
-	}
 
 	void Player::computeCppEqualDistanceUVCoordinates(float x, float y, float &u, float &v) {
 		x += this->videoFrameWidth / 2;
@@ -2574,16 +3207,13 @@ namespace Player {
 namespace Player {
 	void Player::setupThread()
 {
+		setupViewportUploads();
+		setupTileHasher();
 		int ret = pthread_create(&decodeThread, NULL, decodeFunc,&(*this));
 		if (ret != 0) {
 			std::cout << "Pthread_create error" << std::endl;
 		}
 
-		sem_init(&decodeOneFrameFinishedSemaphore, 0, 0);
-		sem_init(&decodeAllFramesFinishedSemaphore, 0, 0);
-		sem_init(&renderFinishedSemaphore, 0, 1);
-
-		lock = PTHREAD_MUTEX_INITIALIZER;
 	}
 
 	void Player::destoryThread() {
@@ -2599,79 +3229,27 @@ namespace Player {
 		std::cout << "decodeFunc" << std::endl;
 		Player *player = (Player *)args;
 		if (player->videoFileType == VFT_Encoded && player->decodeType == DT_SOFTWARE) {
-
-            if (player->repeatRendering) {
-
-                while (true) {
-                    while (av_read_frame(player->pFormatContext, &player->packet) >= 0) {
-                        if (player->packet.stream_index == player->videoStreamIndex) {
-                            avcodec_decode_video2(player->pCodecContext, player->pFrame, &player->frameFinished, &player->packet);
-                            if (player->frameFinished) {
-                                if (player->renderYUV) {
-                                    sem_wait(&player->renderFinishedSemaphore);
-
-                                    pthread_mutex_lock(&player->lock);
-                                    avpicture_layout((AVPicture *)player->pFrame, AV_PIX_FMT_YUV420P, player->pCodecContext->width, player->pCodecContext->height, player->decodedYUVBuffer, player->numberOfBytesPerFrame);
-                                    pthread_mutex_unlock(&player->lock);
-
-                                } else {
-                                    sws_scale(player->swsContext, (uint8_t const* const *)player->pFrame->data, player->pFrame->linesize, 0, player->pCodecContext->height, player->pFrameRGB->data, player->pFrameRGB->linesize);
-
-                                    sem_wait(&player->renderFinishedSemaphore);
-
-                                    pthread_mutex_lock(&player->lock);
-                                    //avpicture_layout((AVPicture *)player->pFrame, AV_PIX_FMT_YUV420P, player->pCodecContext->width, player->pCodecContext->height, player->decodedYUVBuffer, player->numberOfBytesPerFrame);
-                                    avpicture_layout((AVPicture *)player->pFrameRGB, AV_PIX_FMT_RGB24, player->pCodecContext->width, player->pCodecContext->height, player->decodedRGB24Buffer, player->numberOfBytesPerFrame);
-
-                                    pthread_mutex_unlock(&player->lock);
-                                }
-
-                                av_free_packet(&player->packet);
-
-                                sem_post(&player->decodeOneFrameFinishedSemaphore);
-                            }
+            while (player->runSoftwarePipeline() && player->repeatRendering) {
+                if (player->frameCache != NULL) {
+                    player->frameCache->finishRecording();
+                    if (player->frameCache->isComplete()) {
+                        // һ֡ڻ, ֮ѭֱӴӻȡ֡
+                        int index = 0;
+                        while (player->pushCachedFrame(index)) {
+                            index = (index + 1) % player->frameCache->frameCount();
                         }
+                        break;
                     }
-                    av_seek_frame(player->pFormatContext, -1, 0, AVSEEK_FLAG_BACKWARD);
                 }
-                
-            } else {
-                while (av_read_frame(player->pFormatContext, &player->packet) >= 0) {
-                    if (player->packet.stream_index == player->videoStreamIndex) {
-                        avcodec_decode_video2(player->pCodecContext, player->pFrame, &player->frameFinished, &player->packet);
-                        if (player->frameFinished) {
-                            if (player->renderYUV) {
-                                sem_wait(&player->renderFinishedSemaphore);
-
-                                pthread_mutex_lock(&player->lock);
-                                avpicture_layout((AVPicture *)player->pFrame, AV_PIX_FMT_YUV420P, player->pCodecContext->width, player->pCodecContext->height, player->decodedYUVBuffer, player->numberOfBytesPerFrame);
-                                pthread_mutex_unlock(&player->lock);
-
-                            } else {
-                                sws_scale(player->swsContext, (uint8_t const* const *)player->pFrame->data, player->pFrame->linesize, 0, player->pCodecContext->height, player->pFrameRGB->data, player->pFrameRGB->linesize);
-
-                                sem_wait(&player->renderFinishedSemaphore);
-
-                                pthread_mutex_lock(&player->lock);
-                                //avpicture_layout((AVPicture *)player->pFrame, AV_PIX_FMT_YUV420P, player->pCodecContext->width, player->pCodecContext->height, player->decodedYUVBuffer, player->numberOfBytesPerFrame);
-                                avpicture_layout((AVPicture *)player->pFrameRGB, AV_PIX_FMT_RGB24, player->pCodecContext->width, player->pCodecContext->height, player->decodedRGB24Buffer, player->numberOfBytesPerFrame);
-
-                                pthread_mutex_unlock(&player->lock);
-                            }
-
-                            av_free_packet(&player->packet);
-
-                            sem_post(&player->decodeOneFrameFinishedSemaphore);
-                        }
-                    }
-                }
-                player->allFrameRead = true;
-                sem_post(&player->decodeAllFramesFinishedSemaphore);
-                std::cout << "decodeAllFramesFinished" << std::endl;
-                pthread_exit(NULL);
+                // ûܴļ, ͷ½
+                av_seek_frame(player->pFormatContext, -1, 0, AVSEEK_FLAG_BACKWARD);
+                avcodec_flush_buffers(player->pCodecContext);
             }
 
-			
+            player->frameRing->close();
+            sem_post(&player->decodeAllFramesFinishedSemaphore);
+            std::cout << "decodeAllFramesFinished" << std::endl;
+            pthread_exit(NULL);
 		} else if (player->videoFileType == VFT_Encoded && player->decodeType == DT_HARDWARE) {
 			while (true) {
 				int readSuccess = av_read_frame(player->pFormatContext, &player->packet);
@@ -2699,37 +3277,587 @@ namespace Player {
 				}
 			}
 		} else if (player->videoFileType == VFT_YUV) {
+			int index = 0;
 			while (true) {
-                if (player->repeatRendering) {
-                    static std::streampos pos = player->videoFrameHeight * player->videoFrameWidth * 3 / 2;
-                    if (player->videoFileInputStream.peek() == EOF) {
+                bool endOfFile;
+                if (player->yuvSource != NULL) {
+                    endOfFile = index >= player->yuvSource->frameCount();
+                } else if (player->partialYUVReader != NULL) {
+                    endOfFile = index >= player->partialYUVReader->frameCount();
+                } else {
+                    endOfFile = player->videoFileInputStream.peek() == EOF;
+                }
+                if (endOfFile) {
+                    if (!player->repeatRendering || index == 0) {
+                        break;
+                    }
+                    index = 0;
+                    if (player->videoFileInputStream.is_open()) {
+                        player->videoFileInputStream.clear();
                         player->videoFileInputStream.seekg(0, std::ios_base::beg);
                     }
-                    sem_wait(&player->renderFinishedSemaphore);
-                    pthread_mutex_lock(&player->lock);
-                    player->videoFileInputStream.read((char *)player->decodedYUVBuffer, pos);
-                    player->videoFileInputStream.seekg(pos, std::ios_base::cur);
-                    pthread_mutex_unlock(&player->lock);
-                    sem_post(&player->decodeOneFrameFinishedSemaphore);
+                }
+                bool pushed;
+                if (player->yuvSource != NULL) {
+                    pushed = player->pushMappedYUVFrame(index);
+                } else if (player->partialYUVReader != NULL) {
+                    pushed = player->pushPartialYUVFrame(index);
                 } else {
-                    if (player->videoFileInputStream.peek() == EOF) {
-                        player->allFrameRead = true;
-                        sem_post(&player->decodeAllFramesFinishedSemaphore);
-                        pthread_exit(NULL);
-                    }
-                    static std::streampos pos = player->videoFrameHeight * player->videoFrameWidth * 3 / 2;
-                    sem_wait(&player->renderFinishedSemaphore);
-                    pthread_mutex_lock(&player->lock);
-                    player->videoFileInputStream.read((char *)player->decodedYUVBuffer, pos);
-                    player->videoFileInputStream.seekg(pos, std::ios_base::cur);
-                    pthread_mutex_unlock(&player->lock);
-                    sem_post(&player->decodeOneFrameFinishedSemaphore);
+                    pushed = player->pushYUVFileFrame(index);
                 }
+                if (!pushed) {
+                    break;
+                }
+                index++;
+			}
+            player->frameRing->close();
+            sem_post(&player->decodeAllFramesFinishedSemaphore);
+            pthread_exit(NULL);
+		} else if (player->videoFileType == VFT_DXT) {
+			// ѹֱӳļ, ֻ߳˳֡Ⱦ߳
+			int index = 0;
+			while (true) {
+				if (index >= player->dxtSource->frameCount()) {
+					if (!player->repeatRendering || index == 0) {
+						break;
+					}
+					index = 0;
+				}
+				if (!player->pushDxtFrame(index)) {
+					break;
+				}
+				index++;
+			}
+			player->frameRing->close();
+			sem_post(&player->decodeAllFramesFinishedSemaphore);
+			pthread_exit(NULL);
+		}
+		return NULL;
+	}
+
+	/**
+	* һˮ, ֱļȾ̹߳رframeRing
+	* falseʾframeRingѹر
+	*/
+	bool Player::runSoftwarePipeline() {
+		packetQueue = new BoundedQueue<AVPacket *>(PACKET_QUEUE_SIZE);
+		decodedFrameQueue = new BoundedQueue<AVFrame *>(DECODED_FRAME_QUEUE_SIZE);
+
+		pthread_create(&demuxThread, NULL, demuxFunc, this);
+		pthread_create(&convertThread, NULL, convertFunc, this);
+		runDecodeStage();
+		pthread_join(demuxThread, NULL);
+		pthread_join(convertThread, NULL);
+
+		// ǰ˳ʱпܻûİ֡
+		AVPacket *remainingPacket = NULL;
+		while (packetQueue->tryPop(remainingPacket)) {
+			av_packet_free(&remainingPacket);
+		}
+		AVFrame *remainingFrame = NULL;
+		while (decodedFrameQueue->tryPop(remainingFrame)) {
+			av_frame_free(&remainingFrame);
+		}
+		delete packetQueue;
+		packetQueue = NULL;
+		delete decodedFrameQueue;
+		decodedFrameQueue = NULL;
+
+		return !frameRing->isClosed();
+	}
+
+	/**
+	* װ׶: ȡƵİpacketQueue
+	* repeatģʽ¶βͷʼ, ڼ¼һʱβͽ
+	*/
+	void * Player::demuxFunc(void *args) {
+		Player *player = (Player *)args;
+		player->demuxTimer.start();
+		while (true) {
+			AVPacket *packet = av_packet_alloc();
+			if (av_read_frame(player->pFormatContext, packet) < 0) {
+				av_packet_free(&packet);
+				if (!player->repeatRendering || (player->frameCache != NULL && player->frameCache->isRecording())) {
+					break;
+				}
+				av_seek_frame(player->pFormatContext, -1, 0, AVSEEK_FLAG_BACKWARD);
+				continue;
+			}
+			if (packet->stream_index != player->videoStreamIndex) {
+				av_packet_free(&packet);
+				continue;
+			}
+
+			player->demuxTimer.beginIdle();
+			bool queued = player->packetQueue->push(packet);
+			player->demuxTimer.endIdle();
+			if (!queued) {
+				av_packet_free(&packet);
+				break;
+			}
+			player->demuxTimer.finishItem();
+		}
+		player->packetQueue->close();
+		player->demuxTimer.stop();
+		return NULL;
+	}
+
+	/**
+	* ׶: packetQueueȡ, ֡decodedFrameQueue
+	*/
+	void Player::runDecodeStage() {
+		decodeTimer.start();
+		bool stopped = false;
+		AVPacket *packet = NULL;
+		while (!stopped) {
+			decodeTimer.beginIdle();
+			bool popped = packetQueue->pop(packet);
+			decodeTimer.endIdle();
+			if (!popped) {
+				break;
+			}
+			avcodec_decode_video2(pCodecContext, pFrame, &frameFinished, packet);
+			av_packet_free(&packet);
+			if (frameFinished && !queueDecodedFrame()) {
+				stopped = true;
+			}
+		}
+
+		if (!stopped) {
+			// ļÿհѽڲ֡ȡ
+			AVPacket flushPacket;
+			av_init_packet(&flushPacket);
+			flushPacket.data = NULL;
+			flushPacket.size = 0;
+			do {
+				avcodec_decode_video2(pCodecContext, pFrame, &frameFinished, &flushPacket);
+			} while (frameFinished && queueDecodedFrame());
+		}
+
+		decodedFrameQueue->close();
+		// ǰ˳ʱýװ߳һpushʱ
+		packetQueue->close();
+		decodeTimer.stop();
+	}
+
+	/**
+	* pFrameתת׶, йرʱfalse
+	*/
+	bool Player::queueDecodedFrame() {
+		AVFrame *frame = av_frame_alloc();
+		av_frame_move_ref(frame, pFrame);
+
+		decodeTimer.beginIdle();
+		bool queued = decodedFrameQueue->push(frame);
+		decodeTimer.endIdle();
+		if (!queued) {
+			av_frame_free(&frame);
+			return false;
+		}
+		decodeTimer.finishItem();
+		return true;
+	}
+
+	/**
+	* ת׶: ѽ֡תȾҪĸʽдframeRing
+	*/
+	void * Player::convertFunc(void *args) {
+		Player *player = (Player *)args;
+		player->convertTimer.start();
+		AVFrame *frame = NULL;
+		while (true) {
+			player->convertTimer.beginIdle();
+			bool popped = player->decodedFrameQueue->pop(frame);
+			player->convertTimer.endIdle();
+			if (!popped) {
+				break;
+			}
+			bool pushed = player->pushDecodedFrame(frame);
+			av_frame_free(&frame);
+			if (!pushed) {
+				break;
 			}
+			player->convertTimer.finishItem();
 		}
+		// Ⱦ߳˳ʱframeRingѹر, ٹرζý׶Ҳ
+		// frameRingdecodeFuncѭر
+		player->decodedFrameQueue->close();
+		player->convertTimer.stop();
 		return NULL;
 	}
 
+	/**
+	* һ֡д֡еĿвλ, йرʱfalse
+	*/
+	bool Player::pushDecodedFrame(AVFrame *frame) {
+		convertTimer.beginIdle();
+		FrameSlot *slot = frameRing->acquireWriteSlot();
+		convertTimer.endIdle();
+		if (slot == NULL) {
+			return false;
+		}
+
+		if (renderYUV) {
+			// ֻü, Ⱦֱ߳Ӱlinesizeϴƽ
+			av_frame_ref(slot->frame, frame);
+			for (int i = 0; i < 3; i++) {
+				slot->planes[i] = slot->frame->data[i];
+				slot->linesizes[i] = slot->frame->linesize[i];
+			}
+		} else {
+			// ֱӰתдλ, ʡȥһavpicture_layout
+			int rgbLinesize = pCodecContext->width * 4;
+			if (!convertToRGB(frame->data, frame->linesize, (AVPixelFormat)frame->format, slot->buffer, rgbLinesize, uploadBGRA ? RPL_BGRA : RPL_RGBA)) {
+				avpicture_fill((AVPicture *)pFrameRGB, slot->buffer, uploadBGRA ? AV_PIX_FMT_BGRA : AV_PIX_FMT_RGBA, pCodecContext->width, pCodecContext->height);
+				slicedScaler->scale((uint8_t const* const *)frame->data, frame->linesize, pFrameRGB->data, pFrameRGB->linesize);
+				rgbLinesize = pFrameRGB->linesize[0];
+			}
+			slot->planes[0] = slot->buffer;
+			slot->linesizes[0] = rgbLinesize;
+		}
+
+		slot->frameIndex = decodedFrameCount++;
+		slot->pts = av_frame_get_best_effort_timestamp(frame);
+		hashFrameTiles(slot);
+		if (frameCache != NULL) {
+			storeFrameInCache(slot);
+			frameCache->recordMiss();
+		}
+		frameRing->commitWriteSlot(slot);
+		return true;
+	}
+
+	/**
+	* һ鲥ʱѲλתõ֡еش뻺
+	*/
+	void Player::storeFrameInCache(FrameSlot *slot) {
+		if (!frameCache->isRecording()) {
+			return;
+		}
+		if (renderYUV) {
+			int chromaRowBytes = yuvFrameLayout == YCL_NV12 ? videoFrameWidth : videoFrameWidth / 2;
+			int rowBytes[3] = { videoFrameWidth, chromaRowBytes, chromaRowBytes };
+			int rows[3] = { videoFrameHeight, videoFrameHeight / 2, videoFrameHeight / 2 };
+			frameCache->store(slot->planes, slot->linesizes, rowBytes, rows, yuvPlaneCount(), slot->pts);
+		} else {
+			int rowBytes[1] = { videoFrameWidth * 4 };
+			int rows[1] = { videoFrameHeight };
+			frameCache->store(slot->planes, slot->linesizes, rowBytes, rows, 1, slot->pts);
+		}
+	}
+
+	// YUV420P/NV12ضӦɫ, ظʽfalse
+	bool Player::yuvChromaLayout(AVPixelFormat pixelFormat, YuvChromaLayout *chromaLayout) {
+		if (pixelFormat == AV_PIX_FMT_YUV420P || pixelFormat == AV_PIX_FMT_YUVJ420P) {
+			*chromaLayout = YCL_PLANAR;
+		} else if (pixelFormat == AV_PIX_FMT_NV12) {
+			*chromaLayout = YCL_NV12;
+		} else {
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	* YUV420P/NV12֡һתRGBA/BGRA, workerPoolϰ, ظʽfalse
+	*/
+	bool Player::convertToRGB(const uint8_t * const *planes, const int *linesizes, AVPixelFormat pixelFormat,
+		uint8_t *dst, int dstLinesize, RgbPixelLayout pixelLayout) {
+		if (kernelDevice == CpuKernels::KD_CPU && convertWithCpuKernels(planes, linesizes, pixelFormat, dst, dstLinesize, pixelLayout)) {
+			return true;
+		}
+		YuvChromaLayout chromaLayout;
+		if (!yuvChromaLayout(pixelFormat, &chromaLayout)) {
+			return false;
+		}
+		yuv420_to_rgb(planes, linesizes, chromaLayout, dst, dstLinesize, pixelLayout, videoFrameWidth, videoFrameHeight, workerPool);
+		return true;
+	}
+
+	/**
+	* ûCUDA豸-kernels 2ʱ, YUV420P, NV12P010֡CpuKernelsת, ظʽfalse
+	* 뷶Χֻɫʿռ, RGBABGRAɫͬ: ûбʱBT.601ƷΧ,
+	* yuv420_to_rgbԼYUVģʽɫһ
+	*/
+	bool Player::convertWithCpuKernels(const uint8_t * const *planes, const int *linesizes, AVPixelFormat pixelFormat,
+		uint8_t *dst, int dstLinesize, RgbPixelLayout pixelLayout) {
+		bool planar = pixelFormat == AV_PIX_FMT_YUV420P || pixelFormat == AV_PIX_FMT_YUVJ420P;
+		bool nv12 = pixelFormat == AV_PIX_FMT_NV12;
+		// P01010λڸλ, ֱӰP016ת
+		bool p016 = pixelFormat == AV_PIX_FMT_P010LE;
+		if ((!planar && !nv12 && !p016) || pixelLayout == RPL_RGB24 || (planar && linesizes[1] != linesizes[2])) {
+			return false;
+		}
+		int matrix = CpuKernels::ColorSpaceStandard_BT601;
+		if (pCodecContext->colorspace == AVCOL_SPC_BT709) {
+			matrix = CpuKernels::ColorSpaceStandard_BT709;
+		} else if (pCodecContext->colorspace == AVCOL_SPC_BT2020_NCL || pCodecContext->colorspace == AVCOL_SPC_BT2020_CL) {
+			matrix = CpuKernels::ColorSpaceStandard_BT2020;
+		}
+		bool fullRange = pCodecContext->color_range == AVCOL_RANGE_JPEG || pixelFormat == AV_PIX_FMT_YUVJ420P;
+		bool rgba = pixelLayout == RPL_RGBA;
+		if (p016) {
+			CpuKernels::P016ToRgba32(planes[0], linesizes[0], planes[1], linesizes[1], dst, dstLinesize, videoFrameWidth, videoFrameHeight,
+				matrix, fullRange, rgba, workerPool);
+		} else {
+			CpuKernels::Yuv420ToRgba32(planes[0], linesizes[0], planes[1], planar ? planes[2] : NULL, linesizes[1], dst, dstLinesize,
+				videoFrameWidth, videoFrameHeight, matrix, fullRange, rgba, workerPool);
+		}
+		return true;
+	}
+
+	/**
+	* ѻеĵindex֡д֡еĿвλ, δѹʱλֱָ򻺴, йرʱfalse
+	*/
+	bool Player::pushCachedFrame(int index) {
+		FrameSlot *slot = frameRing->acquireWriteSlot();
+		if (slot == NULL) {
+			return false;
+		}
+
+		const uint8_t *data = NULL;
+		int64_t pts = 0;
+		if (!frameCache->fetch(index, slot->buffer, slot->bufferSize, &data, &pts)) {
+			std::cout << "Failed to fetch frame " << index << " from frameCache" << std::endl;
+			frameRing->cancelWriteSlot(slot);
+			return false;
+		}
+		fillContiguousPlanes((unsigned char *)data, slot->planes, slot->linesizes);
+		hashFrameTiles(slot);
+
+		slot->frameIndex = decodedFrameCount++;
+		slot->pts = pts;
+		frameRing->commitWriteSlot(slot);
+		return true;
+	}
+
+	/**
+	* YUVļжȡindex֡д֡еĿвλ, йرʱfalse
+	* ֻڴӳʧʱʹ, ֤߱ļ˳ȡ
+	*/
+	bool Player::pushYUVFileFrame(int index) {
+		FrameSlot *slot = frameRing->acquireWriteSlot();
+		if (slot == NULL) {
+			return false;
+		}
+
+		videoFileInputStream.read((char *)slot->buffer, numberOfBytesPerFrame);
+		fillContiguousPlanes(slot->buffer, slot->planes, slot->linesizes);
+		hashFrameTiles(slot);
+
+		slot->frameIndex = decodedFrameCount++;
+		slot->pts = index;
+		frameRing->commitWriteSlot(slot);
+		return true;
+	}
+
+	/**
+	* ֻȡYUVļindex֡еǰɼ, λеľҲᱻϴ, йرջȡʧʱfalse
+	*/
+	bool Player::pushPartialYUVFrame(int index) {
+		FrameSlot *slot = frameRing->acquireWriteSlot();
+		if (slot == NULL) {
+			return false;
+		}
+
+		pthread_mutex_lock(&viewportLock);
+		slot->regions = visibleRegions;
+		pthread_mutex_unlock(&viewportLock);
+
+		if (!partialYUVReader->readRegions(index, slot->regions, slot->buffer)) {
+			std::cout << "Failed to read frame " << index << " from " << videoFileName << std::endl;
+			frameRing->cancelWriteSlot(slot);
+			return false;
+		}
+		fillContiguousPlanes(slot->buffer, slot->planes, slot->linesizes);
+
+		slot->frameIndex = decodedFrameCount++;
+		slot->pts = index;
+		frameRing->commitWriteSlot(slot);
+		return true;
+	}
+
+	/**
+	* Ⱦ̸߳ݵǰ¼ERPĿɼ, 仯ʱȡ߳
+	*/
+	void Player::updateVisibleRegions() {
+		if (erpViewport->update(projectMatrix * viewMatrix * modelMatrix)) {
+			pthread_mutex_lock(&viewportLock);
+			visibleRegions = erpViewport->getRegions();
+			pthread_mutex_unlock(&viewportLock);
+		}
+		visibleFractionSum += erpViewport->visibleFraction();
+		visibleFractionCount++;
+	}
+
+	/**
+	* -viewport 1ʱΪ֡ERPԴErpViewport, Ⱦ߳ÿ֡ɼ
+	* ֻȡɼYUVļѾErpViewport, Ҫٰӿϴ; DXT֡ܰϴ
+	*/
+	void Player::setupViewportUploads() {
+		if (pagedTexture != NULL) {
+			// ҳֻϴӿڵҳ, ERPErpViewportЩҳפ
+			viewportUploads = false;
+			if (projectionMode == PM_ERP && erpViewport == NULL) {
+				erpViewport = new ErpViewport(this->videoFrameWidth, this->videoFrameHeight);
+				updateVisibleRegions();
+			}
+			return;
+		}
+		if (viewportUploads && (projectionMode != PM_ERP || frameRing == NULL || videoFileType == VFT_DXT || partialYUVReader != NULL)) {
+			std::cout << "Viewport uploads only support whole ERP frames, uploading whole frames" << std::endl;
+			viewportUploads = false;
+		}
+		if (!viewportUploads) {
+			return;
+		}
+		erpViewport = new ErpViewport(this->videoFrameWidth, this->videoFrameHeight);
+		updateVisibleRegions();
+	}
+
+	/**
+	* Ⱦ߳: ֡ҪϴΪӿڵӿֵһд, NULLʱϴ֡
+	* һ֡лû, ֡ϴ
+	*/
+	const std::vector<TextureRegion> *Player::selectViewportRegions() {
+		long long frameTexels = (long long)videoFrameWidth * videoFrameHeight;
+		if (!viewportTextureFilled) {
+			viewportTextureFilled = true;
+			lastUploadedTexelFraction = 1.0;
+			uploadedTexelFractionSum += lastUploadedTexelFraction;
+			viewportUploadFrames++;
+			return NULL;
+		}
+		viewportUploadRegions = erpViewport->getRegions();
+
+		int bandHeight = ((videoFrameHeight + VIEWPORT_BACKGROUND_FILL_FRAMES - 1) / VIEWPORT_BACKGROUND_FILL_FRAMES + 1) & ~1;
+		TextureRegion band;
+		band.x = 0;
+		band.y = backgroundFillRow;
+		band.width = videoFrameWidth;
+		band.height = backgroundFillRow + bandHeight < videoFrameHeight ? bandHeight : videoFrameHeight - backgroundFillRow;
+		// дѾڿɼڵĲֲظϴ, Ҳظϴ
+		appendUncoveredRegions(band, viewportUploadRegions);
+		backgroundFillRow = backgroundFillRow + bandHeight < videoFrameHeight ? backgroundFillRow + bandHeight : 0;
+
+		long long uploadedTexels = 0;
+		for (size_t i = 0; i < viewportUploadRegions.size(); i++) {
+			uploadedTexels += (long long)viewportUploadRegions[i].width * viewportUploadRegions[i].height;
+		}
+		lastUploadedTexelFraction = 1.0 * uploadedTexels / frameTexels;
+		uploadedTexelFractionSum += lastUploadedTexelFraction;
+		viewportUploadFrames++;
+		return &viewportUploadRegions;
+	}
+
+	/**
+	* -dirty 1ʱTileHasher; DXT֡, ֻȡɼYUVļԼϴcubemapְ֧ϴ, ӿϴҳʱҲʹ
+	*/
+	void Player::setupTileHasher() {
+		if (!dirtyTileUploads || viewportUploads || pagedTexture != NULL || frameRing == NULL || videoFileType == VFT_DXT || partialYUVReader != NULL || (isCubeProjection() && !cubeAtlas)) {
+			return;
+		}
+		int bytesPerPixel[3] = { 1, 1, 1 };
+		int chromaShifts[3] = { 0, 1, 1 };
+		int planeCount = 1;
+		if (renderYUV) {
+			planeCount = yuvPlaneCount();
+			bytesPerPixel[1] = (yuvFrameLayout == YCL_NV12 ? 2 : 1);
+		} else {
+			bytesPerPixel[0] = 4;
+		}
+		if (workerPool == NULL) {
+			workerPool = new ThreadPool(sliceCount > 0 ? sliceCount : ThreadPool::hardwareThreadCount());
+		}
+		tileHasher = new TileHasher(workerPool);
+		if (!tileHasher->init(videoFrameWidth, videoFrameHeight, planeCount, bytesPerPixel, chromaShifts, DIRTY_TILE_SIZE)) {
+			std::cout << "Failed to init tileHasher, uploading whole frames" << std::endl;
+			delete tileHasher;
+			tileHasher = NULL;
+		}
+	}
+
+	/**
+	* д֡ǰλ֡Ŀϣ, ֻ֡
+	*/
+	void Player::hashFrameTiles(FrameSlot *slot) {
+		if (tileHasher == NULL || !slot->regions.empty()) {
+			return;
+		}
+		slot->tileHashes.resize(tileHasher->tileCount());
+		tileHasher->hashFrame(slot->planes, slot->linesizes, &slot->tileHashes[0]);
+	}
+
+	/**
+	* Ⱦ߳: ȽϲλĿϣеǰݵĹϣ, Ҫϴ, NULLʱϴ֡
+	* Ⱦ߳̿ʾ֡, ԺһϴݱȽ, Ǻһ֡Ƚ
+	*/
+	const std::vector<TextureRegion> *Player::selectDirtyTiles(const FrameSlot *slot) {
+		if (slot->tileHashes.size() != (size_t)tileHasher->tileCount()) {
+			uploadedTileHashes.clear();
+			return NULL;
+		}
+		size_t frameBytes = tileHasher->frameBytes();
+		dirtyTileFrames++;
+		dirtyTileFrameBytes += frameBytes;
+		if (uploadedTileHashes.size() != slot->tileHashes.size()) {
+			uploadedTileHashes = slot->tileHashes;
+			dirtyTileUploadedBytes += frameBytes;
+			return NULL;
+		}
+		size_t dirtyBytes = 0;
+		int dirtyTiles = tileHasher->dirtyRegions(&slot->tileHashes[0], &uploadedTileHashes[0], &dirtyTileRegions, &dirtyBytes);
+		// 󲿷ֿ鶼ʱ֡ϴĵø, PBO
+		if (dirtyTiles > tileHasher->tileCount() * DIRTY_TILE_FULL_UPLOAD_FRACTION) {
+			dirtyTileUploadedBytes += frameBytes;
+			return NULL;
+		}
+		dirtyTileUploadedBytes += dirtyBytes;
+		return &dirtyTileRegions;
+	}
+
+	/**
+	* ڴӳYUVļеindex֡Ⱦ߳, λֱָӳļ, йرʱfalse
+	*/
+	bool Player::pushMappedYUVFrame(int index) {
+		FrameSlot *slot = frameRing->acquireWriteSlot();
+		if (slot == NULL) {
+			return false;
+		}
+
+		yuvSource->getFrame(index, (const uint8_t **)slot->planes, slot->linesizes);
+		hashFrameTiles(slot);
+
+		slot->frameIndex = decodedFrameCount++;
+		slot->pts = index;
+		frameRing->commitWriteSlot(slot);
+		return true;
+	}
+
+	/**
+	* DXTļеindex֡ѹ齻Ⱦ߳, planes[0]ָӳļ, linesizes[0]Ϊѹֽ
+	* йرջȡ֡ʧʱfalse
+	*/
+	bool Player::pushDxtFrame(int index) {
+		FrameSlot *slot = frameRing->acquireWriteSlot();
+		if (slot == NULL) {
+			return false;
+		}
+
+		if (!dxtSource->getFrame(index, (const uint8_t **)&slot->planes[0], &slot->pts)) {
+			std::cout << "Failed to get frame " << index << " from " << videoFileName << std::endl;
+			frameRing->cancelWriteSlot(slot);
+			return false;
+		}
+		slot->planes[1] = slot->planes[2] = NULL;
+		slot->linesizes[0] = dxtSource->getHeader().frameBytes;
+		slot->linesizes[1] = slot->linesizes[2] = 0;
+
+		slot->frameIndex = decodedFrameCount++;
+		frameRing->commitWriteSlot(slot);
+		return true;
+	}
+
 
 	void Player::renderLoopThread() {
 		bool bQuit = false;
@@ -2739,8 +3867,10 @@ namespace Player {
             while (true) {
                 while (!bQuit && !this->allFrameRead) {
                     bQuit = this->handleInput();
-                    this->drawFrame();
-                    frameIndex++;
+                    // ֻͳʾ˵֡, ֡֡׼
+                    if (this->drawFrame()) {
+                        frameIndex++;
+                    }
                 }
                 if (bQuit) {
                     break;
@@ -2749,8 +3879,9 @@ namespace Player {
         } else {
             while (!bQuit && !this->allFrameRead) {
                 bQuit = this->handleInput();
-                this->drawFrame();
-                frameIndex++;
+                if (this->drawFrame()) {
+                    frameIndex++;
+                }
             }
         }
 
@@ -2758,6 +3889,12 @@ namespace Player {
 		__int64 time = timeMeasurer->elapsedMillionSecondsSinceStart();
 		double average = 1.0 * time / frameIndex;
 
+		if (this->frameRing != NULL) {
+			// ѿϵĽ߳, ˳ͷŽ
+			this->frameRing->close();
+			pthread_join(this->decodeThread, NULL);
+		}
+
 		std::string projectionMode;
 		switch (this->projectionMode) {
 		case PM_CPP_OBSOLETE:
@@ -2785,6 +3922,283 @@ namespace Player {
 
 		std::cout << "projection mode is: " << projectionMode << std::endl;
 		std::cout << "Frame count: " << frameIndex << std::endl << "Total time: " << time << " ms." << std::endl << "Average time: " << average << " ms." << std::endl;
+		if (this->frameRing != NULL) {
+			std::cout << "Dequeued frames: " << dequeuedFrameCount << ", presented frames: " << frameIndex << std::endl;
+			this->frameRing->printStatistics();
+			this->presentationClock.printStatistics();
+		}
+		if (this->pixelUnpackRing != NULL) {
+			this->pixelUnpackRing->printStatistics();
+		}
+		if (this->mappedFramePool != NULL) {
+			this->mappedFramePool->printStatistics();
+		}
+		if (this->pagedTexture != NULL) {
+			this->pagedTexture->printStatistics();
+		}
+		if (this->viewportUploads && this->viewportUploadFrames > 0) {
+			std::cout << "Viewport uploads: " << 100.0 * uploadedTexelFractionSum / viewportUploadFrames << "% of the ERP texels uploaded per frame, "
+				<< 100.0 * visibleFractionSum / visibleFractionCount << "% visible" << std::endl;
+		}
+		if (this->tileHasher != NULL && this->dirtyTileFrames > 0) {
+			std::cout << "Dirty tile uploads: " << 100.0 * dirtyTileUploadedBytes / dirtyTileFrameBytes << "% of the frame bytes uploaded, saved "
+				<< (dirtyTileFrameBytes - dirtyTileUploadedBytes) / 1024.0 / dirtyTileFrames << " KB per frame" << std::endl;
+		}
+		if (this->videoFileType == VFT_Encoded && this->decodeType == DT_SOFTWARE) {
+			demuxTimer.printStatistics();
+			decodeTimer.printStatistics();
+			convertTimer.printStatistics();
+			if (this->slicedScaler != NULL) {
+				this->slicedScaler->printStatistics();
+			}
+			if (this->frameCache != NULL) {
+				this->frameCache->printStatistics();
+			}
+		}
+		if (this->dxtSource != NULL) {
+			int frameBytes = this->dxtSource->getHeader().frameBytes;
+			std::cout << "DXT source: " << (this->dxtSource->format() == DXT_FORMAT_DXT1 ? "DXT1" : "YCoCg-DXT5") << ", "
+				<< frameBytes / 1024.0 << " KB uploaded per frame, "
+				<< 3.0 * videoFrameWidth * videoFrameHeight / frameBytes << "x smaller than RGB24" << std::endl;
+		}
+		if (this->projectionBenchmark && time > 0) {
+			std::cout << "Projection benchmark: " << 1000.0 * frameIndex / time << " fps" << std::endl;
+			printProjectionQuality();
+		}
+		if (this->partialYUVReader != NULL) {
+			this->partialYUVReader->printStatistics();
+			std::cout << "Average visible fraction of the ERP frame: " << 100.0 * visibleFractionSum / visibleFractionCount << "%" << std::endl;
+		}
+		std::cout << "------------------------------" << std::endl;
+	}
+
+	/**
+	* : ɨؼ֡batchDecoderCountнļ
+	* ָ-batchoutʱʾ˳ÿ֡YUV420Pдļ
+	*/
+	bool Player::runBatchDecode() {
+		if (this->videoFileType != VFT_Encoded || this->decodeType != DT_SOFTWARE || pFormatContext == NULL) {
+			std::cout << "Batch decode only supports encoded video with software decoding" << std::endl;
+			return false;
+		}
+
+		if (batchOutputFileName != NULL) {
+			batchOutputStream.open(batchOutputFileName, std::ios::binary | std::ios::out);
+			if (!batchOutputStream.is_open()) {
+				std::cout << "Failed to open " << batchOutputFileName << std::endl;
+				return false;
+			}
+		}
+
+		BatchDecoder batchDecoder(videoFileName, batchDecoderCount);
+		if (!batchDecoder.scanKeyframes(pFormatContext, videoStreamIndex, BATCH_MIN_PACKETS_PER_SEGMENT)) {
+			std::cout << "Failed to scan keyframes of " << videoFileName << std::endl;
+			return false;
+		}
+		batchDecoder.setMaxBufferedFrames(batchDecoderCount * BATCH_BUFFERED_FRAMES_PER_DECODER);
+
+		int frameCount = batchDecoder.run(writeBatchFrame, this);
+
+		if (batchOutputStream.is_open()) {
+			batchOutputStream.close();
+		}
+
+		std::cout << "------------------------------" << std::endl;
+		batchDecoder.printStatistics();
+		std::cout << "------------------------------" << std::endl;
+		return frameCount > 0;
+	}
+
+	bool Player::writeBatchFrame(AVFrame *frame, int frameIndex, void *userData) {
+		Player *player = (Player *)userData;
+		if (!player->batchOutputStream.is_open()) {
+			return true;
+		}
+
+		int width = frame->width;
+		int height = frame->height;
+		unsigned char *planes[3];
+		int linesizes[3];
+		if (frame->format == AV_PIX_FMT_YUV420P || frame->format == AV_PIX_FMT_YUVJ420P) {
+			for (int i = 0; i < 3; i++) {
+				planes[i] = frame->data[i];
+				linesizes[i] = frame->linesize[i];
+			}
+		} else {
+			// ظʽתYUV420P
+			player->batchSwsContext = sws_getCachedContext(player->batchSwsContext, width, height, (AVPixelFormat)frame->format,
+				width, height, AV_PIX_FMT_YUV420P, SWS_BILINEAR, NULL, NULL, NULL);
+			if (player->batchYUVBuffer == NULL) {
+				player->batchYUVBuffer = (uint8_t *)av_malloc(avpicture_get_size(AV_PIX_FMT_YUV420P, width, height));
+			}
+			AVPicture picture;
+			avpicture_fill(&picture, player->batchYUVBuffer, AV_PIX_FMT_YUV420P, width, height);
+			sws_scale(player->batchSwsContext, frame->data, frame->linesize, 0, height, picture.data, picture.linesize);
+			for (int i = 0; i < 3; i++) {
+				planes[i] = picture.data[i];
+				linesizes[i] = picture.linesize[i];
+			}
+		}
+
+		for (int i = 0; i < 3; i++) {
+			int planeWidth = i == 0 ? width : (width + 1) / 2;
+			int planeHeight = i == 0 ? height : (height + 1) / 2;
+			for (int row = 0; row < planeHeight; row++) {
+				player->batchOutputStream.write((const char *)planes[i] + row * linesizes[i], planeWidth);
+			}
+		}
+		return player->batchOutputStream.good();
+	}
+
+	/**
+	* ߰-videoתDXTļ: ƵGOPн(-batchָ), YUVļڴӳȡ
+	* ÿ֡תRGBA, ̳߳ϲѹDXT, ʾ˳д-dxtout
+	*/
+	bool Player::runDxtConversion() {
+		int timeBaseNum, timeBaseDen, frameRateNum, frameRateDen;
+		if (this->videoFileType == VFT_Encoded && this->decodeType == DT_SOFTWARE && pFormatContext != NULL) {
+			AVStream *videoStream = pFormatContext->streams[videoStreamIndex];
+			AVRational frameRate = videoStream->avg_frame_rate.num > 0 ? videoStream->avg_frame_rate : videoStream->r_frame_rate;
+			this->videoFrameWidth = videoStream->codec->width;
+			this->videoFrameHeight = videoStream->codec->height;
+			timeBaseNum = videoStream->time_base.num;
+			timeBaseDen = videoStream->time_base.den;
+			frameRateNum = frameRate.num;
+			frameRateDen = frameRate.den;
+		} else if (this->videoFileType == VFT_YUV && yuvSource != NULL) {
+			// YUVļеi֡ptsi, ʱ䵥λһ֡ʱ
+			frameRateNum = (int)(yuvFrameRate * 1000 + 0.5);
+			frameRateDen = 1000;
+			timeBaseNum = frameRateDen;
+			timeBaseDen = frameRateNum;
+		} else {
+			std::cout << "DXT conversion only supports encoded video with software decoding or memory mapped YUV files" << std::endl;
+			return false;
+		}
+
+		if (sliceCount <= 0) {
+			sliceCount = ThreadPool::hardwareThreadCount();
+		}
+		if (workerPool == NULL) {
+			workerPool = new ThreadPool(sliceCount);
+		}
+		dxtEncoder = new DxtEncoder(workerPool);
+		if (!dxtEncoder->init(this->videoFrameWidth, this->videoFrameHeight, dxtFormat, dxtQuality)) {
+			return false;
+		}
+		dxtBlockBuffer = (uint8_t *)av_malloc(dxtEncoder->frameBytes());
+		if (dxtBlockBuffer == NULL) {
+			return false;
+		}
+
+		dxtWriter = new DxtVideoWriter();
+		if (!dxtWriter->open(dxtOutputFileName, this->videoFrameWidth, this->videoFrameHeight, dxtFormat,
+			timeBaseNum, timeBaseDen, frameRateNum, frameRateDen)) {
+			return false;
+		}
+
+		timeMeasurer->Start();
+		int frameCount = 0;
+		if (this->videoFileType == VFT_Encoded) {
+			int decoderCount = batchDecoderCount > 0 ? batchDecoderCount : 1;
+			BatchDecoder batchDecoder(videoFileName, decoderCount);
+			if (!batchDecoder.scanKeyframes(pFormatContext, videoStreamIndex, BATCH_MIN_PACKETS_PER_SEGMENT)) {
+				std::cout << "Failed to scan keyframes of " << videoFileName << std::endl;
+				return false;
+			}
+			batchDecoder.setMaxBufferedFrames(decoderCount * BATCH_BUFFERED_FRAMES_PER_DECODER);
+			frameCount = batchDecoder.run(writeDxtFrame, this);
+		} else {
+			for (int i = 0; i < yuvSource->frameCount(); i++) {
+				const uint8_t *planes[3];
+				int linesizes[3];
+				if (!yuvSource->getFrame(i, planes, linesizes) || !encodeDxtFrame(planes, linesizes, AV_PIX_FMT_YUV420P, i)) {
+					break;
+				}
+				frameCount++;
+			}
+		}
+		bool written = dxtWriter->close();
+		__int64 time = timeMeasurer->elapsedMillionSecondsSinceStart();
+
+		std::cout << "------------------------------" << std::endl;
+		std::cout << "DXT conversion: " << dxtWriter->frameCount() << " frames of " << this->videoFrameWidth << "x" << this->videoFrameHeight
+			<< " written to " << dxtOutputFileName << " in " << time << " ms" << std::endl
+			<< "DXT frame size: " << dxtEncoder->frameBytes() / 1024.0 << " KB, "
+			<< 3.0 * this->videoFrameWidth * this->videoFrameHeight / dxtEncoder->frameBytes() << "x smaller than RGB24" << std::endl;
+		dxtEncoder->printStatistics();
+		std::cout << "------------------------------" << std::endl;
+		return written && frameCount > 0;
+	}
+
+	bool Player::writeDxtFrame(AVFrame *frame, int frameIndex, void *userData) {
+		Player *player = (Player *)userData;
+		if (frame->width != player->videoFrameWidth || frame->height != player->videoFrameHeight) {
+			std::cout << "Frame " << frameIndex << " changed size, stopping DXT conversion" << std::endl;
+			return false;
+		}
+		return player->encodeDxtFrame(frame->data, frame->linesize, (AVPixelFormat)frame->format, av_frame_get_best_effort_timestamp(frame));
+	}
+
+	/**
+	* һ֡ѹDXTдļ, YUV420P/NV12ֱӴYUVƽѹ, ʽswsתRGBA
+	*/
+	bool Player::encodeDxtFrame(const uint8_t * const *planes, const int *linesizes, AVPixelFormat pixelFormat, int64_t pts) {
+		int width = this->videoFrameWidth;
+		int height = this->videoFrameHeight;
+		YuvChromaLayout chromaLayout;
+		if (yuvChromaLayout(pixelFormat, &chromaLayout)) {
+			dxtEncoder->encodeYUV420(planes, linesizes, chromaLayout, dxtBlockBuffer);
+		} else {
+			if (dxtRGBABuffer == NULL) {
+				dxtRGBABuffer = (uint8_t *)av_malloc(width * height * 4);
+				if (dxtRGBABuffer == NULL) {
+					return false;
+				}
+			}
+			dxtSwsContext = sws_getCachedContext(dxtSwsContext, width, height, pixelFormat,
+				width, height, AV_PIX_FMT_RGBA, SWS_BILINEAR, NULL, NULL, NULL);
+			if (dxtSwsContext == NULL) {
+				return false;
+			}
+			uint8_t *rgbaPlanes[4] = { dxtRGBABuffer, NULL, NULL, NULL };
+			int rgbaLinesizes[4] = { width * 4, 0, 0, 0 };
+			sws_scale(dxtSwsContext, planes, linesizes, 0, height, rgbaPlanes, rgbaLinesizes);
+			dxtEncoder->encode(dxtRGBABuffer, dxtBlockBuffer);
+		}
+		return dxtWriter->writeFrame(dxtBlockBuffer, pts);
+	}
+
+	/**
+	* Ƚyuv420p_to_rgb24ʵ1080p, 4K, 8Kµ̵߳߳ٶ, ԼCpuKernelskernelDXTѹλ4Kµٶ
+	*/
+	void Player::runYuvConverterBenchmark() {
+		if (sliceCount <= 0) {
+			sliceCount = ThreadPool::hardwareThreadCount();
+		}
+		if (workerPool == NULL) {
+			workerPool = new ThreadPool(sliceCount);
+		}
+		std::cout << "------------------------------" << std::endl;
+		benchmark_yuv420p_to_rgb24(workerPool);
+		std::cout << "------------------------------" << std::endl;
+		CpuKernels::benchmark(workerPool);
+		std::cout << "------------------------------" << std::endl;
+		DxtEncoder::benchmark(workerPool);
+		std::cout << "------------------------------" << std::endl;
+	}
+	/**
+	* ȽERP𶥵ɵʱ, ̷ֱ߳߳ʱ
+	*/
+	void Player::runMeshBuilderBenchmark() {
+		if (sliceCount <= 0) {
+			sliceCount = ThreadPool::hardwareThreadCount();
+		}
+		if (workerPool == NULL) {
+			workerPool = new ThreadPool(sliceCount);
+		}
+		std::cout << "------------------------------" << std::endl;
+		SphereMeshBuilder::benchmark(workerPool);
 		std::cout << "------------------------------" << std::endl;
 	}
 }
\ No newline at end of file
@@ -12,6 +12,26 @@
 #include "gtc/matrix_transform.hpp"
 #include "gtc/constants.hpp"
 #include "TimeMeasurer.h"
+#include "FrameRing.h"
+#include "BoundedQueue.h"
+#include "StageTimer.h"
+#include "BatchDecoder.h"
+#include "ThreadPool.h"
+#include "SlicedScaler.h"
+#include "yuvConverter.h"
+#include "CpuKernels.h"
+#include "PixelUnpackRing.h"
+#include "MappedFramePool.h"
+#include "TileHasher.h"
+#include "PagedTexture.h"
+#include "CompactMesh.h"
+#include "SphereMeshBuilder.h"
+#include "PresentationClock.h"
+#include "FrameCache.h"
+#include "MappedYUVSource.h"
+#include "PartialYUVReader.h"
+#include "DxtVideoFile.h"
+#include "DxtEncoder.h"
 #include <fstream>
 #include "dynlink_nvcuvid.h"
 #include "../../NVDecoder/NvDecoder.h"
@@ -56,6 +76,7 @@ enum DrawMode {
 enum VideoFileType {
 	VFT_YUV = 0, // YUV Rawʽ
 	VFT_Encoded, // װƵʽmp4
+	VFT_DXT, // -dxtoutԤѹDXTƵ, ʱҪ
 	VFT_NOT_SPECIFIED
 };
 
@@ -97,6 +118,14 @@ namespace Player {
 		// YUV, ÿ֡ǰҪ
 		bool setupTextureData(unsigned char *textureData);
 
+		// ͬ, ֱʹøƽָп(ֽ), ݲҪ
+		// regionsΪNULLʱֻϴе, ΪձʾѾһ֡
+		bool setupTextureData(unsigned char * const *planes, const int *linesizes, const std::vector<TextureRegion> *regions = NULL);
+		bool stageFrameInPixelUnpackRing(unsigned char * const *planes, const int *linesizes, unsigned char *uploadPlanes[3]);
+
+		// ֱϴһ֡DXTѹ, sizeΪѹֽ
+		bool setupCompressedTextureData(const unsigned char *blocks, int size);
+
 		// Ⱦѭ
 		void renderLoop();
 
@@ -130,10 +159,14 @@ namespace Player {
 		bool setupCodec();
 		bool setupShaders();
 		bool setupTexture();
+		void allocateTextureStorage(GLenum target, GLenum internalFormat, int width, int height);
+		void setupYuvTextures(GLenum target, int width, int height);
+		void uploadCubeFaces(const GLenum *faces, int faceWidth, GLenum format, const unsigned char *data);
+		void uploadRegions(const std::vector<TextureRegion> &regions, int shift, GLenum format, const unsigned char *data);
 		bool setupCoordinates();
 		bool setupMatrixes();
 		void setupProjectionMatrix();
-		void drawFrame();
+		bool drawFrame();
 		bool handleInput();
 		void resizeWindow(SDL_Event& event);
 		void computeMVPMatrix();
@@ -151,31 +184,21 @@ namespace Player {
             uvVector.push_back(u);
             uvVector.push_back(v);
         }
-        void drawFrameTSP();
 
 
     private:
         bool setupEACCoordinates();
-        void drawFrameEAC();
 
     private:
         bool setupCubeMapCoordinates();
-        void drawFrameCubeMap();
 
 	private:
 		bool setupCppEqualDistanceCoordinates();
-		void drawFrameCppEqualDistance();
 
 		void computeCppEqualDistanceUVCoordinates(float x, float y, float &u, float &v);
 		void organizeVerts(std::vector<std::vector<VertexStruct>> &allVerts);
 
 	private:
-
-		void drawFrameERPWithoutIndex();
-		void drawFrameERPWithIndex();
-		void drawFrameCPPWithIndex_Obsolete();
-		void drawFrameCPPWithoutIndex_Obsolete();
-
 		void computeCppUVCoordinates_Obsolete(float latitude, float longitude, float &s, float &t);
 		
 	private:
@@ -189,10 +212,167 @@ namespace Player {
 		void destoryThread();
 		static void * decodeFunc(void *args);
 
+		// ߳Ⱦ֮߳֡, Ӳ·ֱд, ʹøö
+		FrameRing *frameRing = NULL;
+		int frameRingSize = 4;
+		int decodedFrameCount = 0;
+
+		// ˮ: װ ->  -> ת, ÿ׶һ߳, ׶֮н
+		// decodeFuncڵ̸߳׶
+		pthread_t demuxThread;
+		pthread_t convertThread;
+		BoundedQueue<AVPacket *> *packetQueue = NULL;
+		BoundedQueue<AVFrame *> *decodedFrameQueue = NULL;
+		StageTimer demuxTimer{ "Demux" };
+		StageTimer decodeTimer{ "Decode" };
+		StageTimer convertTimer{ "Convert" };
+
+		// RGBģʽת׶ΰһ֡гsliceCountƬ, workerPoolϲsws_scale, 0ʾCPUƬ
+		ThreadPool *workerPool = NULL;
+		SlicedScaler *slicedScaler = NULL;
+		int sliceCount = 0;
+
+		// RGBÿ4ֽ, uploadBGRAΪtrueʱGL_BGRAϴ, GL_RGBAϴ
+		// YUV420P/NV12֡yuv420_to_rgbһתλ, ظʽŽslicedScaler
+		bool uploadBGRA = true;
+		inline GLenum rgbUploadFormat() const {
+			return uploadBGRA ? GL_BGRA : GL_RGBA;
+		}
+		bool yuvChromaLayout(AVPixelFormat pixelFormat, YuvChromaLayout *chromaLayout);
+		// YUVģʽ֡ɫ, ͶӰѸƽϴy_tex/u_tex/v_tex, ƬԪɫתRGB
+		// NV12ʱu_texǽUVƽ(GL_RG8), ûv_tex
+		YuvChromaLayout yuvFrameLayout = YCL_PLANAR;
+		inline int yuvPlaneCount() const {
+			return yuvFrameLayout == YCL_NV12 ? 2 : 3;
+		}
+		inline GLenum yuvPlaneFormat(int plane) const {
+			return (plane > 0 && yuvFrameLayout == YCL_NV12) ? GL_RG : GL_RED;
+		}
+		bool convertToRGB(const uint8_t * const *planes, const int *linesizes, AVPixelFormat pixelFormat,
+			uint8_t *dst, int dstLinesize, RgbPixelLayout pixelLayout);
+		bool convertWithCpuKernels(const uint8_t * const *planes, const int *linesizes, AVPixelFormat pixelFormat,
+			uint8_t *dst, int dstLinesize, RgbPixelLayout pixelLayout);
+
+		// Ⱦ̰߳֡ʾʱ, YUVļûʱ, yuvFrameRate
+		PresentationClock presentationClock;
+		ClockMode clockMode = CM_FOLLOW_PTS;
+		double yuvFrameRate = 30;
+
+		// repeatģʽ»һת֡, ֮ѭٽ
+		FrameCache *frameCache = NULL;
+		int frameCacheBudgetMB = 1024;
+		bool frameCacheCompress = false;
+
+		static void * demuxFunc(void *args);
+		static void * convertFunc(void *args);
+		bool runSoftwarePipeline();
+		void runDecodeStage();
+		bool queueDecodedFrame();
+
+		bool pushDecodedFrame(AVFrame *frame);
+		bool pushYUVFileFrame(int index);
+		bool pushMappedYUVFrame(int index);
+		bool pushDxtFrame(int index);
+		bool pushPartialYUVFrame(int index);
+		void updateVisibleRegions();
+		bool pushCachedFrame(int index);
+		void storeFrameInCache(FrameSlot *slot);
+		void fillContiguousPlanes(unsigned char *textureData, unsigned char *planes[3], int linesizes[3]);
+		void setupTileHasher();
+		void setupViewportUploads();
+		void setupPagedTextureMode();
+		bool setupPagedTexture();
+		const std::vector<TextureRegion> *selectViewportRegions();
+		void hashFrameTiles(FrameSlot *slot);
+		const std::vector<TextureRegion> *selectDirtyTiles(const FrameSlot *slot);
+
 	public:
 		void setupThread();
 		void renderLoopThread();
 
+		// ģʽ: , öGOPнļ
+		inline bool isBatchMode() const {
+			return batchDecoderCount > 0;
+		}
+		bool runBatchDecode();
+
+	private:
+		int batchDecoderCount = 0;
+		char *batchOutputFileName = NULL;
+		std::ofstream batchOutputStream;
+		struct SwsContext *batchSwsContext = NULL;
+		uint8_t *batchYUVBuffer = NULL;
+
+		static bool writeBatchFrame(AVFrame *frame, int frameIndex, void *userData);
+
+	public:
+		// תģʽ: , -videoָƵ֡ѹDXTд-dxtoutָļ
+		inline bool isDxtConvertMode() const {
+			return dxtOutputFileName != NULL;
+		}
+		// һ֡ϴռ֡ı, ֡ϴʱΪ1
+		inline double uploadedTexelFraction() const {
+			return lastUploadedTexelFraction;
+		}
+		bool runDxtConversion();
+
+		// ֻyuv420p_to_rgb24Ļ׼, Ƶ
+		inline bool isYuvConverterBenchmark() const {
+			return yuvConverterBenchmark;
+		}
+		void runYuvConverterBenchmark();
+
+		// ֻERPɵĻ׼, Ƶ
+		inline bool isMeshBuilderBenchmark() const {
+			return meshBuilderBenchmark;
+		}
+		void runMeshBuilderBenchmark();
+
+	private:
+		bool yuvConverterBenchmark = false;
+		bool meshBuilderBenchmark = false;
+		char *dxtOutputFileName = NULL;
+		DxtFormat dxtFormat = DXT_FORMAT_DXT1;
+		DxtQuality dxtQuality = DXT_QUALITY_HIGH;
+		DxtEncoder *dxtEncoder = NULL;
+		DxtVideoWriter *dxtWriter = NULL;
+		struct SwsContext *dxtSwsContext = NULL;
+		// ֻظʽYUV420P/NV12ʱҪת֡RGBA
+		uint8_t *dxtRGBABuffer = NULL;
+		uint8_t *dxtBlockBuffer = NULL;
+
+		static bool writeDxtFrame(AVFrame *frame, int frameIndex, void *userData);
+		bool encodeDxtFrame(const uint8_t * const *planes, const int *linesizes, AVPixelFormat pixelFormat, int64_t pts);
+
+		// Cubemap/EAC/ACP3x2֡֡ϴһ2Dͼ, ƬԪɫѷӳ䵽, ӳ䵽ͼ(-atlas)
+		// ΪfalseʱϴGL_TEXTURE_CUBE_MAP
+		bool cubeAtlas = true;
+		inline bool isCubeProjection() const {
+			return projectionMode == PM_CUBEMAP || projectionMode == PM_EAC || projectionMode == PM_ACP;
+		}
+		inline bool samplesCubeAtlas() const {
+			return cubeAtlas && isCubeProjection();
+		}
+		// DXTļʱԴ, CubemapȲϴʱȰڵĿпdxtFaceBuffer
+		DxtVideoSource *dxtSource = NULL;
+		std::vector<uint8_t> dxtFaceBuffer;
+		bool compressedTextureAllocated = false;
+
+		// ͶӰ׼: ȴʾʱ, ת, DXTļʱȾѭûн
+		bool projectionBenchmark = false;
+		void advanceBenchmarkCamera();
+		void printProjectionQuality();
+		double meshSamplingError(int *triangleCount);
+
+		// ͶӰ(-procedural 1): , ȫεÿƬԪ߷ؼ֡, CPP_OBSOLETE֧
+		bool proceduralProjection = false;
+		inline bool drawsProcedurally() const {
+			return proceduralProjection && projectionMode != PM_CPP_OBSOLETE && projectionMode != PM_NOT_SPECIFIED;
+		}
+		bool setupProceduralCoordinates();
+		void drawFrameProcedural();
+		bool directionToFrameCoords(const glm::vec3 &direction, float &u, float &v);
+
 	private:
 		bool setupERPCoordinatesWithIndex();
 		bool setupERPCoordinatesWithoutIndex();
@@ -207,6 +387,8 @@ namespace Player {
 		DrawMode drawMode = DM_USE_INDEX;
 		VideoFileType videoFileType = VFT_Encoded;
 		DecodeType decodeType = DT_SOFTWARE;
+		// ɫתkernelCUDACPUִ, ûCUDA豸ʱӲ˻, תCpuKernels
+		CpuKernels::KernelDevice kernelDevice = CpuKernels::KD_AUTO;
 
 		glm::mat4 modelMatrix;
 		glm::mat4 viewMatrix;
@@ -218,9 +400,11 @@ namespace Player {
 		GLint sceneMVPMatrixPointer;
 
 		GLuint sceneVAO;
-		GLuint sceneVertexBuffer;
-		GLuint sceneUVBuffer;
-		GLuint sceneIndexBuffer;
+		// ͶӰĶ, ͶӰʹͬһֽոʽ
+		CompactMesh sceneMesh;
+		bool uploadSceneMesh(const char *name, const float *positions, const float *coords, int coordComponents, int vertexCount,
+			const int *indices, int indexCount);
+		void drawFrameMesh();
 
 	private:
 		CUVIDSOURCEDATAPACKET inputPacket;
@@ -265,14 +449,49 @@ namespace Player {
 		int               numberOfBytesPerFrame;
         uint8_t           *decodedRGB24Buffer = NULL;
         uint8_t           *compressedTextureBuffer = NULL;
-        uint8_t           *decodedRGBABuffer = NULL;
 		uint8_t           *decodedYUVBuffer = NULL;
 		struct SwsContext *swsContext = NULL;
 		std::ifstream     videoFileInputStream;
+		MappedYUVSource   *yuvSource = NULL;
+
+		// ERPʽYUVļֻȡϴӿڵ, Ⱦ̼߳ɼ, ȡ̰߳ȡ
+		bool partialYUVRead = false;
+		PartialYUVReader  *partialYUVReader = NULL;
+		ErpViewport       *erpViewport = NULL;
+		std::vector<TextureRegion> visibleRegions;
+		pthread_mutex_t   viewportLock;
+		double            visibleFractionSum = 0;
+		int               visibleFractionCount = 0;
+		// ֡ϴPIXEL_UNPACK_BUFFER_COUNTPBOɵĻ, һϴʱ֡С
+		bool              pixelUnpackBuffers = true;
+		PixelUnpackRing   *pixelUnpackRing = NULL;
+		// ֱ֡ӷڳ־ӳGL(-mapped), openVideoд
+		bool              mappedDecoderFrames = true;
+		MappedFramePool   *mappedFramePool = NULL;
+		// -dirty 1ʱд֡е̸߳ÿ֡ϣ, Ⱦֻ߳ϴݲͬĿ
+		bool              dirtyTileUploads = false;
+		TileHasher        *tileHasher = NULL;
+		std::vector<uint64_t> uploadedTileHashes; // еǰݵĿϣ, ֻȾ̷߳
+		std::vector<TextureRegion> dirtyTileRegions;
+		long long         dirtyTileFrames = 0;
+		long long         dirtyTileFrameBytes = 0;
+		long long         dirtyTileUploadedBytes = 0;
+		// -viewport 1ʱERP֡ԴҲֻϴӿڵ(), ಿÿ֡һд,
+		// VIEWPORT_BACKGROUND_FILL_FRAMES֡ˢһ
+		bool              viewportUploads = false;
+		bool              viewportTextureFilled = false;
+		int               backgroundFillRow = 0;
+		std::vector<TextureRegion> viewportUploadRegions;
+		long long         viewportUploadFrames = 0;
+		double            uploadedTexelFractionSum = 0;
+		double            lastUploadedTexelFraction = 1.0;
+		// -pages 1֡GL_MAX_TEXTURE_SIZEʱERP/TSP֡ҳ, ɫҳ
+		bool              pagedTextures = false;
+		PagedTexture      *pagedTexture = NULL;
         bool              renderYUV = true;
         bool              repeatRendering = false;
+        // ʾ֡, ֡׼ֻͳ; dequeuedFrameCount֡ȡʾ֡
         int frameIndex = 0;
-        uint8_t * faceBufferOne = NULL;
-        uint8_t * faceBufferTwo = NULL;
+        long long dequeuedFrameCount = 0;
 	};
 }
@@ -0,0 +1,89 @@
+#include "PresentationClock.h"
+#include <iostream>
+
+// ô֡ǿʾһ֡, ⻭泤ʱ䲻
+static const int MAX_CONSECUTIVE_DROPS = 8;
+// ʣȴʱڸֵʱSleep, æ, Sleepľֻк뼶
+static const __int64 SLEEP_MARGIN_MICRO_SECONDS = 2000;
+
+PresentationClock::PresentationClock() :
+    mode(CM_FOLLOW_PTS),
+    timeBase(0),
+    onTimeToleranceMicroSeconds(2000),
+    dropThresholdMicroSeconds(40000),
+    started(false),
+    firstPts(0),
+    previousPts(0),
+    consecutiveDrops(0),
+    onTimeCount(0),
+    lateCount(0),
+    droppedCount(0),
+    totalLatenessMicroSeconds(0) {
+}
+
+void PresentationClock::setup(double timeBase, double frameDuration, ClockMode mode) {
+    this->timeBase = timeBase;
+    this->mode = mode;
+    if (frameDuration <= 0) {
+        frameDuration = 1.0 / 30;
+    }
+    // ˲֡׼ʱ, ˳һ֡Ͷ
+    onTimeToleranceMicroSeconds = (__int64)(frameDuration * 1000000 / 2);
+    dropThresholdMicroSeconds = (__int64)(frameDuration * 1000000);
+    started = false;
+}
+
+bool PresentationClock::waitForPresentation(int64_t pts) {
+    if (mode == CM_AS_FAST_AS_POSSIBLE || timeBase <= 0 || pts == INT64_MIN) {
+        onTimeCount++;
+        return true;
+    }
+
+    // һ֡ʱ(ظ)ʱ¶
+    if (!started || pts < previousPts) {
+        timeMeasurer.Start();
+        firstPts = pts;
+        started = true;
+        consecutiveDrops = 0;
+    }
+    previousPts = pts;
+
+    __int64 dueMicroSeconds = (__int64)((pts - firstPts) * timeBase * 1000000);
+    __int64 now = timeMeasurer.elapsedMicroSecondsSinceStart();
+
+    if (now < dueMicroSeconds) {
+        __int64 remaining = dueMicroSeconds - now;
+        if (remaining > SLEEP_MARGIN_MICRO_SECONDS) {
+            Sleep((DWORD)((remaining - SLEEP_MARGIN_MICRO_SECONDS) / 1000));
+        }
+        while (timeMeasurer.elapsedMicroSecondsSinceStart() < dueMicroSeconds) {
+        }
+        onTimeCount++;
+        consecutiveDrops = 0;
+        return true;
+    }
+
+    __int64 lateness = now - dueMicroSeconds;
+    if (lateness <= onTimeToleranceMicroSeconds) {
+        onTimeCount++;
+        consecutiveDrops = 0;
+        return true;
+    }
+    if (lateness > dropThresholdMicroSeconds && consecutiveDrops < MAX_CONSECUTIVE_DROPS) {
+        droppedCount++;
+        consecutiveDrops++;
+        return false;
+    }
+    lateCount++;
+    totalLatenessMicroSeconds += lateness;
+    consecutiveDrops = 0;
+    return true;
+}
+
+void PresentationClock::printStatistics() {
+    std::cout << "Presentation clock: " << (mode == CM_FOLLOW_PTS ? "follow pts" : "as fast as possible") << std::endl
+        << "On-time frames: " << onTimeCount << ", late frames: " << lateCount << ", dropped frames: " << droppedCount << std::endl;
+    if (lateCount > 0) {
+        std::cout << "Average lateness of late frames: " << totalLatenessMicroSeconds / 1000.0 / lateCount << " ms" << std::endl;
+    }
+}
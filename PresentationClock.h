@@ -0,0 +1,48 @@
+#pragma once
+#include <stdint.h>
+#include "TimeMeasurer.h"
+
+enum ClockMode {
+    CM_FOLLOW_PTS = 0, // ֡ʾʱ, ֱ̫֡Ӷ
+    CM_AS_FAST_AS_POSSIBLE, // ׼, ȴҲ֡
+};
+
+/**
+* Ⱦ߳ʹõʾʱ
+* һ֡ʾʱǽʱ, ֮ÿ֡ʾʱ䵽ǰȴ,
+* ڶֵ֡֡ϴͻ
+*/
+class PresentationClock {
+public:
+    PresentationClock();
+
+    // timeBaseΪÿptsλӦ, frameDurationΪһ֡ʱ(), 㶪ֵ֡
+    void setup(double timeBase, double frameDuration, ClockMode mode);
+
+    // ʾptsӦ֮֡ǰ, falseʾ֡Ѿ̫, Ӧ
+    // ptsΪINT64_MIN(AV_NOPTS_VALUE)ʱȴ, ֱʾ
+    bool waitForPresentation(int64_t pts);
+
+    // ¶ʱ, ظŻصͷʱ
+    void reset() {
+        started = false;
+    }
+
+    void printStatistics();
+
+private:
+    TimeMeasurer timeMeasurer;
+    ClockMode mode;
+    double timeBase;
+    __int64 onTimeToleranceMicroSeconds; // ʱٵ
+    __int64 dropThresholdMicroSeconds; // ʱͶ֡
+    bool started;
+    int64_t firstPts;
+    int64_t previousPts;
+    int consecutiveDrops;
+
+    long long onTimeCount;
+    long long lateCount;
+    long long droppedCount;
+    __int64 totalLatenessMicroSeconds;
+};
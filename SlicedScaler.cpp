@@ -0,0 +1,112 @@
+#include "SlicedScaler.h"
+#include <iostream>
+extern "C"
+{
+#include <libavutil\pixdesc.h>
+};
+
+SlicedScaler::SlicedScaler(ThreadPool *pool) :
+    pool(pool),
+    srcChromaShift(0),
+    dstChromaShift(0),
+    frameCount(0),
+    src(NULL),
+    srcStride(NULL),
+    dst(NULL),
+    dstStride(NULL) {
+}
+
+SlicedScaler::~SlicedScaler() {
+    for (size_t i = 0; i < slices.size(); i++) {
+        sws_freeContext(slices[i].context);
+    }
+}
+
+bool SlicedScaler::init(int width, int height, AVPixelFormat srcFormat, AVPixelFormat dstFormat, int sliceCount, int flags) {
+    const AVPixFmtDescriptor *srcDescriptor = av_pix_fmt_desc_get(srcFormat);
+    const AVPixFmtDescriptor *dstDescriptor = av_pix_fmt_desc_get(dstFormat);
+    if (srcDescriptor == NULL || dstDescriptor == NULL || height < 2) {
+        return false;
+    }
+    srcChromaShift = srcDescriptor->log2_chroma_h;
+    dstChromaShift = dstDescriptor->log2_chroma_h;
+
+    // Ƭĸ߶ȱɫȴֱڵ
+    int rowAlignment = 1 << (srcChromaShift > dstChromaShift ? srcChromaShift : dstChromaShift);
+    int maxSliceCount = height / rowAlignment;
+    if (sliceCount > maxSliceCount) {
+        sliceCount = maxSliceCount;
+    }
+    if (sliceCount < 1) {
+        sliceCount = 1;
+    }
+
+    int alignedRows = height / rowAlignment;
+    slices.resize(sliceCount);
+    for (int i = 0; i < sliceCount; i++) {
+        Slice &slice = slices[i];
+        slice.firstRow = alignedRows * i / sliceCount * rowAlignment;
+        int nextRow = (i == sliceCount - 1) ? height : alignedRows * (i + 1) / sliceCount * rowAlignment;
+        slice.rowCount = nextRow - slice.firstRow;
+        slice.totalMicroSeconds = 0;
+        slice.maxMicroSeconds = 0;
+        // ÿƬһŶͼת, Ƭ֮ûй״̬
+        slice.context = sws_getContext(width, slice.rowCount, srcFormat, width, slice.rowCount, dstFormat, flags, NULL, NULL, NULL);
+        if (slice.context == NULL) {
+            std::cout << "Failed to create SwsContext for slice " << i << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int SlicedScaler::planeRow(int plane, int row, int chromaShift) {
+    return (plane == 1 || plane == 2) ? (row >> chromaShift) : row;
+}
+
+void SlicedScaler::scaleSlice(void *context, int sliceIndex) {
+    SlicedScaler *scaler = (SlicedScaler *)context;
+    Slice &slice = scaler->slices[sliceIndex];
+
+    TimeMeasurer timeMeasurer;
+    timeMeasurer.Start();
+
+    const uint8_t *srcPlanes[4] = { NULL, NULL, NULL, NULL };
+    uint8_t *dstPlanes[4] = { NULL, NULL, NULL, NULL };
+    for (int p = 0; p < 4; p++) {
+        if (scaler->src[p] != NULL) {
+            srcPlanes[p] = scaler->src[p] + planeRow(p, slice.firstRow, scaler->srcChromaShift) * scaler->srcStride[p];
+        }
+        if (scaler->dst[p] != NULL) {
+            dstPlanes[p] = scaler->dst[p] + planeRow(p, slice.firstRow, scaler->dstChromaShift) * scaler->dstStride[p];
+        }
+    }
+    sws_scale(slice.context, srcPlanes, scaler->srcStride, 0, slice.rowCount, dstPlanes, scaler->dstStride);
+
+    __int64 elapsed = timeMeasurer.elapsedMicroSecondsSinceStart();
+    slice.totalMicroSeconds += elapsed;
+    if (elapsed > slice.maxMicroSeconds) {
+        slice.maxMicroSeconds = elapsed;
+    }
+}
+
+void SlicedScaler::scale(const uint8_t * const src[], const int srcStride[], uint8_t * const dst[], const int dstStride[]) {
+    // AVFrameAVPicturedata4ƽ, òƽΪNULL
+    this->src = src;
+    this->srcStride = srcStride;
+    this->dst = dst;
+    this->dstStride = dstStride;
+    pool->parallelFor((int)slices.size(), scaleSlice, this);
+    frameCount++;
+}
+
+void SlicedScaler::printStatistics() {
+    if (frameCount == 0) {
+        return;
+    }
+    std::cout << "Sliced sws_scale: " << slices.size() << " slices on " << pool->size() << " threads, " << frameCount << " frames" << std::endl;
+    for (size_t i = 0; i < slices.size(); i++) {
+        std::cout << "Slice " << i << " (rows " << slices[i].firstRow << "-" << slices[i].firstRow + slices[i].rowCount - 1 << "): average "
+            << slices[i].totalMicroSeconds / 1000.0 / frameCount << " ms, max " << slices[i].maxMicroSeconds / 1000.0 << " ms" << std::endl;
+    }
+}
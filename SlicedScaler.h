@@ -0,0 +1,55 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include "ThreadPool.h"
+#include "TimeMeasurer.h"
+extern "C"
+{
+#include <libswscale\swscale.h>
+};
+
+/**
+* һ֡ˮƽгƬ, ÿƬԼSwsContext, ̳߳ϲظʽת
+* ֻʽת, , ԸƬԻش
+*/
+class SlicedScaler {
+public:
+    SlicedScaler(ThreadPool *pool);
+    ~SlicedScaler();
+
+    // sliceCountᱻ[1, height / 2], Ƭı߽뵽ż4:2:0ɫƽ
+    bool init(int width, int height, AVPixelFormat srcFormat, AVPixelFormat dstFormat, int sliceCount, int flags);
+
+    void scale(const uint8_t * const src[], const int srcStride[], uint8_t * const dst[], const int dstStride[]);
+
+    int getSliceCount() const {
+        return (int)slices.size();
+    }
+
+    void printStatistics();
+
+private:
+    struct Slice {
+        struct SwsContext *context;
+        int firstRow;
+        int rowCount;
+        __int64 totalMicroSeconds;
+        __int64 maxMicroSeconds;
+    };
+
+    static void scaleSlice(void *context, int sliceIndex);
+    // planeƽȵrowжӦк, ɫƽ水ʽĴֱʻ
+    static int planeRow(int plane, int row, int chromaShift);
+
+    ThreadPool *pool;
+    std::vector<Slice> slices;
+    int srcChromaShift;
+    int dstChromaShift;
+    int frameCount;
+
+    // ǰscaleĲ, ֻscale()ִڼЧ
+    const uint8_t * const *src;
+    const int *srcStride;
+    uint8_t * const *dst;
+    const int *dstStride;
+};
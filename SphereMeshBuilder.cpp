@@ -0,0 +1,282 @@
+#include "SphereMeshBuilder.h"
+#include <math.h>
+#include <iostream>
+#include <new>
+#include "TimeMeasurer.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define SPHERE_MESH_SSE
+#include <xmmintrin.h>
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// ÿ߳ƽֵ
+static const int BANDS_PER_THREAD = 4;
+
+SphereMeshBuilder::SphereMeshBuilder(ThreadPool *pool) :
+    pool(pool),
+    pieces(0),
+    halfPieces(0),
+    bandCount(1),
+    vertexArray(NULL),
+    uvArray(NULL),
+    indexArray(NULL) {
+}
+
+int SphereMeshBuilder::vertexCount(int pieces, bool indexed) {
+    int halfPieces = pieces / 2;
+    return indexed ? (halfPieces + 1) * (pieces + 1) : pieces * halfPieces * 6;
+}
+
+int SphereMeshBuilder::indexCount(int pieces) {
+    return pieces * (pieces / 2) * 6;
+}
+
+void SphereMeshBuilder::build(int pieces, float radius, float *vertexArray, float *uvArray, int *indexArray) {
+    this->pieces = pieces;
+    this->halfPieces = pieces / 2;
+    this->vertexArray = vertexArray;
+    this->uvArray = uvArray;
+    this->indexArray = indexArray;
+    if (halfPieces <= 0) {
+        return;
+    }
+
+    // ԭʵһ, ȺγȵļPI / halfPieces
+    double interval = M_PI / halfPieces;
+    rowSin.resize(halfPieces + 1);
+    rowCos.resize(halfPieces + 1);
+    rowV.resize(halfPieces + 1);
+    for (int i = 0; i <= halfPieces; i++) {
+        double latitude = i * interval;
+        rowSin[i] = (float)(radius * sin(latitude));
+        rowCos[i] = (float)(radius * cos(latitude));
+        rowV[i] = (float)i / halfPieces;
+    }
+    columnSin.resize(pieces + 1);
+    columnCos.resize(pieces + 1);
+    columnU.resize(pieces + 1);
+    for (int j = 0; j <= pieces; j++) {
+        double longitude = j * interval;
+        columnSin[j] = (float)sin(longitude);
+        columnCos[j] = (float)cos(longitude);
+        columnU[j] = (float)j / pieces;
+    }
+
+    // ʱл, ÿͬʱдԱΪϱߵһıε; ûʱıл
+    int rowCount = indexArray != NULL ? halfPieces + 1 : halfPieces;
+    bandCount = 1;
+    if (pool != NULL) {
+        bandCount = pool->size() * BANDS_PER_THREAD;
+        if (bandCount > rowCount) {
+            bandCount = rowCount;
+        }
+    }
+    if (bandCount > 1) {
+        pool->parallelFor(bandCount, buildBand, this);
+    } else if (indexArray != NULL) {
+        buildIndexedRows(0, rowCount);
+    } else {
+        buildTriangleRows(0, rowCount);
+    }
+}
+
+void SphereMeshBuilder::buildBand(void *context, int band) {
+    SphereMeshBuilder *builder = (SphereMeshBuilder *)context;
+    int rowCount = builder->indexArray != NULL ? builder->halfPieces + 1 : builder->halfPieces;
+    int first = (int)((long long)rowCount * band / builder->bandCount);
+    int last = (int)((long long)rowCount * (band + 1) / builder->bandCount);
+    if (builder->indexArray != NULL) {
+        builder->buildIndexedRows(first, last);
+    } else {
+        builder->buildTriangleRows(first, last);
+    }
+}
+
+/**
+* [first, last): iеjеĶ(rowSin[i] * columnSin[j], rowCos[i], rowSin[i] * columnCos[j])
+*/
+void SphereMeshBuilder::buildIndexedRows(int first, int last) {
+    int columns = pieces + 1;
+    for (int i = first; i < last; i++) {
+        float s = rowSin[i];
+        float c = rowCos[i];
+        float v = rowV[i];
+        float *position = vertexArray + (size_t)i * columns * 3;
+        float *uv = uvArray + (size_t)i * columns * 2;
+        int j = 0;
+#ifdef SPHERE_MESH_SSE
+        // һ4, x, y, zx0 y z0 x1 | y z1 x2 y | z2 x3 y z3
+        __m128 rowS = _mm_set1_ps(s);
+        __m128 rowC = _mm_set1_ps(c);
+        __m128 rowV4 = _mm_set1_ps(v);
+        for (; j + 4 <= columns; j += 4) {
+            __m128 x = _mm_mul_ps(rowS, _mm_loadu_ps(&columnSin[j]));
+            __m128 z = _mm_mul_ps(rowS, _mm_loadu_ps(&columnCos[j]));
+            __m128 xyLow = _mm_unpacklo_ps(x, rowC);
+            __m128 xyHigh = _mm_unpackhi_ps(x, rowC);
+            __m128 zxLow = _mm_unpacklo_ps(z, x);
+            __m128 zxHigh = _mm_unpackhi_ps(z, x);
+            __m128 yzLow = _mm_unpacklo_ps(rowC, z);
+            __m128 yzHigh = _mm_unpackhi_ps(rowC, z);
+            _mm_storeu_ps(position, _mm_shuffle_ps(xyLow, zxLow, _MM_SHUFFLE(3, 0, 1, 0)));
+            _mm_storeu_ps(position + 4, _mm_shuffle_ps(yzLow, xyHigh, _MM_SHUFFLE(1, 0, 3, 2)));
+            _mm_storeu_ps(position + 8, _mm_shuffle_ps(zxHigh, yzHigh, _MM_SHUFFLE(3, 2, 3, 0)));
+            position += 12;
+
+            __m128 u = _mm_loadu_ps(&columnU[j]);
+            _mm_storeu_ps(uv, _mm_unpacklo_ps(u, rowV4));
+            _mm_storeu_ps(uv + 4, _mm_unpackhi_ps(u, rowV4));
+            uv += 8;
+        }
+#endif
+        for (; j < columns; j++) {
+            *position++ = s * columnSin[j];
+            *position++ = c;
+            *position++ = s * columnCos[j];
+            *uv++ = columnU[j];
+            *uv++ = v;
+        }
+
+        // ii + 1֮ı, 0-1-2, 2-3-0
+        // 1---2
+        // |  /|
+        // | / |
+        // |/  |
+        // 0---3
+        if (i < halfPieces) {
+            int *index = indexArray + (size_t)i * pieces * 6;
+            int top = i * columns;
+            int bottom = top + columns;
+            for (j = 0; j < pieces; j++) {
+                index[0] = top + j;
+                index[1] = bottom + j;
+                index[2] = bottom + j + 1;
+                index[3] = bottom + j + 1;
+                index[4] = top + j + 1;
+                index[5] = top + j;
+                index += 6;
+            }
+        }
+    }
+}
+
+/**
+* ı[first, last), ÿıΰ0-1-2, 2-3-06
+*/
+void SphereMeshBuilder::buildTriangleRows(int first, int last) {
+    for (int i = first; i < last; i++) {
+        float *position = vertexArray + (size_t)i * pieces * 6 * 3;
+        float *uv = uvArray + (size_t)i * pieces * 6 * 2;
+        for (int j = 0; j < pieces; j++) {
+            // 0: (i, j), 1: (i + 1, j), 2: (i + 1, j + 1), 3: (i, j + 1)
+            static const int CORNER_ROWS[6] = { 0, 1, 1, 1, 0, 0 };
+            static const int CORNER_COLUMNS[6] = { 0, 0, 1, 1, 1, 0 };
+            for (int k = 0; k < 6; k++) {
+                int row = i + CORNER_ROWS[k];
+                int column = j + CORNER_COLUMNS[k];
+                *position++ = rowSin[row] * columnSin[column];
+                *position++ = rowCos[row];
+                *position++ = rowSin[row] * columnCos[column];
+                *uv++ = columnU[column];
+                *uv++ = rowV[row];
+            }
+        }
+    }
+}
+
+/**
+* ԭsetupERPCoordinatesWithIndex𶥵doubleд, Ϊ׼ԵĲ
+*/
+static void buildReference(int pieces, float radius, float *vertexArray, float *uvArray, int *indexArray) {
+    int halfPieces = pieces / 2;
+    double interval = M_PI / halfPieces;
+    int m = 0, n = 0;
+    for (int i = 0; i <= halfPieces; i++) {
+        double latitude = i * interval;
+        for (int j = 0; j <= pieces; j++) {
+            double longitude = j * interval;
+            vertexArray[m++] = (float)(radius * sin(latitude) * sin(longitude));
+            vertexArray[m++] = (float)(radius * cos(latitude));
+            vertexArray[m++] = (float)(radius * sin(latitude) * cos(longitude));
+            uvArray[n++] = 1.0f * j / pieces;
+            uvArray[n++] = 1.0f * i / halfPieces;
+        }
+    }
+    m = 0;
+    for (int i = 1; i <= halfPieces; i++) {
+        for (int j = 0; j < pieces; j++) {
+            indexArray[m++] = (i - 1) * (pieces + 1) + j;
+            indexArray[m++] = i * (pieces + 1) + j;
+            indexArray[m++] = i * (pieces + 1) + j + 1;
+            indexArray[m++] = i * (pieces + 1) + j + 1;
+            indexArray[m++] = (i - 1) * (pieces + 1) + j + 1;
+            indexArray[m++] = (i - 1) * (pieces + 1) + j;
+        }
+    }
+}
+
+void SphereMeshBuilder::benchmark(ThreadPool *pool) {
+    static const float RADIUS = 10.0f;
+    // սռ뱻ͬڴ, ֻСԪرȽ
+    static const int MAX_COMPARED_PIECES = 2048;
+
+    std::cout << "ERP mesh builder benchmark, indexed meshes, " << (pool != NULL ? pool->size() : 1) << " threads" << std::endl;
+    for (int pieces = 64; pieces <= 8192; pieces *= 2) {
+        size_t vertices = (size_t)vertexCount(pieces, true);
+        size_t indices = (size_t)indexCount(pieces);
+        std::vector<float> positions, uvs;
+        std::vector<int> indexArray;
+        std::vector<float> referencePositions, referenceUvs;
+        std::vector<int> referenceIndices;
+        try {
+            positions.resize(vertices * 3);
+            uvs.resize(vertices * 2);
+            indexArray.resize(indices);
+            if (pieces <= MAX_COMPARED_PIECES) {
+                referencePositions.resize(vertices * 3);
+                referenceUvs.resize(vertices * 2);
+                referenceIndices.resize(indices);
+            }
+        } catch (const std::bad_alloc &) {
+            std::cout << "-patch " << pieces << ": not enough memory for " << vertices << " vertices, skipped" << std::endl;
+            break;
+        }
+        bool compare = !referencePositions.empty();
+        float *referenceVertexArray = compare ? &referencePositions[0] : &positions[0];
+        float *referenceUvArray = compare ? &referenceUvs[0] : &uvs[0];
+        int *referenceIndexArray = compare ? &referenceIndices[0] : &indexArray[0];
+
+        TimeMeasurer timeMeasurer;
+        timeMeasurer.Start();
+        buildReference(pieces, RADIUS, referenceVertexArray, referenceUvArray, referenceIndexArray);
+        double reference = timeMeasurer.elapsedMicroSecondsSinceStart() / 1000.0;
+
+        SphereMeshBuilder single(NULL);
+        timeMeasurer.Start();
+        single.build(pieces, RADIUS, &positions[0], &uvs[0], &indexArray[0]);
+        double tables = timeMeasurer.elapsedMicroSecondsSinceStart() / 1000.0;
+
+        std::cout << "-patch " << pieces << ", " << vertices << " vertices: per vertex " << reference << " ms, tables " << tables
+            << " ms (" << reference / tables << "x)";
+        if (pool != NULL) {
+            SphereMeshBuilder parallel(pool);
+            timeMeasurer.Start();
+            parallel.build(pieces, RADIUS, &positions[0], &uvs[0], &indexArray[0]);
+            double threaded = timeMeasurer.elapsedMicroSecondsSinceStart() / 1000.0;
+            std::cout << ", " << pool->size() << " threads " << threaded << " ms (" << reference / threaded << "x)";
+        }
+        if (compare) {
+            double maxError = 0;
+            for (size_t k = 0; k < positions.size(); k++) {
+                maxError = fmax(maxError, fabs((double)positions[k] - referencePositions[k]));
+            }
+            bool same = uvs == referenceUvs && indexArray == referenceIndices;
+            std::cout << ", max position error " << maxError << (same ? "" : ", UV/index MISMATCH");
+        }
+        std::cout << std::endl;
+    }
+}
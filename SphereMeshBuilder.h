@@ -0,0 +1,44 @@
+#pragma once
+#include <vector>
+#include "ThreadPool.h"
+
+/**
+* ERPͶӰ, ˳ԭsetupERPCoordinatesWithIndex/WithoutIndex𶥵Ľͬ
+* ÿеsin/cosÿеsin/cosһδɱ, ֻҪγ˷; ̳߳ϲ,
+* ÿжSSEһ4; 𶥵doubleĽ뾶1e-6
+*/
+class SphereMeshBuilder {
+public:
+    // poolΪNULLʱڵ߳
+    SphereMeshBuilder(ThreadPool *pool);
+
+    // piecesǾȷķֶ, γȷpieces / 2
+    static int vertexCount(int pieces, bool indexed);
+    static int indexCount(int pieces);
+
+    // vertexArrayÿ3float, uvArrayÿ2float, СvertexCount; indexArrayΪNULLʱɲб
+    void build(int pieces, float radius, float *vertexArray, float *uvArray, int *indexArray);
+
+    // Ա𶥵(߳߳)-patch 648192µʱ
+    static void benchmark(ThreadPool *pool);
+
+private:
+    static void buildBand(void *context, int band);
+    void buildIndexedRows(int first, int last);
+    void buildTriangleRows(int first, int last);
+
+    ThreadPool *pool;
+    int pieces;
+    int halfPieces;
+    int bandCount;
+    float *vertexArray;
+    float *uvArray;
+    int *indexArray;
+    // бΪ뾶γȵsin/cos, бΪȵsin/cos
+    std::vector<float> rowSin;
+    std::vector<float> rowCos;
+    std::vector<float> rowV;
+    std::vector<float> columnSin;
+    std::vector<float> columnCos;
+    std::vector<float> columnU;
+};
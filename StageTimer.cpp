@@ -0,0 +1,38 @@
+#include "StageTimer.h"
+#include <iostream>
+
+StageTimer::StageTimer(const char *name) :
+    name(name),
+    idleStart(0),
+    idleMicroSeconds(0),
+    totalMicroSeconds(0),
+    itemCount(0) {
+}
+
+void StageTimer::start() {
+    idleMicroSeconds = 0;
+    totalMicroSeconds = 0;
+    itemCount = 0;
+    timeMeasurer.Start();
+}
+
+void StageTimer::stop() {
+    totalMicroSeconds = timeMeasurer.elapsedMicroSecondsSinceStart();
+}
+
+void StageTimer::beginIdle() {
+    idleStart = timeMeasurer.elapsedMicroSecondsSinceStart();
+}
+
+void StageTimer::endIdle() {
+    idleMicroSeconds += timeMeasurer.elapsedMicroSecondsSinceStart() - idleStart;
+}
+
+void StageTimer::printStatistics() {
+    __int64 busyMicroSeconds = totalMicroSeconds - idleMicroSeconds;
+    double busyPercent = totalMicroSeconds > 0 ? 100.0 * busyMicroSeconds / totalMicroSeconds : 0.0;
+    double averageBusy = itemCount > 0 ? busyMicroSeconds / 1000.0 / itemCount : 0.0;
+    std::cout << name << " stage: " << itemCount << " items, busy " << busyMicroSeconds / 1000 << " ms ("
+        << busyPercent << "%), idle " << idleMicroSeconds / 1000 << " ms, "
+        << averageBusy << " ms busy per item" << std::endl;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "TimeMeasurer.h"
+
+/**
+* ͳˮһ׶̵߳æµʱʱ
+* ʱָΪջϵʱ, ʱ䶼æµ
+*/
+class StageTimer {
+public:
+    StageTimer(const char *name);
+
+    // ڽ׶߳̿ʼʱ
+    void start();
+    void stop();
+
+    // סһοĶв
+    void beginIdle();
+    void endIdle();
+
+    // һԪ(/֡)
+    void finishItem() {
+        itemCount++;
+    }
+
+    void printStatistics();
+
+private:
+    const char *name;
+    TimeMeasurer timeMeasurer;
+    __int64 idleStart;
+    __int64 idleMicroSeconds;
+    __int64 totalMicroSeconds;
+    long long itemCount;
+};
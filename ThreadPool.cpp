@@ -0,0 +1,120 @@
+#include "ThreadPool.h"
+#include <Windows.h>
+
+ThreadPool::ThreadPool(int threadCount) :
+    task(NULL),
+    context(NULL),
+    taskCount(0),
+    nextTask(0),
+    finishedTasks(0),
+    generation(0),
+    quit(false) {
+    pthread_mutex_init(&lock, NULL);
+    pthread_mutex_init(&submitLock, NULL);
+    pthread_cond_init(&workAvailable, NULL);
+    pthread_cond_init(&workFinished, NULL);
+
+    if (threadCount <= 0) {
+        threadCount = hardwareThreadCount();
+    }
+    // ߳Ҳ, ֻҪⴴthreadCount - 1߳
+    threads.resize(threadCount - 1);
+    for (size_t i = 0; i < threads.size(); i++) {
+        pthread_create(&threads[i], NULL, workerFunc, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    pthread_mutex_lock(&lock);
+    quit = true;
+    pthread_cond_broadcast(&workAvailable);
+    pthread_mutex_unlock(&lock);
+    for (size_t i = 0; i < threads.size(); i++) {
+        pthread_join(threads[i], NULL);
+    }
+    pthread_cond_destroy(&workFinished);
+    pthread_cond_destroy(&workAvailable);
+    pthread_mutex_destroy(&submitLock);
+    pthread_mutex_destroy(&lock);
+}
+
+int ThreadPool::hardwareThreadCount() {
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+    return systemInfo.dwNumberOfProcessors > 0 ? (int)systemInfo.dwNumberOfProcessors : 1;
+}
+
+void ThreadPool::runTasks() {
+    while (true) {
+        pthread_mutex_lock(&lock);
+        if (nextTask >= taskCount) {
+            pthread_mutex_unlock(&lock);
+            return;
+        }
+        int taskIndex = nextTask++;
+        ParallelTask currentTask = task;
+        void *currentContext = context;
+        pthread_mutex_unlock(&lock);
+
+        currentTask(currentContext, taskIndex);
+
+        pthread_mutex_lock(&lock);
+        finishedTasks++;
+        if (finishedTasks == taskCount) {
+            pthread_cond_broadcast(&workFinished);
+        }
+        pthread_mutex_unlock(&lock);
+    }
+}
+
+void * ThreadPool::workerFunc(void *args) {
+    ThreadPool *pool = (ThreadPool *)args;
+    long long seenGeneration = 0;
+    while (true) {
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->quit && pool->generation == seenGeneration) {
+            pthread_cond_wait(&pool->workAvailable, &pool->lock);
+        }
+        if (pool->quit) {
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+        seenGeneration = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        pool->runTasks();
+    }
+    return NULL;
+}
+
+void ThreadPool::parallelFor(int taskCount, ParallelTask task, void *context) {
+    if (taskCount <= 0) {
+        return;
+    }
+    if (taskCount == 1 || threads.empty()) {
+        for (int i = 0; i < taskCount; i++) {
+            task(context, i);
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&submitLock);
+    pthread_mutex_lock(&lock);
+    this->task = task;
+    this->context = context;
+    this->taskCount = taskCount;
+    this->nextTask = 0;
+    this->finishedTasks = 0;
+    this->generation++;
+    pthread_cond_broadcast(&workAvailable);
+    pthread_mutex_unlock(&lock);
+
+    runTasks();
+
+    pthread_mutex_lock(&lock);
+    while (finishedTasks < this->taskCount) {
+        pthread_cond_wait(&workFinished, &lock);
+    }
+    pthread_mutex_unlock(&lock);
+    pthread_mutex_unlock(&submitLock);
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <vector>
+#include <pthread.h>
+
+// , taskIndexȡֵΪ[0, taskCount)
+typedef void(*ParallelTask)(void *context, int taskIndex);
+
+/**
+* ̶߳Ĺ̳߳
+* parallelFortaskCountָе߳߳, ȫɺŷ
+*/
+class ThreadPool {
+public:
+    // threadCountΪ0ʱʹCPU߼
+    ThreadPool(int threadCount = 0);
+    ~ThreadPool();
+
+    void parallelFor(int taskCount, ParallelTask task, void *context);
+
+    // ߳, ߳
+    int size() const {
+        return (int)threads.size() + 1;
+    }
+
+    static int hardwareThreadCount();
+
+private:
+    static void * workerFunc(void *args);
+    // ȡִеǰε, ֱûʣ
+    void runTasks();
+
+    std::vector<pthread_t> threads;
+    pthread_mutex_t lock;
+    pthread_cond_t workAvailable;
+    pthread_cond_t workFinished;
+    // ͬһʱֻһύ
+    pthread_mutex_t submitLock;
+
+    ParallelTask task;
+    void *context;
+    int taskCount;
+    int nextTask;
+    int finishedTasks;
+    long long generation;
+    bool quit;
+};
@@ -0,0 +1,187 @@
+#include "TileHasher.h"
+#include <string.h>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define TILE_HASHER_SSE2
+#include <emmintrin.h>
+#endif
+
+// ÿ16ֽʹõԿ, еλֻ, λõͬҲõͬĹϣ
+static const uint64_t TILE_HASH_KEYS[8][2] = {
+    { 0xbe4ba423396cfeb8ULL, 0x1cad21f72c81017cULL }, { 0xdb979083e96dd4deULL, 0x1f67b3b7a4a44072ULL },
+    { 0x78e5c0cc4ee679cbULL, 0x2172ffcc7dd05a82ULL }, { 0x8e2443f7744608b8ULL, 0x4c263a81e69035e0ULL },
+    { 0xcb00c391bb52283cULL, 0xa32e531b8b65d088ULL }, { 0x4ef90da297486471ULL, 0xd8acdea946ef1938ULL },
+    { 0x3f349ce33f76faa8ULL, 0x1d4f0bc7c7bbdcf9ULL }, { 0x3159b4cd4be0518aULL, 0x647378d9c97e9fc8ULL }
+};
+
+/**
+* XXH3ۼӷʽһֽ: ÿ16ֽڷֳ64λͨ, acc +=  + (^Կ)ߵ32λ֮
+* SSE2ʵֵĽͬ
+*/
+static inline void hashBytes(const uint8_t *data, int size, uint64_t acc[2]) {
+    int i = 0;
+#ifdef TILE_HASHER_SSE2
+    __m128i accumulator = _mm_loadu_si128((const __m128i *)acc);
+    for (; i + 16 <= size; i += 16) {
+        __m128i value = _mm_loadu_si128((const __m128i *)(data + i));
+        __m128i key = _mm_loadu_si128((const __m128i *)TILE_HASH_KEYS[(i >> 4) & 7]);
+        __m128i valueKey = _mm_xor_si128(value, key);
+        __m128i product = _mm_mul_epu32(valueKey, _mm_shuffle_epi32(valueKey, _MM_SHUFFLE(0, 3, 0, 1)));
+        __m128i swapped = _mm_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+        accumulator = _mm_add_epi64(accumulator, _mm_add_epi64(swapped, product));
+    }
+    _mm_storeu_si128((__m128i *)acc, accumulator);
+#endif
+    for (; i < size; i += 16) {
+        uint64_t value[2] = { 0, 0 };
+        memcpy(value, data + i, size - i < 16 ? size - i : 16);
+        const uint64_t *key = TILE_HASH_KEYS[(i >> 4) & 7];
+        for (int lane = 0; lane < 2; lane++) {
+            uint64_t valueKey = value[lane] ^ key[lane];
+            acc[lane] += value[1 - lane] + (valueKey & 0xffffffffULL) * (valueKey >> 32);
+        }
+    }
+}
+
+static inline uint64_t finishHash(const uint64_t acc[2]) {
+    uint64_t hash = acc[0] ^ (acc[1] * 0x9e3779b185ebca87ULL);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+TileHasher::TileHasher(ThreadPool *pool) :
+    pool(pool),
+    width(0),
+    height(0),
+    planeCount(0),
+    tileSize(0),
+    tileColumns(0),
+    tileRows(0),
+    currentPlanes(NULL),
+    currentLinesizes(NULL),
+    currentHashes(NULL) {
+}
+
+bool TileHasher::init(int width, int height, int planeCount, const int *bytesPerPixel, const int *chromaShifts, int tileSize) {
+    if (width <= 0 || height <= 0 || planeCount < 1 || planeCount > 3 || tileSize <= 0 || tileSize % 2 != 0) {
+        return false;
+    }
+    this->width = width;
+    this->height = height;
+    this->planeCount = planeCount;
+    for (int i = 0; i < planeCount; i++) {
+        this->bytesPerPixel[i] = bytesPerPixel[i];
+        this->chromaShifts[i] = chromaShifts[i];
+    }
+    this->tileSize = tileSize;
+    tileColumns = (width + tileSize - 1) / tileSize;
+    tileRows = (height + tileSize - 1) / tileSize;
+    return true;
+}
+
+void TileHasher::hashFrame(const uint8_t * const *planes, const int *linesizes, uint64_t *hashes) {
+    currentPlanes = planes;
+    currentLinesizes = linesizes;
+    currentHashes = hashes;
+    pool->parallelFor(tileRows, hashTileRow, this);
+    currentPlanes = NULL;
+    currentLinesizes = NULL;
+    currentHashes = NULL;
+}
+
+/**
+* rowпĹϣ, ɨƽ, ͬһÿƬۼӵԵۼ
+*/
+void TileHasher::hashTileRow(void *context, int row) {
+    TileHasher *hasher = (TileHasher *)context;
+    std::vector<uint64_t> accumulators(hasher->tileColumns * 2);
+    for (int column = 0; column < hasher->tileColumns; column++) {
+        accumulators[column * 2] = (uint64_t)row * hasher->tileColumns + column;
+        accumulators[column * 2 + 1] = 0x27d4eb2f165667c5ULL;
+    }
+    for (int plane = 0; plane < hasher->planeCount; plane++) {
+        int shift = hasher->chromaShifts[plane];
+        int planeTile = hasher->tileSize >> shift;
+        int planeWidth = hasher->width >> shift;
+        int planeHeight = hasher->height >> shift;
+        int firstLine = row * planeTile;
+        int lastLine = firstLine + planeTile < planeHeight ? firstLine + planeTile : planeHeight;
+        int tileBytes = planeTile * hasher->bytesPerPixel[plane];
+        int rowBytes = planeWidth * hasher->bytesPerPixel[plane];
+        for (int line = firstLine; line < lastLine; line++) {
+            const uint8_t *src = hasher->currentPlanes[plane] + (size_t)line * hasher->currentLinesizes[plane];
+            for (int column = 0; column < hasher->tileColumns; column++) {
+                int offset = column * tileBytes;
+                int size = offset + tileBytes < rowBytes ? tileBytes : rowBytes - offset;
+                hashBytes(src + offset, size, &accumulators[column * 2]);
+            }
+        }
+    }
+    for (int column = 0; column < hasher->tileColumns; column++) {
+        hasher->currentHashes[row * hasher->tileColumns + column] = finishHash(&accumulators[column * 2]);
+    }
+}
+
+int TileHasher::dirtyRegions(const uint64_t *hashes, uint64_t *uploaded, std::vector<TextureRegion> *regions, size_t *dirtyBytes) {
+    regions->clear();
+    int dirtyTiles = 0;
+    size_t bytes = 0;
+    for (int row = 0; row < tileRows; row++) {
+        int column = 0;
+        while (column < tileColumns) {
+            int index = row * tileColumns + column;
+            if (hashes[index] == uploaded[index]) {
+                column++;
+                continue;
+            }
+            int first = column;
+            while (column < tileColumns && hashes[row * tileColumns + column] != uploaded[row * tileColumns + column]) {
+                uploaded[row * tileColumns + column] = hashes[row * tileColumns + column];
+                column++;
+            }
+            dirtyTiles += column - first;
+
+            TextureRegion region;
+            region.x = first * tileSize;
+            region.y = row * tileSize;
+            region.width = (column * tileSize < width ? column * tileSize : width) - region.x;
+            region.height = ((row + 1) * tileSize < height ? (row + 1) * tileSize : height) - region.y;
+            bytes += regionBytes(region);
+
+            // һзΧͬºϲ
+            bool merged = false;
+            for (size_t k = 0; k < regions->size(); k++) {
+                TextureRegion &above = (*regions)[k];
+                if (above.x == region.x && above.width == region.width && above.y + above.height == region.y) {
+                    above.height += region.height;
+                    merged = true;
+                    break;
+                }
+            }
+            if (!merged) {
+                regions->push_back(region);
+            }
+        }
+    }
+    if (dirtyBytes != NULL) {
+        *dirtyBytes = bytes;
+    }
+    return dirtyTiles;
+}
+
+size_t TileHasher::frameBytes() const {
+    TextureRegion frame = { 0, 0, width, height };
+    return regionBytes(frame);
+}
+
+size_t TileHasher::regionBytes(const TextureRegion &region) const {
+    size_t bytes = 0;
+    for (int i = 0; i < planeCount; i++) {
+        bytes += (size_t)(region.width >> chromaShifts[i]) * bytesPerPixel[i] * (region.height >> chromaShifts[i]);
+    }
+    return bytes;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include "ThreadPool.h"
+#include "ErpViewport.h"
+
+/**
+* һֳ֡tileSize x tileSize()Ŀ, ÿƽϵݹϣ
+* ת̳߳߳ϰвмϣ, Ⱦ߳һϴĹϣȽ,
+* ֻϴݱ仯Ŀ; ¼, ̶λѭŵĻ泣дƬ֡䲻
+*/
+class TileHasher {
+public:
+    TileHasher(ThreadPool *pool);
+
+    // width/heightƽ, ƽiÿbytesPerPixel[i]ֽ, ߶chromaShifts[i]С
+    // tileSizeż, ı߽ܶ뵽4:2:0ɫƽ
+    bool init(int width, int height, int planeCount, const int *bytesPerPixel, const int *chromaShifts, int tileSize);
+
+    int tileCount() const {
+        return tileColumns * tileRows;
+    }
+
+    // ÿĹϣ, hashestileCount()Ԫ
+    void hashFrame(const uint8_t * const *planes, const int *linesizes, uint64_t *hashes);
+
+    // uploadedȽ, ѱ仯Ŀ鰴кϲɾдregions, ǵĹϣдuploaded
+    // ر仯Ŀ, dirtyBytesЩƽϵֽ
+    int dirtyRegions(const uint64_t *hashes, uint64_t *uploaded, std::vector<TextureRegion> *regions, size_t *dirtyBytes);
+
+    // һ֡ƽϵֽ
+    size_t frameBytes() const;
+
+private:
+    static void hashTileRow(void *context, int row);
+    size_t regionBytes(const TextureRegion &region) const;
+
+    ThreadPool *pool;
+    int width;
+    int height;
+    int planeCount;
+    int bytesPerPixel[3];
+    int chromaShifts[3];
+    int tileSize;
+    int tileColumns;
+    int tileRows;
+
+    // ǰhashFrameĲ, ֻhashFrame()ִڼЧ
+    const uint8_t * const *currentPlanes;
+    const int *currentLinesizes;
+    uint64_t *currentHashes;
+};
@@ -9,9 +9,33 @@ int main(int argc, char** argv) {
     
 
 	Player::Player *player = new Player::Player(argc,argv);
+
+	if (player->isYuvConverterBenchmark()) {
+		player->runYuvConverterBenchmark();
+		delete player;
+		return 0;
+	}
+
+	if (player->isMeshBuilderBenchmark()) {
+		player->runMeshBuilderBenchmark();
+		delete player;
+		return 0;
+	}
     
 	player->openVideo();
 
+	if (player->isDxtConvertMode()) {
+		player->runDxtConversion();
+		delete player;
+		return 0;
+	}
+
+	if (player->isBatchMode()) {
+		player->runBatchDecode();
+		delete player;
+		return 0;
+	}
+
 	player->setupThread();
 	player->renderLoopThread();
 
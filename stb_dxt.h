@@ -65,8 +65,11 @@
 #define STB_DXT_NORMAL    0
 #define STB_DXT_DITHER    1   // use dithering. dubious win. never use for normal maps and the like!
 #define STB_DXT_HIGHQUAL  2   // high quality mode, does two refinement steps instead of 1. ~30-40% slower.
+#define STB_DXT_FAST      4   // fast mode, bounding box endpoints instead of PCA and no refinement. overrides HIGHQUAL.
 
 void rygCompress( unsigned char *dst, unsigned char *src, int w, int h, int isDxt5 );
+// same as rygCompress, with the stb_compress_dxt_block mode as a parameter
+void rygCompressMode( unsigned char *dst, const unsigned char *src, int w, int h, int isDxt5, int mode );
 
 // TODO remove these, not working properly..
 void rygCompressYCoCg( unsigned char *dst, unsigned char *src, int w, int h );
@@ -99,6 +102,11 @@ void stb_compress_dxt_block(unsigned char *dest, const unsigned char *src, int a
 #include <iostream>
 #include <algorithm>
 
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define STB_DXT_SSE2
+#include <emmintrin.h>
+#endif
+
 
 static unsigned char stb__Expand5[32];
 static unsigned char stb__Expand6[64];
@@ -218,6 +226,69 @@ static void stb__DitherBlock(unsigned char *dest, unsigned char *block)
    }
 }
 
+#ifdef STB_DXT_SSE2
+// dot products of 4 RGBA pixels with (dirr,dirg,dirb,0), as 4 ints
+static inline __m128i stb__Dot4SSE2(__m128i pixels, __m128i dir)
+{
+   __m128i zero = _mm_setzero_si128();
+   __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero), dir);
+   __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(pixels, zero), dir);
+   // lo/hi hold (r*dirr+g*dirg, b*dirb) pairs per pixel; add the pairs
+   __m128 even = _mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi), _MM_SHUFFLE(2,0,2,0));
+   __m128 odd  = _mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi), _MM_SHUFFLE(3,1,3,1));
+   return _mm_add_epi32(_mm_castps_si128(even), _mm_castps_si128(odd));
+}
+
+// interleave the bits of two 16-bit values: result bit 2i = lo bit i, bit 2i+1 = hi bit i
+static inline unsigned int stb__Interleave16(unsigned int lo, unsigned int hi)
+{
+   unsigned int x = lo | (hi << 16);
+   // move hi bits into the odd positions: standard morton spread of both halves at once
+   unsigned int t;
+   t = (x ^ (x >> 8)) & 0x0000ff00; x ^= t ^ (t << 8);
+   t = (x ^ (x >> 4)) & 0x00f000f0; x ^= t ^ (t << 4);
+   t = (x ^ (x >> 2)) & 0x0c0c0c0c; x ^= t ^ (t << 2);
+   t = (x ^ (x >> 1)) & 0x22222222; x ^= t ^ (t << 1);
+   return x;
+}
+
+// non-dithered stb__MatchColorsBlock, 16 pixels at once. gives exactly the same mask.
+static unsigned int stb__MatchColorsBlockSSE2(const unsigned char *block, const unsigned char *color)
+{
+   int dirr = color[0*4+0] - color[1*4+0];
+   int dirg = color[0*4+1] - color[1*4+1];
+   int dirb = color[0*4+2] - color[1*4+2];
+   int stops[4];
+   int i;
+
+   for(i=0;i<4;i++)
+      stops[i] = color[i*4+0]*dirr + color[i*4+1]*dirg + color[i*4+2]*dirb;
+
+   __m128i dir = _mm_setr_epi16((short)dirr,(short)dirg,(short)dirb,0,(short)dirr,(short)dirg,(short)dirb,0);
+   __m128i c0Point   = _mm_set1_epi32((stops[1] + stops[3]) >> 1);
+   __m128i halfPoint = _mm_set1_epi32((stops[3] + stops[2]) >> 1);
+   __m128i c3Point   = _mm_set1_epi32((stops[2] + stops[0]) >> 1);
+   __m128i two = _mm_set1_epi32(2), three = _mm_set1_epi32(3);
+   __m128i index[4];
+
+   for(i=0;i<4;i++)
+   {
+      __m128i dots = stb__Dot4SSE2(_mm_loadu_si128((const __m128i *)(block + i*16)), dir);
+      // dot < halfPoint ? (dot < c0Point ? 1 : 3) : (dot < c3Point ? 2 : 0)
+      __m128i lower = _mm_cmplt_epi32(dots, halfPoint);
+      __m128i lowIndex = _mm_sub_epi32(three, _mm_and_si128(_mm_cmplt_epi32(dots, c0Point), two));
+      __m128i highIndex = _mm_and_si128(_mm_cmplt_epi32(dots, c3Point), two);
+      index[i] = _mm_or_si128(_mm_and_si128(lower, lowIndex), _mm_andnot_si128(lower, highIndex));
+   }
+
+   // 16 indices as bytes, then collect bit 0 and bit 1 of every index with movemask
+   __m128i bytes = _mm_packs_epi16(_mm_packs_epi32(index[0], index[1]), _mm_packs_epi32(index[2], index[3]));
+   unsigned int lo = _mm_movemask_epi8(_mm_slli_epi16(_mm_and_si128(bytes, _mm_set1_epi8(1)), 7));
+   unsigned int hi = _mm_movemask_epi8(_mm_slli_epi16(_mm_and_si128(bytes, _mm_set1_epi8(2)), 6));
+   return stb__Interleave16(lo, hi);
+}
+#endif
+
 // The color matching function
 static unsigned int stb__MatchColorsBlock(unsigned char *block, unsigned char *color,int dither)
 {
@@ -230,6 +301,11 @@ static unsigned int stb__MatchColorsBlock(unsigned char *block, unsigned char *c
    int i;
    int c0Point, halfPoint, c3Point;
 
+#ifdef STB_DXT_SSE2
+   if(!dither)
+      return stb__MatchColorsBlockSSE2(block,color);
+#endif
+
    for(i=0;i<16;i++)
       dots[i] = block[i*4+0]*dirr + block[i*4+1]*dirg + block[i*4+2]*dirb;
 
@@ -589,6 +665,51 @@ static int stb__RefineBlock(unsigned char *block, unsigned short *pmax16, unsign
    return oldMin != min16 || oldMax != max16;
 }
 
+// Fast endpoint selection: the corners of the color bounding box, inset by 1/16 of the range
+// (J.M.P. van Waveren, "Real-Time DXT Compression"). The diagonal is flipped per channel when
+// that channel is anti-correlated with green, otherwise blocks going e.g. from red to green
+// would be fitted along the wrong diagonal.
+static void stb__BoundingBoxColorsBlock(unsigned char *block, unsigned short *pmax16, unsigned short *pmin16)
+{
+   int mn[3], mx[3], mu[3];
+   int ch, i;
+   int covrg = 0, covbg = 0;
+
+   for(ch=0;ch<3;ch++)
+   {
+      int minv = block[ch], maxv = block[ch], sum = 0;
+      for(i=0;i<16;i++)
+      {
+         int v = block[i*4+ch];
+         sum += v;
+         if (v < minv) minv = v;
+         if (v > maxv) maxv = v;
+      }
+      mu[ch] = (sum + 8) >> 4;
+      mn[ch] = minv;
+      mx[ch] = maxv;
+   }
+
+   for(i=0;i<16;i++)
+   {
+      int g = block[i*4+1] - mu[1];
+      covrg += (block[i*4+0] - mu[0]) * g;
+      covbg += (block[i*4+2] - mu[2]) * g;
+   }
+
+   for(ch=0;ch<3;ch++)
+   {
+      int inset = (mx[ch] - mn[ch]) >> 4;
+      mn[ch] += inset;
+      mx[ch] -= inset;
+   }
+   if (covrg < 0) { int t = mn[0]; mn[0] = mx[0]; mx[0] = t; }
+   if (covbg < 0) { int t = mn[2]; mn[2] = mx[2]; mx[2] = t; }
+
+   *pmax16 = stb__As16Bit(mx[0],mx[1],mx[2]);
+   *pmin16 = stb__As16Bit(mn[0],mn[1],mn[2]);
+}
+
 // Color block compression
 static void stb__CompressColorBlock(unsigned char *dest, unsigned char *block, int mode)
 {
@@ -600,7 +721,7 @@ static void stb__CompressColorBlock(unsigned char *dest, unsigned char *block, i
    unsigned char dblock[16*4],color[4*4];
    
    dither = mode & STB_DXT_DITHER;
-   refinecount = (mode & STB_DXT_HIGHQUAL) ? 2 : 1;
+   refinecount = (mode & STB_DXT_FAST) ? 0 : (mode & STB_DXT_HIGHQUAL) ? 2 : 1;
 
    // check if block is constant
    for (i=1;i<16;i++)
@@ -619,8 +740,11 @@ static void stb__CompressColorBlock(unsigned char *dest, unsigned char *block, i
       if(dither)
          stb__DitherBlock(dblock,block);
 
-      // second step: pca+map along principal axis
-      stb__OptimizeColorsBlock(dither ? dblock : block,&max16,&min16);
+      // second step: pca+map along principal axis (or just the bounding box in fast mode)
+      if (mode & STB_DXT_FAST)
+         stb__BoundingBoxColorsBlock(dither ? dblock : block,&max16,&min16);
+      else
+         stb__OptimizeColorsBlock(dither ? dblock : block,&max16,&min16);
       if (max16 != min16) 
 	  {
          stb__EvalColors(color,max16,min16);
@@ -793,6 +917,12 @@ static void extractBlock(const unsigned char *src, int x, int y,
 	   // Full Square shortcut
 	   src += x*4;
 	   src += y*w*4;
+#ifdef STB_DXT_SSE2
+	   for (i=0; i < 4; ++i)
+	   {
+		   _mm_storeu_si128((__m128i *)(block + i*16), _mm_loadu_si128((const __m128i *)(src + i*w*4)));
+	   }
+#else
 	   for (i=0; i < 4; ++i)
 	   {
 		   *(unsigned int*)block = *(unsigned int*) src; block += 4; src += 4;
@@ -801,6 +931,7 @@ static void extractBlock(const unsigned char *src, int x, int y,
 		   *(unsigned int*)block = *(unsigned int*) src; block += 4; 
 		   src += (w*4) - 12;
 	   }
+#endif
 	   return;
    }
 #endif
@@ -938,6 +1069,11 @@ void rgbToYCoCgBlock( unsigned char * dst, const unsigned char * src )
 
 
 void rygCompress( unsigned char *dst, unsigned char *src, int w, int h, int isDxt5 )
+{
+   rygCompressMode(dst, src, w, h, isDxt5, 10);
+}
+
+void rygCompressMode( unsigned char *dst, const unsigned char *src, int w, int h, int isDxt5, int mode )
 {
    
    unsigned char block[64];
@@ -948,7 +1084,7 @@ void rygCompress( unsigned char *dst, unsigned char *src, int w, int h, int isDx
       for(x = 0; x < w; x += 4)
       {
          extractBlock(src, x, y, w, h, block);
-         stb_compress_dxt_block(dst, block, isDxt5, 10);
+         stb_compress_dxt_block(dst, block, isDxt5, mode);
          dst += isDxt5 ? 16 : 8;
       }
    }
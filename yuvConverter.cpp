@@ -1,23 +1,63 @@
 #include "yuvConverter.h"
+#include <iostream>
+#include <vector>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "TimeMeasurer.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define YUV_CONVERTER_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#elif defined(_M_ARM64) || defined(__ARM_NEON)
+#define YUV_CONVERTER_NEON
+#include <arm_neon.h>
+#endif
+
+// MSVCҪıѡʹAVX2intrinsics, GCC/ClangҪ
+#if defined(YUV_CONVERTER_X86) && defined(__GNUC__)
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
 static long int crv_tab[256];
 static long int cbu_tab[256];
 static long int cgu_tab[256];
 static long int cgv_tab[256];
 static long int tab_76309[256];
 static unsigned char clp[1024];
-void init_yuv420p_table() {
+static pthread_once_t tableOnce = PTHREAD_ONCE_INIT;
+
+// ʵʹõĶϵ, SIMDʵֱ֮λһ
+static const int COEFFICIENT_Y = 76309;
+static const int COEFFICIENT_RV = 104597;
+static const int COEFFICIENT_BU = 132201;
+static const int COEFFICIENT_GU = 25675;
+static const int COEFFICIENT_GV = 53279;
+
+// ÿ߳ƽֵ
+static const int BANDS_PER_THREAD = 4;
+
+static void build_yuv420p_table() {
 	long int crv, cbu, cgu, cgv;
 	int i, ind;
 
-	crv = 104597; cbu = 132201;  /* fra matrise i global.h */
-	cgu = 25675;  cgv = 53279;
+	crv = COEFFICIENT_RV; cbu = COEFFICIENT_BU;  /* fra matrise i global.h */
+	cgu = COEFFICIENT_GU;  cgv = COEFFICIENT_GV;
 
 	for (i = 0; i < 256; i++) {
 		crv_tab[i] = (i - 128) * crv;
 		cbu_tab[i] = (i - 128) * cbu;
 		cgu_tab[i] = (i - 128) * cgu;
 		cgv_tab[i] = (i - 128) * cgv;
-		tab_76309[i] = 76309 * (i - 16);
+		tab_76309[i] = COEFFICIENT_Y * (i - 16);
 	}
 
 	for (i = 0; i < 384; i++)
@@ -30,6 +70,560 @@ void init_yuv420p_table() {
 		clp[ind++] = 255;
 }
 
+/**
+* ת߳̿ͬʱһε, pthread_once֤ұֻʼһ
+*/
+void init_yuv420p_table() {
+	pthread_once(&tableOnce, build_yuv420p_table);
+}
+
+// ת, йһɫ, ӵstartؿʼwidthΪֹ
+// NV12ʱsrc_uָ򽻴UV, src_vʹ
+typedef void(*RowPairKernel)(const unsigned char *py1, const unsigned char *py2, const unsigned char *src_u, const unsigned char *src_v,
+	unsigned char *d1, unsigned char *d2, int width);
+
+template <int LAYOUT>
+static inline void store_pixel(unsigned char *d, int y, int c1, int c2, int c3, int c4) {
+	unsigned char r = clp[384 + ((y + c1) >> 16)];
+	unsigned char g = clp[384 + ((y - c2 - c3) >> 16)];
+	unsigned char b = clp[384 + ((y + c4) >> 16)];
+	if (LAYOUT == RPL_BGRA) {
+		d[0] = b;
+		d[1] = g;
+		d[2] = r;
+	} else {
+		d[0] = r;
+		d[1] = g;
+		d[2] = b;
+	}
+	if (LAYOUT != RPL_RGB24) {
+		d[3] = 255;
+	}
+}
+
+template <int CHROMA, int LAYOUT>
+static void convert_row_pair_scalar(const unsigned char *py1, const unsigned char *py2, const unsigned char *src_u, const unsigned char *src_v,
+	unsigned char *d1, unsigned char *d2, int start, int width) {
+	const int bytesPerPixel = LAYOUT == RPL_RGB24 ? 3 : 4;
+	int u, v;
+	int i, c1, c2, c3, c4;
+
+	for (i = start; i < width; i += 2) {
+		if (CHROMA == YCL_NV12) {
+			u = src_u[i];
+			v = src_u[i + 1];
+		} else {
+			u = src_u[i / 2];
+			v = src_v[i / 2];
+		}
+
+		c1 = crv_tab[v];
+		c2 = cgu_tab[u];
+		c3 = cgv_tab[v];
+		c4 = cbu_tab[u];
+
+		//up-left, down-left
+		store_pixel<LAYOUT>(d1 + i * bytesPerPixel, tab_76309[py1[i]], c1, c2, c3, c4);
+		store_pixel<LAYOUT>(d2 + i * bytesPerPixel, tab_76309[py2[i]], c1, c2, c3, c4);
+
+		// Ϊʱһֻߵ
+		if (i + 1 == width) {
+			break;
+		}
+
+		//up-right, down-right
+		store_pixel<LAYOUT>(d1 + (i + 1) * bytesPerPixel, tab_76309[py1[i + 1]], c1, c2, c3, c4);
+		store_pixel<LAYOUT>(d2 + (i + 1) * bytesPerPixel, tab_76309[py2[i + 1]], c1, c2, c3, c4);
+	}
+}
+
+template <int CHROMA, int LAYOUT>
+static void convert_row_pair_table(const unsigned char *py1, const unsigned char *py2, const unsigned char *src_u, const unsigned char *src_v,
+	unsigned char *d1, unsigned char *d2, int width) {
+	convert_row_pair_scalar<CHROMA, LAYOUT>(py1, py2, src_u, src_v, d1, d2, 0, width);
+}
+
+#ifdef YUV_CONVERTER_X86
+/**
+* SSE2û32λ˷, _mm_madd_epi1616λ˼
+* 16λϵ c = hi * 32768 + lo, ˻ = (madd(x, hi) << 15) + madd(x, lo), 32λû
+*/
+static inline __m128i coefficient_pair(int first, int second) {
+	return _mm_set1_epi32((int)(((unsigned int)second << 16) | ((unsigned int)first & 0xFFFF)));
+}
+
+static inline __m128i multiply_pair_sse2(__m128i pairs, int first, int second) {
+	__m128i high = _mm_madd_epi16(pairs, coefficient_pair(first >> 15, second >> 15));
+	__m128i low = _mm_madd_epi16(pairs, coefficient_pair(first & 0x7FFF, second & 0x7FFF));
+	return _mm_add_epi32(_mm_slli_epi32(high, 15), low);
+}
+
+// 4صRGB0ѹ12ֽд
+static inline void store_rgb0_as_rgb_sse2(unsigned char *dest, __m128i rgb0) {
+	const __m128i firstPixel = _mm_set1_epi64x(0x0000000000FFFFFFLL);
+	const __m128i secondPixel = _mm_set1_epi64x(0x0000FFFFFF000000LL);
+	// ÿ64λ: ֽ0-2Ϊһ, ֽ3-5Ϊڶ
+	__m128i packed = _mm_or_si128(_mm_and_si128(rgb0, firstPixel), _mm_and_si128(_mm_srli_epi64(rgb0, 8), secondPixel));
+	packed = _mm_or_si128(_mm_move_epi64(packed), _mm_slli_si128(_mm_srli_si128(packed, 8), 6));
+	_mm_storel_epi64((__m128i *)dest, packed);
+	int tail = _mm_cvtsi128_si32(_mm_srli_si128(packed, 8));
+	memcpy(dest + 8, &tail, 4);
+}
+
+static inline void store_rgb24_sse2(unsigned char *dest, __m128i r, __m128i g, __m128i b) {
+	const __m128i zero = _mm_setzero_si128();
+	__m128i rg = _mm_unpacklo_epi8(r, g);
+	__m128i b0 = _mm_unpacklo_epi8(b, zero);
+	store_rgb0_as_rgb_sse2(dest, _mm_unpacklo_epi16(rg, b0));
+	store_rgb0_as_rgb_sse2(dest + 12, _mm_unpackhi_epi16(rg, b0));
+	rg = _mm_unpackhi_epi8(r, g);
+	b0 = _mm_unpackhi_epi8(b, zero);
+	store_rgb0_as_rgb_sse2(dest + 24, _mm_unpacklo_epi16(rg, b0));
+	store_rgb0_as_rgb_sse2(dest + 36, _mm_unpackhi_epi16(rg, b0));
+}
+
+// 16ص, ÿ4һ (Y - 16) * 76309
+static inline void luma_terms_sse2(const unsigned char *py, __m128i terms[4]) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i offset = _mm_set1_epi16(16);
+	__m128i y = _mm_loadu_si128((const __m128i *)py);
+	__m128i y16[2] = { _mm_sub_epi16(_mm_unpacklo_epi8(y, zero), offset), _mm_sub_epi16(_mm_unpackhi_epi8(y, zero), offset) };
+	for (int k = 0; k < 2; k++) {
+		terms[k * 2] = multiply_pair_sse2(_mm_unpacklo_epi16(y16[k], zero), COEFFICIENT_Y, 0);
+		terms[k * 2 + 1] = multiply_pair_sse2(_mm_unpackhi_epi16(y16[k], zero), COEFFICIENT_Y, 0);
+	}
+}
+
+static inline __m128i pack_channel_sse2(const __m128i values[4]) {
+	return _mm_packus_epi16(_mm_packs_epi32(_mm_srai_epi32(values[0], 16), _mm_srai_epi32(values[1], 16)),
+		_mm_packs_epi32(_mm_srai_epi32(values[2], 16), _mm_srai_epi32(values[3], 16)));
+}
+
+// ÿд4ֽ, c0/c1/c2Ϊǰֽ, ĸֽΪ͸alpha
+static inline void store_rgba_sse2(unsigned char *dest, __m128i c0, __m128i c1, __m128i c2) {
+	const __m128i alpha = _mm_set1_epi8(-1);
+	__m128i c01 = _mm_unpacklo_epi8(c0, c1);
+	__m128i c2a = _mm_unpacklo_epi8(c2, alpha);
+	_mm_storeu_si128((__m128i *)dest, _mm_unpacklo_epi16(c01, c2a));
+	_mm_storeu_si128((__m128i *)(dest + 16), _mm_unpackhi_epi16(c01, c2a));
+	c01 = _mm_unpackhi_epi8(c0, c1);
+	c2a = _mm_unpackhi_epi8(c2, alpha);
+	_mm_storeu_si128((__m128i *)(dest + 32), _mm_unpacklo_epi16(c01, c2a));
+	_mm_storeu_si128((__m128i *)(dest + 48), _mm_unpackhi_epi16(c01, c2a));
+}
+
+// д16, RGB24ʱʹrgb24Store
+template <int LAYOUT, void(*rgb24Store)(unsigned char *, __m128i, __m128i, __m128i)>
+static inline void store_pixels_x86(unsigned char *dest, __m128i r, __m128i g, __m128i b) {
+	if (LAYOUT == RPL_RGB24) {
+		rgb24Store(dest, r, g, b);
+	} else if (LAYOUT == RPL_BGRA) {
+		store_rgba_sse2(dest, b, g, r);
+	} else {
+		store_rgba_sse2(dest, r, g, b);
+	}
+}
+
+// 16عõ8ɫ, ȥ128Ϊ16λ
+template <int CHROMA>
+static inline void load_chroma_sse2(const unsigned char *src_u, const unsigned char *src_v, int i, __m128i *u, __m128i *v) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i offset = _mm_set1_epi16(128);
+	if (CHROMA == YCL_NV12) {
+		// ÿ16λеֽΪU, ֽΪV
+		__m128i uv = _mm_loadu_si128((const __m128i *)(src_u + i));
+		*u = _mm_sub_epi16(_mm_and_si128(uv, _mm_set1_epi16(0xFF)), offset);
+		*v = _mm_sub_epi16(_mm_srli_epi16(uv, 8), offset);
+	} else {
+		*u = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(src_u + i / 2)), zero), offset);
+		*v = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(src_v + i / 2)), zero), offset);
+	}
+}
+
+template <int CHROMA, int LAYOUT>
+static void convert_row_pair_sse2(const unsigned char *py1, const unsigned char *py2, const unsigned char *src_u, const unsigned char *src_v,
+	unsigned char *d1, unsigned char *d2, int width) {
+	const int bytesPerPixel = LAYOUT == RPL_RGB24 ? 3 : 4;
+	int i = 0;
+	for (; i + 16 <= width; i += 16) {
+		__m128i u, v;
+		load_chroma_sse2<CHROMA>(src_u, src_v, i, &u, &v);
+		// ÿ32λһ(U, V), عһ
+		__m128i uv[2] = { _mm_unpacklo_epi16(u, v), _mm_unpackhi_epi16(u, v) };
+		__m128i red[4], green[4], blue[4];
+		for (int k = 0; k < 2; k++) {
+			__m128i rc = multiply_pair_sse2(uv[k], 0, COEFFICIENT_RV);
+			__m128i gc = multiply_pair_sse2(uv[k], -COEFFICIENT_GU, -COEFFICIENT_GV);
+			__m128i bc = multiply_pair_sse2(uv[k], COEFFICIENT_BU, 0);
+			red[k * 2] = _mm_unpacklo_epi32(rc, rc);
+			red[k * 2 + 1] = _mm_unpackhi_epi32(rc, rc);
+			green[k * 2] = _mm_unpacklo_epi32(gc, gc);
+			green[k * 2 + 1] = _mm_unpackhi_epi32(gc, gc);
+			blue[k * 2] = _mm_unpacklo_epi32(bc, bc);
+			blue[k * 2 + 1] = _mm_unpackhi_epi32(bc, bc);
+		}
+
+		const unsigned char *rows[2] = { py1 + i, py2 + i };
+		unsigned char *dests[2] = { d1 + i * bytesPerPixel, d2 + i * bytesPerPixel };
+		for (int row = 0; row < 2; row++) {
+			__m128i y[4], r[4], g[4], b[4];
+			luma_terms_sse2(rows[row], y);
+			for (int k = 0; k < 4; k++) {
+				r[k] = _mm_add_epi32(y[k], red[k]);
+				g[k] = _mm_add_epi32(y[k], green[k]);
+				b[k] = _mm_add_epi32(y[k], blue[k]);
+			}
+			store_pixels_x86<LAYOUT, store_rgb24_sse2>(dests[row], pack_channel_sse2(r), pack_channel_sse2(g), pack_channel_sse2(b));
+		}
+	}
+	convert_row_pair_scalar<CHROMA, LAYOUT>(py1, py2, src_u, src_v, d1, d2, i, width);
+}
+
+/**
+* AVX232λ˷, ֱӰ32λ8, ʱpshufb֯RGB24
+*/
+TARGET_AVX2 static inline __m128i pack_channel_avx2(__m256i low, __m256i high) {
+	__m256i packed16 = _mm256_packs_epi32(_mm256_srai_epi32(low, 16), _mm256_srai_epi32(high, 16));
+	packed16 = _mm256_permute4x64_epi64(packed16, 0xD8);
+	__m256i packed8 = _mm256_packus_epi16(packed16, packed16);
+	return _mm256_castsi256_si128(_mm256_permute4x64_epi64(packed8, 0x08));
+}
+
+TARGET_AVX2 static inline void store_rgb24_ssse3(unsigned char *dest, __m128i r, __m128i g, __m128i b) {
+	const __m128i r0 = _mm_setr_epi8(0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1, 5);
+	const __m128i g0 = _mm_setr_epi8(-1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1);
+	const __m128i b0 = _mm_setr_epi8(-1, -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1);
+	const __m128i r1 = _mm_setr_epi8(-1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10, -1);
+	const __m128i g1 = _mm_setr_epi8(5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10);
+	const __m128i b1 = _mm_setr_epi8(-1, 5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1);
+	const __m128i r2 = _mm_setr_epi8(-1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1, -1);
+	const __m128i g2 = _mm_setr_epi8(-1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1);
+	const __m128i b2 = _mm_setr_epi8(10, -1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15);
+	_mm_storeu_si128((__m128i *)dest, _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, r0), _mm_shuffle_epi8(g, g0)), _mm_shuffle_epi8(b, b0)));
+	_mm_storeu_si128((__m128i *)(dest + 16), _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, r1), _mm_shuffle_epi8(g, g1)), _mm_shuffle_epi8(b, b1)));
+	_mm_storeu_si128((__m128i *)(dest + 32), _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, r2), _mm_shuffle_epi8(g, g2)), _mm_shuffle_epi8(b, b2)));
+}
+
+// 16عõ8ɫ, ȥ128չΪ32λ
+template <int CHROMA>
+TARGET_AVX2 static inline void load_chroma_avx2(const unsigned char *src_u, const unsigned char *src_v, int i, __m256i *u, __m256i *v) {
+	const __m256i offset = _mm256_set1_epi32(128);
+	__m128i u8, v8;
+	if (CHROMA == YCL_NV12) {
+		__m128i uv = _mm_loadu_si128((const __m128i *)(src_u + i));
+		u8 = _mm_shuffle_epi8(uv, _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, -1, -1, -1, -1, -1, -1, -1, -1));
+		v8 = _mm_shuffle_epi8(uv, _mm_setr_epi8(1, 3, 5, 7, 9, 11, 13, 15, -1, -1, -1, -1, -1, -1, -1, -1));
+	} else {
+		u8 = _mm_loadl_epi64((const __m128i *)(src_u + i / 2));
+		v8 = _mm_loadl_epi64((const __m128i *)(src_v + i / 2));
+	}
+	*u = _mm256_sub_epi32(_mm256_cvtepu8_epi32(u8), offset);
+	*v = _mm256_sub_epi32(_mm256_cvtepu8_epi32(v8), offset);
+}
+
+template <int CHROMA, int LAYOUT>
+TARGET_AVX2 static void convert_row_pair_avx2(const unsigned char *py1, const unsigned char *py2, const unsigned char *src_u, const unsigned char *src_v,
+	unsigned char *d1, unsigned char *d2, int width) {
+	const int bytesPerPixel = LAYOUT == RPL_RGB24 ? 3 : 4;
+	const __m256i lumaOffset = _mm256_set1_epi32(16);
+	const __m256i duplicateLow = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+	const __m256i duplicateHigh = _mm256_setr_epi32(4, 4, 5, 5, 6, 6, 7, 7);
+	int i = 0;
+	for (; i + 16 <= width; i += 16) {
+		__m256i u, v;
+		load_chroma_avx2<CHROMA>(src_u, src_v, i, &u, &v);
+		__m256i rc = _mm256_mullo_epi32(v, _mm256_set1_epi32(COEFFICIENT_RV));
+		__m256i gc = _mm256_add_epi32(_mm256_mullo_epi32(u, _mm256_set1_epi32(-COEFFICIENT_GU)), _mm256_mullo_epi32(v, _mm256_set1_epi32(-COEFFICIENT_GV)));
+		__m256i bc = _mm256_mullo_epi32(u, _mm256_set1_epi32(COEFFICIENT_BU));
+		__m256i red[2] = { _mm256_permutevar8x32_epi32(rc, duplicateLow), _mm256_permutevar8x32_epi32(rc, duplicateHigh) };
+		__m256i green[2] = { _mm256_permutevar8x32_epi32(gc, duplicateLow), _mm256_permutevar8x32_epi32(gc, duplicateHigh) };
+		__m256i blue[2] = { _mm256_permutevar8x32_epi32(bc, duplicateLow), _mm256_permutevar8x32_epi32(bc, duplicateHigh) };
+
+		const unsigned char *rows[2] = { py1 + i, py2 + i };
+		unsigned char *dests[2] = { d1 + i * bytesPerPixel, d2 + i * bytesPerPixel };
+		for (int row = 0; row < 2; row++) {
+			__m256i y[2];
+			for (int k = 0; k < 2; k++) {
+				y[k] = _mm256_sub_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(rows[row] + k * 8))), lumaOffset);
+				y[k] = _mm256_mullo_epi32(y[k], _mm256_set1_epi32(COEFFICIENT_Y));
+			}
+			__m128i r = pack_channel_avx2(_mm256_add_epi32(y[0], red[0]), _mm256_add_epi32(y[1], red[1]));
+			__m128i g = pack_channel_avx2(_mm256_add_epi32(y[0], green[0]), _mm256_add_epi32(y[1], green[1]));
+			__m128i b = pack_channel_avx2(_mm256_add_epi32(y[0], blue[0]), _mm256_add_epi32(y[1], blue[1]));
+			store_pixels_x86<LAYOUT, store_rgb24_ssse3>(dests[row], r, g, b);
+		}
+	}
+	convert_row_pair_scalar<CHROMA, LAYOUT>(py1, py2, src_u, src_v, d1, d2, i, width);
+}
+
+static void cpuid(int leaf, int subleaf, unsigned int registers[4]) {
+#ifdef _MSC_VER
+	__cpuidex((int *)registers, leaf, subleaf);
+#else
+	__cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+
+static bool cpu_supports_avx2() {
+	unsigned int registers[4];
+	cpuid(0, 0, registers);
+	if (registers[0] < 7) {
+		return false;
+	}
+	cpuid(1, 0, registers);
+	// ҪϵͳлʱYMMĴ
+	bool osxsave = (registers[2] & (1 << 27)) != 0;
+	bool avx = (registers[2] & (1 << 28)) != 0;
+	if (!osxsave || !avx) {
+		return false;
+	}
+#ifdef _MSC_VER
+	unsigned long long xcr0 = _xgetbv(0);
+#else
+	unsigned int eax, edx;
+	__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	unsigned long long xcr0 = ((unsigned long long)edx << 32) | eax;
+#endif
+	if ((xcr0 & 6) != 6) {
+		return false;
+	}
+	cpuid(7, 0, registers);
+	return (registers[1] & (1 << 5)) != 0;
+}
+#endif
+
+#ifdef YUV_CONVERTER_NEON
+/**
+* NEON32λ˷ͨ֯洢, ֱӰʵֵĹʽ
+*/
+static inline uint8x8_t pack_channel_neon(int32x4_t low, int32x4_t high) {
+	return vqmovun_s16(vcombine_s16(vqmovn_s32(vshrq_n_s32(low, 16)), vqmovn_s32(vshrq_n_s32(high, 16))));
+}
+
+template <int CHROMA, int LAYOUT>
+static void convert_row_pair_neon(const unsigned char *py1, const unsigned char *py2, const unsigned char *src_u, const unsigned char *src_v,
+	unsigned char *d1, unsigned char *d2, int width) {
+	const int bytesPerPixel = LAYOUT == RPL_RGB24 ? 3 : 4;
+	int i = 0;
+	for (; i + 16 <= width; i += 16) {
+		uint8x8_t u8, v8;
+		if (CHROMA == YCL_NV12) {
+			// vld2ѽUV·
+			uint8x8x2_t uv = vld2_u8(src_u + i);
+			u8 = uv.val[0];
+			v8 = uv.val[1];
+		} else {
+			u8 = vld1_u8(src_u + i / 2);
+			v8 = vld1_u8(src_v + i / 2);
+		}
+		int16x8_t u = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(u8)), vdupq_n_s16(128));
+		int16x8_t v = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(v8)), vdupq_n_s16(128));
+		int32x4_t red[4], green[4], blue[4];
+		for (int k = 0; k < 2; k++) {
+			int32x4_t u32 = vmovl_s16(k == 0 ? vget_low_s16(u) : vget_high_s16(u));
+			int32x4_t v32 = vmovl_s16(k == 0 ? vget_low_s16(v) : vget_high_s16(v));
+			int32x4_t rc = vmulq_n_s32(v32, COEFFICIENT_RV);
+			int32x4_t gc = vmlaq_n_s32(vmulq_n_s32(u32, -COEFFICIENT_GU), v32, -COEFFICIENT_GV);
+			int32x4_t bc = vmulq_n_s32(u32, COEFFICIENT_BU);
+			// عһɫ
+			int32x4x2_t rcd = vzipq_s32(rc, rc);
+			int32x4x2_t gcd = vzipq_s32(gc, gc);
+			int32x4x2_t bcd = vzipq_s32(bc, bc);
+			red[k * 2] = rcd.val[0];
+			red[k * 2 + 1] = rcd.val[1];
+			green[k * 2] = gcd.val[0];
+			green[k * 2 + 1] = gcd.val[1];
+			blue[k * 2] = bcd.val[0];
+			blue[k * 2 + 1] = bcd.val[1];
+		}
+
+		const unsigned char *rows[2] = { py1 + i, py2 + i };
+		unsigned char *dests[2] = { d1 + i * bytesPerPixel, d2 + i * bytesPerPixel };
+		for (int row = 0; row < 2; row++) {
+			uint8x16_t y8 = vld1q_u8(rows[row]);
+			int16x8_t y16[2] = {
+				vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(y8))), vdupq_n_s16(16)),
+				vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(y8))), vdupq_n_s16(16))
+			};
+			int32x4_t y[4];
+			for (int k = 0; k < 2; k++) {
+				y[k * 2] = vmulq_n_s32(vmovl_s16(vget_low_s16(y16[k])), COEFFICIENT_Y);
+				y[k * 2 + 1] = vmulq_n_s32(vmovl_s16(vget_high_s16(y16[k])), COEFFICIENT_Y);
+			}
+			uint8x16_t r = vcombine_u8(pack_channel_neon(vaddq_s32(y[0], red[0]), vaddq_s32(y[1], red[1])),
+				pack_channel_neon(vaddq_s32(y[2], red[2]), vaddq_s32(y[3], red[3])));
+			uint8x16_t g = vcombine_u8(pack_channel_neon(vaddq_s32(y[0], green[0]), vaddq_s32(y[1], green[1])),
+				pack_channel_neon(vaddq_s32(y[2], green[2]), vaddq_s32(y[3], green[3])));
+			uint8x16_t b = vcombine_u8(pack_channel_neon(vaddq_s32(y[0], blue[0]), vaddq_s32(y[1], blue[1])),
+				pack_channel_neon(vaddq_s32(y[2], blue[2]), vaddq_s32(y[3], blue[3])));
+			if (LAYOUT == RPL_RGB24) {
+				uint8x16x3_t rgb = { { r, g, b } };
+				vst3q_u8(dests[row], rgb);
+			} else {
+				uint8x16x4_t rgba = { { LAYOUT == RPL_BGRA ? b : r, g, LAYOUT == RPL_BGRA ? r : b, vdupq_n_u8(255) } };
+				vst4q_u8(dests[row], rgba);
+			}
+		}
+	}
+	convert_row_pair_scalar<CHROMA, LAYOUT>(py1, py2, src_u, src_v, d1, d2, i, width);
+}
+#endif
+
+bool yuv_converter_kernel_supported(YuvConverterKernel kernel) {
+	switch (kernel) {
+	case YCK_SCALAR:
+	case YCK_AUTO:
+		return true;
+#ifdef YUV_CONVERTER_X86
+	case YCK_SSE2:
+		return true;
+	case YCK_AVX2: {
+		static bool avx2 = cpu_supports_avx2();
+		return avx2;
+	}
+#endif
+#ifdef YUV_CONVERTER_NEON
+	case YCK_NEON:
+		return true;
+#endif
+	default:
+		return false;
+	}
+}
+
+YuvConverterKernel detect_yuv_converter_kernel() {
+	if (yuv_converter_kernel_supported(YCK_AVX2)) {
+		return YCK_AVX2;
+	}
+	if (yuv_converter_kernel_supported(YCK_NEON)) {
+		return YCK_NEON;
+	}
+	if (yuv_converter_kernel_supported(YCK_SSE2)) {
+		return YCK_SSE2;
+	}
+	return YCK_SCALAR;
+}
+
+const char *yuv_converter_kernel_name(YuvConverterKernel kernel) {
+	switch (kernel) {
+	case YCK_SCALAR:
+		return "table";
+	case YCK_SSE2:
+		return "SSE2";
+	case YCK_AVX2:
+		return "AVX2";
+	case YCK_NEON:
+		return "NEON";
+	default:
+		return "auto";
+	}
+}
+
+template <int CHROMA, int LAYOUT>
+static RowPairKernel row_pair_kernel_for_layout(YuvConverterKernel kernel) {
+	switch (kernel) {
+#ifdef YUV_CONVERTER_X86
+	case YCK_SSE2:
+		return convert_row_pair_sse2<CHROMA, LAYOUT>;
+	case YCK_AVX2:
+		return convert_row_pair_avx2<CHROMA, LAYOUT>;
+#endif
+#ifdef YUV_CONVERTER_NEON
+	case YCK_NEON:
+		return convert_row_pair_neon<CHROMA, LAYOUT>;
+#endif
+	default:
+		return convert_row_pair_table<CHROMA, LAYOUT>;
+	}
+}
+
+template <int CHROMA>
+static RowPairKernel row_pair_kernel_for_chroma(YuvConverterKernel kernel, RgbPixelLayout pixelLayout) {
+	switch (pixelLayout) {
+	case RPL_RGBA:
+		return row_pair_kernel_for_layout<CHROMA, RPL_RGBA>(kernel);
+	case RPL_BGRA:
+		return row_pair_kernel_for_layout<CHROMA, RPL_BGRA>(kernel);
+	default:
+		return row_pair_kernel_for_layout<CHROMA, RPL_RGB24>(kernel);
+	}
+}
+
+static RowPairKernel row_pair_kernel(YuvConverterKernel kernel, YuvChromaLayout chromaLayout, RgbPixelLayout pixelLayout) {
+	if (kernel == YCK_AUTO || !yuv_converter_kernel_supported(kernel)) {
+		kernel = detect_yuv_converter_kernel();
+	}
+	if (chromaLayout == YCL_NV12) {
+		return row_pair_kernel_for_chroma<YCL_NV12>(kernel, pixelLayout);
+	}
+	return row_pair_kernel_for_chroma<YCL_PLANAR>(kernel, pixelLayout);
+}
+
+// һתĲ, ֻ
+struct ConversionTask {
+	const unsigned char * const *planes;
+	const int *linesizes;
+	bool interleavedChroma;
+	unsigned char *rgbbuffer;
+	int rgbLinesize;
+	int width;
+	int height;
+	int bandCount;
+	RowPairKernel kernel;
+};
+
+static void convert_band(void *context, int bandIndex) {
+	const ConversionTask *task = (const ConversionTask *)context;
+	int rowPairs = (task->height + 1) / 2;
+	int firstPair = rowPairs * bandIndex / task->bandCount;
+	int lastPair = rowPairs * (bandIndex + 1) / task->bandCount;
+	for (int pair = firstPair; pair < lastPair; pair++) {
+		int row = pair * 2;
+		// ߶Ϊʱһеɶ, ָͬһ, дĽͬ
+		int nextRow = row + 1 < task->height ? row + 1 : row;
+		const unsigned char *src_u = task->planes[1] + (size_t)pair * task->linesizes[1];
+		const unsigned char *src_v = task->interleavedChroma ? src_u : task->planes[2] + (size_t)pair * task->linesizes[2];
+		task->kernel(task->planes[0] + (size_t)row * task->linesizes[0], task->planes[0] + (size_t)nextRow * task->linesizes[0],
+			src_u, src_v,
+			task->rgbbuffer + (size_t)row * task->rgbLinesize, task->rgbbuffer + (size_t)nextRow * task->rgbLinesize, task->width);
+	}
+}
+
+void yuv420_to_rgb(const unsigned char * const planes[], const int linesizes[], YuvChromaLayout chromaLayout,
+	unsigned char *dst, int dstLinesize, RgbPixelLayout pixelLayout, int width, int height,
+	ThreadPool *pool, YuvConverterKernel kernel) {
+	init_yuv420p_table();
+
+	ConversionTask task;
+	task.planes = planes;
+	task.linesizes = linesizes;
+	task.interleavedChroma = chromaLayout == YCL_NV12;
+	task.rgbbuffer = dst;
+	task.rgbLinesize = dstLinesize;
+	task.width = width;
+	task.height = height;
+	task.kernel = row_pair_kernel(kernel, chromaLayout, pixelLayout);
+	task.bandCount = 1;
+	if (pool != NULL) {
+		int rowPairs = (height + 1) / 2;
+		task.bandCount = pool->size() * BANDS_PER_THREAD;
+		if (task.bandCount > rowPairs) {
+			task.bandCount = rowPairs;
+		}
+	}
+
+	if (task.bandCount > 1) {
+		pool->parallelFor(task.bandCount, convert_band, &task);
+	} else if (task.bandCount == 1) {
+		convert_band(&task, 0);
+	}
+}
+
+void yuv420p_to_rgb24(const unsigned char * const planes[3], const int linesizes[3], unsigned char *rgbbuffer, int rgbLinesize,
+	int width, int height, ThreadPool *pool, YuvConverterKernel kernel) {
+	yuv420_to_rgb(planes, linesizes, YCL_PLANAR, rgbbuffer, rgbLinesize, RPL_RGB24, width, height, pool, kernel);
+}
+
 /**
 ڴֲ
 w
@@ -52,64 +646,63 @@ w
 w/2
 */
 void yuv420p_to_rgb24(unsigned char* yuvbuffer, unsigned char* rgbbuffer, int width, int height) {
-	int y1, y2, u, v;
-	unsigned char *py1, *py2;
-	int i, j, c1, c2, c3, c4;
-	unsigned char *d1, *d2;
-	unsigned char *src_u, *src_v;
-	static int init_yuv420p = 0;
-
-	src_u = yuvbuffer + width * height;   // u
-	src_v = src_u + width * height / 4;  // v
-
-	py1 = yuvbuffer;   // y
-	py2 = py1 + width;
-	d1 = rgbbuffer;
-	d2 = d1 + 3 * width;
-
-	if (init_yuv420p == 0) {
-		init_yuv420p_table();
-		init_yuv420p = 1;
-	}
-
-	for (j = 0; j < height; j += 2) {
-		for (i = 0; i < width; i += 2) {
-			u = *src_u++;
-			v = *src_v++;
-
-			c1 = crv_tab[v];
-			c2 = cgu_tab[u];
-			c3 = cgv_tab[v];
-			c4 = cbu_tab[u];
-
-			//up-left   
-			y1 = tab_76309[*py1++];
-			*d1++ = clp[384 + ((y1 + c1) >> 16)];
-			*d1++ = clp[384 + ((y1 - c2 - c3) >> 16)];
-			*d1++ = clp[384 + ((y1 + c4) >> 16)];
-
-			//down-left   
-			y2 = tab_76309[*py2++];
-			*d2++ = clp[384 + ((y2 + c1) >> 16)];
-			*d2++ = clp[384 + ((y2 - c2 - c3) >> 16)];
-			*d2++ = clp[384 + ((y2 + c4) >> 16)];
-
-			//up-right   
-			y1 = tab_76309[*py1++];
-			*d1++ = clp[384 + ((y1 + c1) >> 16)];
-			*d1++ = clp[384 + ((y1 - c2 - c3) >> 16)];
-			*d1++ = clp[384 + ((y1 + c4) >> 16)];
-
-			//down-right   
-			y2 = tab_76309[*py2++];
-			*d2++ = clp[384 + ((y2 + c1) >> 16)];
-			*d2++ = clp[384 + ((y2 - c2 - c3) >> 16)];
-			*d2++ = clp[384 + ((y2 + c4) >> 16)];
-		}
-		d1 += 3 * width;
-		d2 += 3 * width;
-		py1 += width;
-		py2 += width;
+	const unsigned char *planes[3] = { yuvbuffer, yuvbuffer + width * height, yuvbuffer + width * height + width * height / 4 };
+	int linesizes[3] = { width, width / 2, width / 2 };
+	yuv420p_to_rgb24(planes, linesizes, rgbbuffer, width * 3, width, height, NULL, YCK_AUTO);
+}
+
+/**
+* һʵתһ֡ƽʱ(), ʵֵĽֽڱȽ
+*/
+static double measure_yuv420p_to_rgb24(const unsigned char * const planes[3], const int linesizes[3], unsigned char *rgbbuffer,
+	const unsigned char *reference, int width, int height, ThreadPool *pool, YuvConverterKernel kernel, int iterations) {
+	memset(rgbbuffer, 0, (size_t)width * height * 3);
+	TimeMeasurer timeMeasurer;
+	timeMeasurer.Start();
+	for (int i = 0; i < iterations; i++) {
+		yuv420p_to_rgb24(planes, linesizes, rgbbuffer, width * 3, width, height, pool, kernel);
+	}
+	double milliSeconds = timeMeasurer.elapsedMicroSecondsSinceStart() / 1000.0 / iterations;
+	if (reference != NULL && memcmp(rgbbuffer, reference, (size_t)width * height * 3) != 0) {
+		std::cout << "  " << yuv_converter_kernel_name(kernel) << " output differs from the table implementation!" << std::endl;
 	}
+	return milliSeconds;
 }
 
+void benchmark_yuv420p_to_rgb24(ThreadPool *pool) {
+	static const int SIZES[][2] = { { 1920, 1080 }, { 3840, 2160 }, { 7680, 4320 } };
+	static const YuvConverterKernel KERNELS[] = { YCK_SSE2, YCK_AVX2, YCK_NEON };
+	static const int ITERATIONS = 10;
+
+	std::cout << "yuv420p_to_rgb24 benchmark, " << ITERATIONS << " iterations, " << (pool != NULL ? pool->size() : 1) << " threads" << std::endl;
+	for (size_t s = 0; s < sizeof(SIZES) / sizeof(SIZES[0]); s++) {
+		int width = SIZES[s][0];
+		int height = SIZES[s][1];
+		// αĻ, ǲұȡֵԼǯλ
+		std::vector<unsigned char> yuv((size_t)width * height * 3 / 2);
+		unsigned int seed = 12345;
+		for (size_t i = 0; i < yuv.size(); i++) {
+			seed = seed * 1103515245 + 12345;
+			yuv[i] = (unsigned char)(seed >> 16);
+		}
+		const unsigned char *planes[3] = { &yuv[0], &yuv[0] + width * height, &yuv[0] + width * height / 4 * 5 };
+		int linesizes[3] = { width, width / 2, width / 2 };
+		std::vector<unsigned char> reference((size_t)width * height * 3);
+		std::vector<unsigned char> output((size_t)width * height * 3);
+
+		double scalar = measure_yuv420p_to_rgb24(planes, linesizes, &reference[0], NULL, width, height, NULL, YCK_SCALAR, ITERATIONS);
+		std::cout << width << "x" << height << ": table " << scalar << " ms" << std::endl;
+		for (size_t k = 0; k < sizeof(KERNELS) / sizeof(KERNELS[0]); k++) {
+			if (!yuv_converter_kernel_supported(KERNELS[k])) {
+				continue;
+			}
+			double single = measure_yuv420p_to_rgb24(planes, linesizes, &output[0], &reference[0], width, height, NULL, KERNELS[k], ITERATIONS);
+			std::cout << "  " << yuv_converter_kernel_name(KERNELS[k]) << ": " << single << " ms (" << scalar / single << "x)";
+			if (pool != NULL) {
+				double parallel = measure_yuv420p_to_rgb24(planes, linesizes, &output[0], &reference[0], width, height, pool, KERNELS[k], ITERATIONS);
+				std::cout << ", " << pool->size() << " threads: " << parallel << " ms (" << scalar / parallel << "x)";
+			}
+			std::cout << std::endl;
+		}
+	}
+}
@@ -1,6 +1,46 @@
 #pragma once
-   //for clip in CCIR601   
+   //for clip in CCIR601
+#include "ThreadPool.h"
+
+enum YuvConverterKernel {
+	YCK_SCALAR = 0, // ʵ
+	YCK_SSE2,
+	YCK_AVX2,
+	YCK_NEON,
+	YCK_AUTO // ʱCPUֵָ֧ѡʵ
+};
+
+// ɫƽзʽ
+enum YuvChromaLayout {
+	YCL_PLANAR = 0, // YUV420P, UVռһƽ
+	YCL_NV12 // NV12, UVͬһƽ
+};
+
+// صзʽ, RGBA/BGRAÿ4ֽ, Ȼ4ֽڶ, ϴ
+enum RgbPixelLayout {
+	RPL_RGB24 = 0,
+	RPL_RGBA,
+	RPL_BGRA
+};
 
 void init_yuv420p_table();
 void yuv420p_to_rgb24(unsigned char* yuvbuffer, unsigned char* rgbbuffer, int width, int height);
 
+// ͬ, ƽԼп(ֽ), poolΪNULLʱ̳߳ϲת
+// ʵֵĽʵֽͬ
+void yuv420p_to_rgb24(const unsigned char * const planes[3], const int linesizes[3], unsigned char *rgbbuffer, int rgbLinesize,
+	int width, int height, ThreadPool *pool = NULL, YuvConverterKernel kernel = YCK_AUTO);
+
+// һYUV420P/NV12RGB24/RGBA/BGRAת, NV12ʱplanes[1]ΪUVƽ, planes[2]ʹ
+// RGBA/BGRAalphaΪ255, ɫyuv420p_to_rgb24ֽͬ
+void yuv420_to_rgb(const unsigned char * const planes[], const int linesizes[], YuvChromaLayout chromaLayout,
+	unsigned char *dst, int dstLinesize, RgbPixelLayout pixelLayout, int width, int height,
+	ThreadPool *pool = NULL, YuvConverterKernel kernel = YCK_AUTO);
+
+// ǰCPUʵ
+YuvConverterKernel detect_yuv_converter_kernel();
+bool yuv_converter_kernel_supported(YuvConverterKernel kernel);
+const char *yuv_converter_kernel_name(YuvConverterKernel kernel);
+
+// 1080p, 4K, 8K±Ƚϸʵ̵ֵ߳߳ĺʱ, ʵǷһ
+void benchmark_yuv420p_to_rgb24(ThreadPool *pool);